@@ -4,6 +4,38 @@ extends "res://scenes/chess_game.gd"
 const AI_COLOR = 1
 var chess_agent = null
 
+# AI clock: remaining time and increment per move, in milliseconds.
+@export var ai_time_ms = 300000
+@export var ai_increment_ms = 2000
+
+# Playing strength from 1 (weakest, and cheapest) to 20 (full strength).
+@export var ai_skill_level = 20
+
+# "network", "handcrafted" (cheap material, piece-square and pawn-structure evaluation) or
+# "hybrid" (the network only where the cheap evaluation is close to deciding the search).
+@export var ai_eval_mode = "network"
+
+# "alphabeta" or "mcts" (Monte Carlo tree search, which does not ponder).
+@export var ai_search_engine = "alphabeta"
+
+# Keep searching on the player's time, assuming they play the reply the AI expects.
+@export var ponder_enabled = true
+
+# Directory of Syzygy endgame tables (.rtbw/.rtbz); leave empty to play endgames by search alone.
+@export var syzygy_path = ""
+
+# Polyglot opening book (.bin), e.g. built with chess_book from PGN games; leave empty to search
+# from the first move.
+@export var book_path = ""
+
+# Train the AI's network on the games it plays, in the background; the improved weights are
+# swapped in between moves. The learned weights last until the scene is closed.
+@export var online_learning = false
+
+# Set while a background search runs; the move is applied once it finishes.
+var ai_thinking = false
+var ai_think_started_ms = 0
+
 func _ready():
 	# Recreate visual containers (highlights and pieces) for this scene.
 	var hl_node = Node2D.new()
@@ -20,6 +52,15 @@ func _ready():
 	if ClassDB.class_exists("ChessAgent"):
 		chess_agent = ClassDB.instantiate("ChessAgent")
 		add_child(chess_agent)
+		chess_agent.set_skill_level(ai_skill_level)
+		chess_agent.set_eval_mode(ai_eval_mode)
+		chess_agent.set_search_engine(ai_search_engine)
+		if syzygy_path != "":
+			chess_agent.set_syzygy_path(syzygy_path)
+		if book_path != "":
+			chess_agent.load_book(book_path)
+		if online_learning:
+			chess_agent.set_online_learning(true, {})
 		print("C++ ChessAgent initialized.")
 	else:
 		printerr("CRITICAL: ChessAgent class missing.")
@@ -37,42 +78,72 @@ func _input(event):
 # After every visual update, schedule an AI move if it is AI's turn.
 func refresh_visuals():
 	super.refresh_visuals()
-	if board_rules.get_turn() == AI_COLOR:
+	if board_rules.get_turn() == AI_COLOR and not game_over:
 		call_deferred("perform_ai_turn")
 
-# Ask the agent for the best move using the pre-calculated board states.
+# Once a game ends, stop any ponder search (no start_search will follow to end it) and hand the
+# AI's positions with the result to online learning.
+func update_game_state():
+	var was_over = game_over
+	super.update_game_state()
+	if not game_over or was_over or chess_agent == null:
+		return
+	chess_agent.stop_search()
+	if online_learning:
+		var added = chess_agent.finish_game(board_rules)
+		print("Online learning: ", added, " positions queued; ", chess_agent.get_learning_stats())
+
+# Start a clock-limited background search so the UI keeps running while the AI thinks.
+# If the AI was pondering on the move just played, that search simply continues.
 func perform_ai_turn():
-	# get_all_possible_moves now returns an array of Dictionaries, each containing:
-	# { "start": Vector2, "end": Vector2, "board": Array[Array[Dictionary]], "promotion": String }
-	var possible_moves = board_rules.get_all_possible_moves(AI_COLOR)
-	
-	if possible_moves.is_empty():
+	if ai_thinking or chess_agent == null:
+		return
+
+	ai_thinking = true
+	ai_think_started_ms = Time.get_ticks_msec()
+	chess_agent.start_search(board_rules, ai_clock_options())
+
+func ai_clock_options():
+	return { "time": ai_time_ms, "increment": ai_increment_ms }
+
+# Ponder on the player's expected reply; a wrong guess is aborted by the next start_search.
+func start_pondering():
+	if ponder_enabled and not game_over and board_rules.get_turn() != AI_COLOR:
+		chess_agent.start_pondering(board_rules, ai_clock_options())
+
+# Poll the search; apply its move once it is done.
+func _process(_delta):
+	if not ai_thinking or chess_agent.is_thinking():
+		return
+
+	ai_thinking = false
+	ai_time_ms = max(ai_time_ms - (Time.get_ticks_msec() - ai_think_started_ms), 0) + ai_increment_ms
+	var best_move = chess_agent.get_search_result()
+
+	if not (best_move.has("start") and best_move.has("end")):
 		print("AI has no moves.")
 		return
 
-	# We no longer need to generate a 'simple_board' here.
-	# The agent receives the full list of future states directly.
-	var best_move = chess_agent.select_best_move(possible_moves)
-
-	if best_move.has("start") and best_move.has("end"):
-		var start = best_move["start"]
-		var end = best_move["end"]
-		
-		var result = board_rules.attempt_move(start, end)
-		
-		if result == 2:
-			# AI Promotion
-			# Use the promotion type decided by the AI, or default to Queen if missing
-			var promo = "q"
-			if best_move.has("promotion"):
-				promo = best_move["promotion"]
-			
-			board_rules.commit_promotion(promo)
-			
-			# For AI, we must explicitly update visuals here because the UI callback isn't used
-			update_last_move_visuals(start, end)
-			refresh_visuals()
-		elif result == 1:
-			# Normal Move
-			update_last_move_visuals(start, end)
-			refresh_visuals()
+	var start = best_move["start"]
+	var end = best_move["end"]
+
+	var result = board_rules.attempt_move(start, end)
+
+	if result == 2:
+		# AI Promotion
+		# Use the promotion type decided by the AI, or default to Queen if missing
+		var promo = "q"
+		if best_move.has("promotion"):
+			promo = best_move["promotion"]
+
+		board_rules.commit_promotion(promo)
+
+		# For AI, we must explicitly update visuals here because the UI callback isn't used
+		update_last_move_visuals(start, end)
+		refresh_visuals()
+		start_pondering()
+	elif result == 1:
+		# Normal Move
+		update_last_move_visuals(start, end)
+		refresh_visuals()
+		start_pondering()
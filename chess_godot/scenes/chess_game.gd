@@ -33,6 +33,9 @@ var is_promoting = false
 var pending_promotion_move_start = null # Store move details to highlight after promotion
 var pending_promotion_move_end = null
 
+# Set once BoardRules reports mate or a draw; input stops from then on.
+var game_over = false
+
 func _ready():
 	# Two child containers: one for highlights, one for piece sprites.
 	var hl_node = Node2D.new()
@@ -72,7 +75,7 @@ func setup_ui():
 
 # Handle mouse input for selecting pieces, making moves, and triggering promotion.
 func _input(event):
-	if is_promoting: return
+	if is_promoting or game_over: return
 
 	if event is InputEventMouseButton and event.pressed and event.button_index == MOUSE_BUTTON_LEFT:
 		var clicked_pos = pixel_to_grid(event.position)
@@ -188,6 +191,25 @@ func refresh_visuals():
 					$Pieces.add_child(s)
 					sprites[pos] = s
 				sprites[pos].position = grid_to_pixel(Vector2(x, y))
+	update_game_state()
+
+# End the game on mate, stalemate, repetition, the fifty-move rule or dead material.
+func update_game_state():
+	var state = board_rules.get_game_state()
+	if state == BoardRules.ONGOING or game_over:
+		return
+	game_over = true
+	match state:
+		BoardRules.CHECKMATE:
+			print("Checkmate: ", "Black" if board_rules.get_turn() == 0 else "White", " wins.")
+		BoardRules.STALEMATE:
+			print("Draw by stalemate.")
+		BoardRules.DRAW_REPETITION:
+			print("Draw by threefold repetition.")
+		BoardRules.DRAW_FIFTY_MOVES:
+			print("Draw by the fifty-move rule.")
+		BoardRules.DRAW_INSUFFICIENT_MATERIAL:
+			print("Draw by insufficient material.")
 
 # Show promotion panel and set icons based on the pawn's color.
 func start_promotion(piece_data):
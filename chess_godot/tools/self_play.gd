@@ -0,0 +1,29 @@
+# Headless self-play data generator built on the C++ SelfPlay node.
+# Usage (options are optional key=value pairs, see SelfPlay::run):
+#   godot --headless --path chess_godot -s res://tools/self_play.gd -- games=1000 threads=8 depth=2 output=user://selfplay.bin
+extends SceneTree
+
+func _init():
+	if not ClassDB.class_exists("SelfPlay"):
+		printerr("CRITICAL: SelfPlay class missing.")
+		quit(1)
+		return
+
+	# Every option is an integer except the output path.
+	var options = {}
+	for arg in OS.get_cmdline_user_args():
+		var parts = arg.split("=", true, 1)
+		if parts.size() != 2:
+			continue
+		if parts[0] == "output":
+			options[parts[0]] = parts[1]
+		else:
+			options[parts[0]] = parts[1].to_int()
+
+	var self_play = ClassDB.instantiate("SelfPlay")
+	var stats = self_play.run(options)
+	self_play.free()
+
+	for key in stats:
+		print(key, ": ", stats[key])
+	quit(1 if stats.has("error") else 0)
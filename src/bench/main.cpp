@@ -0,0 +1,325 @@
+// Native micro-benchmarks for the Godot-free core, printed as one JSON document.
+// Usage: chess_bench [--scale N] [--seed S] [--output file.json]
+// Workloads are fixed (bench positions, seeded random playouts and weights), so two runs of the
+// same build do the same work and only the timings differ; the checksums must match.
+
+#include "core/bench.h"
+#include "core/evaluate.h"
+#include "core/movegen.h"
+#include "core/network.h"
+#include "core/position.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace chess;
+
+namespace {
+
+// Same default topology as ChessAgent: 768 board features -> 128 hidden -> 1 output.
+const int HIDDEN_NODES = 128;
+const int SAMPLE_POSITIONS = 256;
+const int RANDOM_PLAYOUT_PLIES = 24;
+const float TRAINING_RATE = 0.01f;
+
+// Base iteration counts, multiplied by --scale.
+const int MOVEGEN_PASSES = 20000;
+const int MAKE_UNMAKE_PASSES = 20000;
+const int FORWARD_SAMPLES = 65536;
+const int TRAINING_SAMPLES = 20000;
+const int SELECT_PASSES = 200;
+
+class Timer {
+private:
+	std::chrono::steady_clock::time_point start;
+
+public:
+	Timer() : start(std::chrono::steady_clock::now()) {}
+	double seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+};
+
+double per_second(double count, double seconds) {
+	return seconds > 0.0 ? count / seconds : 0.0;
+}
+
+// Minimal JSON object writer; keys are emitted in call order so diffs line up.
+class JsonObject {
+private:
+	std::ostringstream out;
+	bool first = true;
+
+	void key(const char *name) {
+		out << (first ? "" : ", ") << "\"" << name << "\": ";
+		first = false;
+	}
+
+public:
+	JsonObject &add(const char *name, double value) {
+		key(name);
+		out << value;
+		return *this;
+	}
+	JsonObject &add(const char *name, int64_t value) {
+		key(name);
+		out << value;
+		return *this;
+	}
+	JsonObject &add(const char *name, uint64_t value) {
+		key(name);
+		out << value;
+		return *this;
+	}
+	JsonObject &add(const char *name, int value) { return add(name, (int64_t)value); }
+	JsonObject &add_raw(const char *name, const std::string &json) {
+		key(name);
+		out << json;
+		return *this;
+	}
+	std::string str() const { return "{" + out.str() + "}"; }
+};
+
+// Bench positions plus positions reached by seeded random playouts from them.
+std::vector<Position> sample_positions(uint64_t seed) {
+	std::vector<Position> positions;
+	for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+		Position pos;
+		pos.set_fen(BENCH_POSITIONS[i]);
+		positions.push_back(pos);
+	}
+
+	std::mt19937_64 rng(seed);
+	while ((int)positions.size() < SAMPLE_POSITIONS) {
+		Position pos = positions[rng() % BENCH_POSITION_COUNT];
+		for (int ply = 0; ply < RANDOM_PLAYOUT_PLIES; ply++) {
+			MoveList moves;
+			generate_legal_moves(pos, moves);
+			if (moves.size == 0) {
+				break;
+			}
+			UndoInfo undo;
+			pos.make_move(moves.moves[rng() % moves.size], undo);
+		}
+		positions.push_back(pos);
+	}
+	return positions;
+}
+
+std::string bench_movegen(std::vector<Position> positions, int scale) {
+	uint64_t moves = 0;
+	int64_t calls = 0;
+	Timer timer;
+	for (int pass = 0; pass < MOVEGEN_PASSES * scale / (int)positions.size() + 1; pass++) {
+		for (Position &pos : positions) {
+			MoveList list;
+			generate_legal_moves(pos, list);
+			moves += list.size;
+			calls++;
+		}
+	}
+	double seconds = timer.seconds();
+	return JsonObject()
+			.add("positions", calls)
+			.add("seconds", seconds)
+			.add("ns_per_position", seconds * 1e9 / calls)
+			.add("moves_per_second", per_second((double)moves, seconds))
+			.add("checksum", moves)
+			.str();
+}
+
+// Every pseudo-legal move of every sample position, played and taken back.
+std::string bench_make_unmake(std::vector<Position> positions, int scale) {
+	std::vector<MoveList> lists(positions.size());
+	for (size_t i = 0; i < positions.size(); i++) {
+		generate_moves(positions[i], lists[i]);
+	}
+
+	uint64_t key_sum = 0;
+	int64_t count = 0;
+	Timer timer;
+	for (int pass = 0; pass < MAKE_UNMAKE_PASSES * scale / (int)positions.size() + 1; pass++) {
+		for (size_t i = 0; i < positions.size(); i++) {
+			Position &pos = positions[i];
+			for (Move move : lists[i]) {
+				UndoInfo undo;
+				pos.make_move(move, undo);
+				key_sum += pos.key();
+				pos.unmake_move(move, undo);
+				count++;
+			}
+		}
+	}
+	double seconds = timer.seconds();
+	return JsonObject()
+			.add("moves", count)
+			.add("seconds", seconds)
+			.add("ns_per_move", seconds * 1e9 / count)
+			.add("moves_per_second", per_second((double)count, seconds))
+			.add("checksum", key_sum)
+			.str();
+}
+
+// The same total number of samples at each batch size, so per-sample costs compare directly.
+std::string bench_forward(const Network &network, const std::vector<float> &features, int scale) {
+	static const int BATCH_SIZES[] = { 1, 16, 256 };
+	const int sample_count = (int)(features.size() / NETWORK_INPUTS);
+	Network::Workspace workspace;
+	network.init_workspace(workspace);
+
+	std::string results = "[";
+	for (int b = 0; b < 3; b++) {
+		const int batch = BATCH_SIZES[b];
+		const int calls = std::max(1, FORWARD_SAMPLES * scale / batch);
+		double output_sum = 0.0;
+		Timer timer;
+		for (int call = 0; call < calls; call++) {
+			int first = (call * batch) % (sample_count - batch + 1);
+			const float *inputs = features.data() + (size_t)first * NETWORK_INPUTS;
+			if (batch == 1) {
+				output_sum += network.forward(inputs, workspace)[0];
+			} else {
+				output_sum += network.forward_batch(inputs, batch, workspace)[batch - 1];
+			}
+		}
+		double seconds = timer.seconds();
+		results += (b > 0 ? ", " : "") + JsonObject()
+				.add("batch", batch)
+				.add("calls", calls)
+				.add("seconds", seconds)
+				.add("us_per_call", seconds * 1e6 / calls)
+				.add("us_per_sample", seconds * 1e6 / ((double)calls * batch))
+				.add("samples_per_second", per_second((double)calls * batch, seconds))
+				.add("checksum", output_sum)
+				.str();
+	}
+	return results + "]";
+}
+
+// Training runs on a copy so the other benchmarks always see the seeded weights.
+std::string bench_training(Network network, const std::vector<float> &features, uint64_t seed, int scale) {
+	const int sample_count = (int)(features.size() / NETWORK_INPUTS);
+	std::mt19937_64 rng(seed);
+	std::vector<float> targets(sample_count);
+	for (float &target : targets) {
+		target = (float)(rng() % 3) * 0.5f;
+	}
+
+	Network::Workspace workspace;
+	network.init_workspace(workspace);
+	const int samples = TRAINING_SAMPLES * scale;
+	Timer timer;
+	for (int i = 0; i < samples; i++) {
+		int index = i % sample_count;
+		network.train(features.data() + (size_t)index * NETWORK_INPUTS, &targets[index], TRAINING_RATE, workspace);
+	}
+	double seconds = timer.seconds();
+
+	double cost = 0.0;
+	for (int i = 0; i < sample_count; i++) {
+		cost += network.cost(features.data() + (size_t)i * NETWORK_INPUTS, &targets[i], workspace);
+	}
+	return JsonObject()
+			.add("samples", samples)
+			.add("seconds", seconds)
+			.add("samples_per_second", per_second(samples, seconds))
+			.add("final_cost", cost / sample_count)
+			.str();
+}
+
+// What ChessAgent.select_best_move does per call without the Variant round trip: play every
+// legal move, encode the resulting board and keep the move the network likes best.
+std::string bench_select_best_move(std::vector<Position> positions, const Network &network, int scale) {
+	positions.resize(BENCH_POSITION_COUNT);
+	Network::Workspace workspace;
+	network.init_workspace(workspace);
+	std::vector<float> inputs(NETWORK_INPUTS);
+
+	uint64_t move_sum = 0;
+	int64_t calls = 0;
+	Timer timer;
+	for (int pass = 0; pass < SELECT_PASSES * scale; pass++) {
+		for (Position &pos : positions) {
+			MoveList moves;
+			generate_legal_moves(pos, moves);
+			Move best_move = MOVE_NONE;
+			float best_output = -1.0f;
+			for (Move move : moves) {
+				UndoInfo undo;
+				pos.make_move(move, undo);
+				encode_position(pos, inputs.data());
+				float output = network.forward(inputs.data(), workspace)[0];
+				pos.unmake_move(move, undo);
+				if (output > best_output) {
+					best_output = output;
+					best_move = move;
+				}
+			}
+			move_sum += best_move;
+			calls++;
+		}
+	}
+	double seconds = timer.seconds();
+	return JsonObject()
+			.add("calls", calls)
+			.add("seconds", seconds)
+			.add("us_per_call", seconds * 1e6 / calls)
+			.add("checksum", move_sum)
+			.str();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	int scale = 1;
+	uint64_t seed = 1;
+	std::string output_path;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--scale" && i + 1 < argc) {
+			scale = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--output" && i + 1 < argc) {
+			output_path = argv[++i];
+		} else {
+			std::fprintf(stderr, "usage: chess_bench [--scale N] [--seed S] [--output file.json]\n");
+			return 1;
+		}
+	}
+
+	Network network;
+	network.set_layer_sizes({ NETWORK_INPUTS, HIDDEN_NODES, 1 }, seed);
+
+	std::vector<Position> positions = sample_positions(seed);
+	std::vector<float> features(positions.size() * NETWORK_INPUTS);
+	for (size_t i = 0; i < positions.size(); i++) {
+		encode_position(positions[i], features.data() + i * NETWORK_INPUTS);
+	}
+
+	std::string json = JsonObject()
+			.add_raw("config", JsonObject().add("seed", seed).add("scale", scale).add("positions", (int)positions.size()).str())
+			.add_raw("movegen", bench_movegen(positions, scale))
+			.add_raw("make_unmake", bench_make_unmake(positions, scale))
+			.add_raw("forward", bench_forward(network, features, scale))
+			.add_raw("training", bench_training(network, features, seed, scale))
+			.add_raw("select_best_move", bench_select_best_move(positions, network, scale))
+			.str();
+
+	std::printf("%s\n", json.c_str());
+	if (!output_path.empty()) {
+		std::FILE *file = std::fopen(output_path.c_str(), "w");
+		if (file == nullptr || std::fprintf(file, "%s\n", json.c_str()) < 0) {
+			std::fprintf(stderr, "chess_bench: cannot write %s\n", output_path.c_str());
+			return 1;
+		}
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -1,65 +1,71 @@
 #include "board_rules.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
-#include <cstring> // For memcpy
 
 using namespace godot;
 
-// Constructor: reset board, turn, and special flags.
+// Script-facing piece letters in chess::PieceType order (P, R, N, B, Q, K).
+static const char *const PIECE_LETTERS[6] = { "p", "r", "n", "b", "q", "k" };
+
+// Back-rank piece types by file in the standard layout, used to derive has_moved.
+static const chess::PieceType BACK_RANK[8] = { chess::ROOK, chess::KNIGHT, chess::BISHOP, chess::QUEEN,
+	chess::KING, chess::BISHOP, chess::KNIGHT, chess::ROOK };
+
+// Constructor: standard position, no promotion in progress.
 BoardRules::BoardRules() {
-	turn = 0;
-	en_passant_target = Vector2i(-1, -1);
+	position.set_start_position();
 	promotion_pending = false;
-	for (int x = 0; x < 8; x++) {
-		for (int y = 0; y < 8; y++) {
-			board[x][y] = { EMPTY, NONE, false, false };
-		}
-	}
+	promotion_move = chess::MOVE_NONE;
 }
 
 BoardRules::~BoardRules() {}
 
 // Set up the board to either standard chess layout or a custom one.
 void BoardRules::setup_board(const Array &custom_layout) {
-	turn = 0;
-	en_passant_target = Vector2i(-1, -1);
 	promotion_pending = false;
+	promotion_move = chess::MOVE_NONE;
 
-	bool use_standard = custom_layout.is_empty();
-
-	// Standard initial chess position (color suffix: 0 = white, 1 = black).
-	const char *std_layout[8][8] = {
-		{ "r1", "n1", "b1", "q1", "k1", "b1", "n1", "r1" },
-		{ "p1", "p1", "p1", "p1", "p1", "p1", "p1", "p1" },
-		{ "0", "0", "0", "0", "0", "0", "0", "0" },
-		{ "0", "0", "0", "0", "0", "0", "0", "0" },
-		{ "0", "0", "0", "0", "0", "0", "0", "0" },
-		{ "0", "0", "0", "0", "0", "0", "0", "0" },
-		{ "p0", "p0", "p0", "p0", "p0", "p0", "p0", "p0" },
-		{ "r0", "n0", "b0", "q0", "k0", "b0", "n0", "r0" }
-	};
+	if (custom_layout.is_empty()) {
+		position.set_start_position();
+		return;
+	}
 
+	// Custom layout: 8 rows of "0" or type letter + color digit ("p0", "k1", ...), White to move.
+	position.clear();
 	for (int y = 0; y < 8; y++) {
-		Array row = use_standard ? Array() : Array(custom_layout[y]);
+		Array row = custom_layout[y];
 		for (int x = 0; x < 8; x++) {
-			String cell = use_standard ? std_layout[y][x] : (String)row[x];
+			String cell = row[x];
 			if (cell == "0") {
-				board[x][y] = { EMPTY, NONE, false, false };
-			} else {
-				String type_char = cell.substr(0, 1);
-				int color = cell.substr(1, 1).to_int();
-				PieceType pt = EMPTY;
-				if (type_char == "p") pt = PAWN;
-				else if (type_char == "r") pt = ROOK;
-				else if (type_char == "n") pt = KNIGHT;
-				else if (type_char == "b") pt = BISHOP;
-				else if (type_char == "q") pt = QUEEN;
-				else if (type_char == "k") pt = KING;
-
-				board[x][y] = { pt, (PieceColor)color, false, true };
+				continue;
+			}
+			String type_char = cell.substr(0, 1);
+			int color = cell.substr(1, 1).to_int();
+			for (int type = 0; type < 6; type++) {
+				if (type_char == PIECE_LETTERS[type]) {
+					position.put_piece(chess::make_piece(color, type), chess::make_square(x, y));
+				}
 			}
 		}
 	}
+
+	// Every piece of a custom layout starts unmoved, so castling is open wherever king and rook stand at home.
+	int rights = 0;
+	for (int color = 0; color < 2; color++) {
+		int y = (color == chess::WHITE) ? 7 : 0;
+		chess::Piece rook = chess::make_piece(color, chess::ROOK);
+		if (position.piece_on(chess::make_square(4, y)) != chess::make_piece(color, chess::KING)) {
+			continue;
+		}
+		if (position.piece_on(chess::make_square(7, y)) == rook) {
+			rights |= color == chess::WHITE ? chess::WHITE_OO : chess::BLACK_OO;
+		}
+		if (position.piece_on(chess::make_square(0, y)) == rook) {
+			rights |= color == chess::WHITE ? chess::WHITE_OOO : chess::BLACK_OOO;
+		}
+	}
+	position.set_castling_rights(rights);
+	position.refresh_key();
 }
 
 // Export piece info at given coordinates in a Godot-friendly Dictionary.
@@ -69,41 +75,70 @@ Dictionary BoardRules::get_data_at(int x, int y) const {
 		return d;
 	}
 
-	Piece P = board[x][y];
-	if (!P.active) {
-		return d;
+	chess::Square square = chess::make_square(x, y);
+	chess::Piece piece = position.piece_on(square);
+
+	// While a promotion is pending the pawn is shown on its target square.
+	if (promotion_pending) {
+		if (square == chess::move_from(promotion_move)) {
+			piece = chess::NO_PIECE;
+		} else if (square == chess::move_to(promotion_move)) {
+			piece = position.piece_on(chess::move_from(promotion_move));
+		}
 	}
 
-	String t = "";
-	switch (P.type) {
-		case PAWN: t = "p"; break;
-		case ROOK: t = "r"; break;
-		case KNIGHT: t = "n"; break;
-		case BISHOP: t = "b"; break;
-		case QUEEN: t = "q"; break;
-		case KING: t = "k"; break;
-		default: t = ""; break;
+	if (piece == chess::NO_PIECE) {
+		return d;
 	}
 
-	d["type"] = t;
-	d["color"] = (int)P.color;
+	d["type"] = PIECE_LETTERS[chess::type_of(piece)];
+	d["color"] = chess::color_of(piece);
 	return d;
 }
 
+// Pawns off their start rank, kings and rooks without castling rights, and other pieces
+// away from their initial squares count as moved.
+static bool has_moved(const chess::Position &position, chess::Square square) {
+	chess::Piece piece = position.piece_on(square);
+	int color = chess::color_of(piece);
+	int home_row = (color == chess::WHITE) ? 7 : 0;
+	int x = chess::file_of(square);
+	int y = chess::row_of(square);
+
+	switch (chess::type_of(piece)) {
+		case chess::PAWN:
+			return y != ((color == chess::WHITE) ? 6 : 1);
+		case chess::KING: {
+			int rights = position.castling_rights() & (color == chess::WHITE ? (chess::WHITE_OO | chess::WHITE_OOO) : (chess::BLACK_OO | chess::BLACK_OOO));
+			return rights == 0 || y != home_row || x != 4;
+		}
+		case chess::ROOK: {
+			if (y != home_row || (x != 0 && x != 7)) {
+				return true;
+			}
+			int right = (x == 7) ? chess::WHITE_OO : chess::WHITE_OOO;
+			return (position.castling_rights() & (right << (color * 2))) == 0;
+		}
+		default:
+			return y != home_row || BACK_RANK[x] != chess::type_of(piece);
+	}
+}
+
 // Helper to serialize the entire board state into an Array of Arrays of Dictionaries.
 // This matches the "full boards with 8x8 piece structs" requirement.
-static Array get_board_state_snapshot(const BoardRules::Piece b[8][8]) {
+static Array get_board_state_snapshot(const chess::Position &pos) {
 	Array rows;
 	for (int y = 0; y < 8; y++) {
 		Array row;
 		for (int x = 0; x < 8; x++) {
 			Dictionary d;
-			// Mirror the Piece struct
-			d["active"] = b[x][y].active;
-			if (b[x][y].active) {
-				d["type"] = (int)b[x][y].type;
-				d["color"] = (int)b[x][y].color;
-				d["has_moved"] = b[x][y].has_moved;
+			chess::Piece piece = pos.piece_on(chess::make_square(x, y));
+			// Mirror the old Piece struct
+			d["active"] = piece != chess::NO_PIECE;
+			if (piece != chess::NO_PIECE) {
+				d["type"] = chess::type_of(piece);
+				d["color"] = chess::color_of(piece);
+				d["has_moved"] = has_moved(pos, chess::make_square(x, y));
 			}
 			row.append(d);
 		}
@@ -122,87 +157,24 @@ static Array get_board_state_snapshot(const BoardRules::Piece b[8][8]) {
 // }
 Array BoardRules::get_all_possible_moves(int color) {
 	Array moves;
-	
-	// Backup state to restore after simulations
-	Piece board_backup[8][8];
-	Vector2i en_passant_backup = en_passant_target;
-	// We don't backup turn/promotion_pending because we reset them manually or don't use them during generation logic loop
-	
-	int promotion_row = (color == WHITE) ? 0 : 7;
 
-	for (int x = 0; x < 8; x++) {
-		for (int y = 0; y < 8; y++) {
-			Piece P = board[x][y];
-			if (!P.active || P.color != color) {
-				continue;
-			}
+	chess::MoveList legal_moves;
+	generate_moves_for(color, legal_moves);
 
-			for (int tx = 0; tx < 8; tx++) {
-				for (int ty = 0; ty < 8; ty++) {
-					Vector2i start(x, y);
-					Vector2i end(tx, ty);
-
-					if (is_valid_geometry(P, start, end)) {
-						if (!does_move_cause_self_check(start, end)) {
-							// Check for promotion
-							bool is_promotion = (P.type == PAWN && end.y == promotion_row);
-							
-							if (is_promotion) {
-								const char* promo_chars[] = {"q", "r", "b", "n"};
-								PieceType promo_types[] = {QUEEN, ROOK, BISHOP, KNIGHT};
-								
-								for (int i = 0; i < 4; i++) {
-									// 1. Backup
-									std::memcpy(board_backup, board, sizeof(board));
-									en_passant_target = en_passant_backup;
-
-									// 2. Execute move (updates board, castling, en passant logic)
-									// We use real_move=true to get the correct 'next turn' en_passant_target state
-									execute_move_internal(start, end, true);
-									
-									// 3. Apply promotion
-									board[end.x][end.y].type = promo_types[i];
-
-									// 4. Record State
-									Dictionary move_data;
-									move_data["start"] = start;
-									move_data["end"] = end;
-									move_data["promotion"] = String(promo_chars[i]);
-									move_data["board"] = get_board_state_snapshot(board);
-									moves.append(move_data);
-
-									// 5. Restore
-									std::memcpy(board, board_backup, sizeof(board));
-									en_passant_target = en_passant_backup;
-								}
-							} else {
-								// Normal Move (including Castling / En Passant)
-								
-								// 1. Backup
-								std::memcpy(board_backup, board, sizeof(board));
-								en_passant_target = en_passant_backup;
-
-								// 2. Execute
-								execute_move_internal(start, end, true);
-
-								// 3. Record State
-								Dictionary move_data;
-								move_data["start"] = start;
-								move_data["end"] = end;
-								move_data["board"] = get_board_state_snapshot(board);
-								moves.append(move_data);
-
-								// 4. Restore
-								std::memcpy(board, board_backup, sizeof(board));
-								en_passant_target = en_passant_backup;
-							}
-						}
-					}
-				}
-			}
+	for (chess::Move move : legal_moves) {
+		// Play the move on a copy and snapshot the resulting board.
+		chess::Position after = position;
+		chess::UndoInfo undo;
+		if (after.side_to_move() != color) {
+			after.make_null_move(undo);
 		}
+		after.make_move(move, undo);
+
+		Dictionary move_data = move_to_dictionary(move);
+		move_data["board"] = get_board_state_snapshot(after);
+		moves.append(move_data);
 	}
-	
+
 	return moves;
 }
 
@@ -213,19 +185,19 @@ Array BoardRules::get_valid_moves_for_piece(Vector2i start_pos) {
 		return valid_targets;
 	}
 
-	Piece P = board[start_pos.x][start_pos.y];
-	if (!P.active) {
+	chess::Square from = to_square(start_pos);
+	chess::Piece piece = position.piece_on(from);
+	if (piece == chess::NO_PIECE) {
 		return valid_targets;
 	}
 
-	for (int x = 0; x < 8; x++) {
-		for (int y = 0; y < 8; y++) {
-			Vector2i target(x, y);
-			if (is_valid_geometry(P, start_pos, target)) {
-				if (!does_move_cause_self_check(start_pos, target)) {
-					valid_targets.append(target);
-				}
-			}
+	chess::MoveList moves;
+	generate_moves_for(chess::color_of(piece), moves);
+	for (chess::Move move : moves) {
+		// Promotions share a target square; list it once.
+		int promotion = chess::move_promotion(move);
+		if (chess::move_from(move) == from && (promotion == 0 || promotion == chess::QUEEN)) {
+			valid_targets.append(to_vector(chess::move_to(move)));
 		}
 	}
 	return valid_targets;
@@ -240,33 +212,28 @@ int BoardRules::attempt_move(Vector2i start, Vector2i end) {
 		return 0;
 	}
 
-	Piece P = board[start.x][start.y];
-	if (!P.active || P.color != turn) {
-		return 0;
-	}
+	chess::Square from = to_square(start);
+	chess::Square to = to_square(end);
 
-	if (!is_valid_geometry(P, start, end)) {
-		return 0;
-	}
+	chess::MoveList moves;
+	chess::generate_legal_moves(position, moves);
+	for (chess::Move move : moves) {
+		if (chess::move_from(move) != from || chess::move_to(move) != to) {
+			continue;
+		}
 
-	if (does_move_cause_self_check(start, end)) {
-		return 0;
-	}
+		// If pawn reaches last rank, mark promotion and let the UI choose the piece.
+		if (chess::move_promotion(move) != 0) {
+			promotion_pending = true;
+			promotion_move = chess::encode_move(from, to);
+			return 2;
+		}
 
-	int promotion_row = (P.color == WHITE) ? 0 : 7;
-	
-	// If pawn reaches last rank, mark promotion and let the UI choose the piece.
-	if (P.type == PAWN && end.y == promotion_row) {
-		execute_move_internal(start, end, true);
-		promotion_pending = true;
-		promotion_square = end;
-		return 2;
+		// Normal move.
+		play_move(move);
+		return 1;
 	}
-
-	// Normal move.
-	execute_move_internal(start, end, true);
-	turn = 1 - turn;
-	return 1;
+	return 0;
 }
 
 // Commit a previously prepared pawn promotion (after UI selection).
@@ -274,227 +241,74 @@ void BoardRules::commit_promotion(String type_str) {
 	if (!promotion_pending) {
 		return;
 	}
-	PieceType pt = QUEEN;
-	if (type_str == "r") pt = ROOK;
-	else if (type_str == "b") pt = BISHOP;
-	else if (type_str == "n") pt = KNIGHT;
-	
-	board[promotion_square.x][promotion_square.y].type = pt;
+	chess::PieceType pt = chess::QUEEN;
+	if (type_str == "r") pt = chess::ROOK;
+	else if (type_str == "b") pt = chess::BISHOP;
+	else if (type_str == "n") pt = chess::KNIGHT;
+
 	promotion_pending = false;
-	turn = 1 - turn;
+	play_move(chess::encode_move(chess::move_from(promotion_move), chess::move_to(promotion_move), pt));
 }
 
 // Simple getter for current side to move.
 int BoardRules::get_turn() const {
-	return turn;
+	return position.side_to_move();
 }
 
-// Execute the low-level board update for a move, including en passant and castling.
-void BoardRules::execute_move_internal(Vector2i start, Vector2i end, bool real_move) {
-	Piece P = board[start.x][start.y];
-	int move_dir = (P.color == WHITE) ? -1 : 1;
-
-	// En Passant: capture pawn behind the target square.
-	if (P.type == PAWN && end == en_passant_target) {
-		board[end.x][end.y - move_dir] = { EMPTY, NONE, false, false };
-	}
-
-	// Castling: move rook as well if king moves two squares horizontally.
-	if (P.type == KING && abs(end.x - start.x) > 1) {
-		int rook_x = (end.x > start.x) ? 7 : 0;
-		int rook_target_x = (end.x > start.x) ? 5 : 3;
-		Piece rook = board[rook_x][end.y];
-		board[rook_x][end.y] = { EMPTY, NONE, false, false };
-		board[rook_target_x][end.y] = rook;
-		board[rook_target_x][end.y].has_moved = true;
-	}
-
-	// Update En Passant target square only for real moves.
-	if (real_move) {
-		en_passant_target = Vector2i(-1, -1);
-		// If pawn moved two squares, set en passant square in between.
-		if (P.type == PAWN && abs(end.y - start.y) == 2) {
-			en_passant_target = Vector2i(start.x, start.y + move_dir);
-		}
-	}
-
-	// Move the piece to its new square.
-	board[end.x][end.y] = P;
-	board[end.x][end.y].has_moved = true;
-	board[start.x][start.y] = { EMPTY, NONE, false, false };
+BoardRules::GameState BoardRules::get_game_state() {
+	return (GameState)chess::get_game_state(position);
 }
 
-// Check basic piece movement rules and collisions, including special cases.
-bool BoardRules::is_valid_geometry(const Piece &P, Vector2i start, Vector2i end) const {
-	int dx = end.x - start.x;
-	int dy = end.y - start.y;
-	int abs_dx = abs(dx);
-	int abs_dy = abs(dy);
-	
-	Piece target = board[end.x][end.y];
-
-	// Cannot capture own piece.
-	if (target.active && target.color == P.color) {
-		return false;
-	}
-
-	int dir = (P.color == WHITE) ? -1 : 1;
-
-	switch (P.type) {
-		case PAWN:
-			// Single-step forward.
-			if (dx == 0 && dy == dir && !target.active) {
-				return true;
-			}
-			// Double-step forward from starting rank (must be unobstructed).
-			if (dx == 0 && dy == dir * 2 && !P.has_moved && !target.active) {
-				if (!board[start.x][start.y + dir].active) {
-					return true;
-				}
-			}
-			// Diagonal capture or en passant.
-			if (abs_dx == 1 && dy == dir) {
-				if (target.active) {
-					return true;
-				}
-				if (end == en_passant_target) {
-					return true;
-				}
-			}
-			return false;
-
-		case KING:
-			// Normal king move: one square in any direction.
-			if (abs_dx <= 1 && abs_dy <= 1) {
-				return true;
-			}
-			// Castling: horizontal move by two squares, rook and check rules handled here.
-			if (abs_dy == 0 && abs_dx == 2 && !P.has_moved) {
-				// King cannot castle out of, through, or into check.
-				if (is_square_attacked(start, 1 - P.color)) {
-					return false;
-				}
-				
-				int rook_x = (dx > 0) ? 7 : 0;
-				Piece rook = board[rook_x][start.y];
-				
-				if (!rook.active || rook.type != ROOK || rook.has_moved) {
-					return false;
-				}
-
-				int step = (dx > 0) ? 1 : -1;
-				for (int i = 1; i < 3; i++) {
-					Vector2i check_pos(start.x + (i * step), start.y);
-					if (board[check_pos.x][check_pos.y].active) {
-						return false;
-					}
-					if (is_square_attacked(check_pos, 1 - P.color)) {
-						return false;
-					}
-				}
-				return true;
-			}
-			return false;
-
-		case KNIGHT:
-			return (abs_dx == 2 && abs_dy == 1) || (abs_dx == 1 && abs_dy == 2);
-
-		case ROOK:
-			return (dx == 0 || dy == 0) && is_path_clear(start, end);
+int BoardRules::get_halfmove_clock() const {
+	return position.get_halfmove_clock();
+}
 
-		case BISHOP:
-			return abs_dx == abs_dy && is_path_clear(start, end);
+const chess::Position &BoardRules::get_position() const {
+	return position;
+}
 
-		case QUEEN:
-			return (dx == 0 || dy == 0 || abs_dx == abs_dy) && is_path_clear(start, end);
+void BoardRules::set_position(const chess::Position &new_position) {
+	position = new_position;
+	promotion_pending = false;
+	promotion_move = chess::MOVE_NONE;
+}
 
-		default:
-			return false;
-	}
+void BoardRules::play_move(chess::Move move) {
+	chess::UndoInfo undo;
+	position.make_move(move, undo);
 }
 
-// Check that all squares between start and end (exclusive) are empty.
-bool BoardRules::is_path_clear(Vector2i start, Vector2i end) const {
-	int dx = (end.x - start.x) == 0 ? 0 : (end.x - start.x) > 0 ? 1 : -1;
-	int dy = (end.y - start.y) == 0 ? 0 : (end.y - start.y) > 0 ? 1 : -1;
-	
-	Vector2i current = start + Vector2i(dx, dy);
-	while (current != end) {
-		if (board[current.x][current.y].active) {
-			return false;
-		}
-		current += Vector2i(dx, dy);
+Dictionary BoardRules::move_to_dictionary(chess::Move move) {
+	Dictionary move_data;
+	move_data["start"] = to_vector(chess::move_from(move));
+	move_data["end"] = to_vector(chess::move_to(move));
+	if (chess::move_promotion(move) != 0) {
+		move_data["promotion"] = String(PIECE_LETTERS[chess::move_promotion(move)]);
 	}
-	return true;
+	return move_data;
 }
 
-// Determine if a square is attacked by any piece of the given color.
-bool BoardRules::is_square_attacked(Vector2i square, int by_color) const {
-	for (int x = 0; x < 8; x++) {
-		for (int y = 0; y < 8; y++) {
-			Piece P = board[x][y];
-			if (P.active && P.color == by_color) {
-				// Pawn attacks differ from pawn movement geometry.
-				if (P.type == PAWN) {
-					int dir = (P.color == WHITE) ? -1 : 1;
-					if (abs(square.x - x) == 1 && (square.y - y) == dir) {
-						return true;
-					}
-				} else if (P.type == KING) {
-					// King attacks one square in all directions.
-					if (abs(square.x - x) <= 1 && abs(square.y - y) <= 1) {
-						return true;
-					}
-				} else if (is_valid_geometry(P, Vector2i(x, y), square)) {
-					// Other pieces reuse geometry rules for attack detection.
-					return true;
-				}
-			}
-		}
+// Scripts may ask for the moves of the side not on turn; those are generated after a null move.
+void BoardRules::generate_moves_for(int color, chess::MoveList &moves) {
+	chess::Position pos = position;
+	if (pos.side_to_move() != color) {
+		chess::UndoInfo undo;
+		pos.make_null_move(undo);
 	}
-	return false;
+	chess::generate_legal_moves(pos, moves);
 }
 
-// Test if making this move would leave own king in check.
-bool BoardRules::does_move_cause_self_check(Vector2i start, Vector2i end) {
-	Piece orig_start = board[start.x][start.y];
-	Piece orig_end = board[end.x][end.y];
-
-	// Apply move virtually.
-	// Note: This naive swap does not handle en passant/castling logic perfectly 
-	// for check validation, but serves the basic "don't leave king hanging" check.
-	board[end.x][end.y] = orig_start;
-	board[start.x][start.y] = { EMPTY, NONE, false, false };
-
-	bool check = is_in_check(orig_start.color);
-
-	// Revert board.
-	board[start.x][start.y] = orig_start;
-	board[end.x][end.y] = orig_end;
-
-	return check;
+// Simple bounds check for 8x8 board.
+bool BoardRules::is_on_board(Vector2i pos) {
+	return pos.x >= 0 && pos.x < 8 && pos.y >= 0 && pos.y < 8;
 }
 
-// Check if the given color's king is currently in check.
-bool BoardRules::is_in_check(int color) const {
-	Vector2i king_pos(-1, -1);
-	for (int x = 0; x < 8; x++) {
-		for (int y = 0; y < 8; y++) {
-			if (board[x][y].active && board[x][y].type == KING && board[x][y].color == color) {
-				king_pos = Vector2i(x, y);
-				break;
-			}
-		}
-		if (king_pos.x != -1) {
-			break;
-		}
-	}
-	return (king_pos.x != -1) && is_square_attacked(king_pos, 1 - color);
+chess::Square BoardRules::to_square(Vector2i pos) {
+	return chess::make_square(pos.x, pos.y);
 }
 
-// Simple bounds check for 8x8 board.
-bool BoardRules::is_on_board(Vector2i pos) const {
-	return pos.x >= 0 && pos.x < 8 && pos.y >= 0 && pos.y < 8;
+Vector2i BoardRules::to_vector(chess::Square square) {
+	return Vector2i(chess::file_of(square), chess::row_of(square));
 }
 
 // Godot method binding for scripting API.
@@ -504,6 +318,15 @@ void BoardRules::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("attempt_move", "start", "end"), &BoardRules::attempt_move);
 	ClassDB::bind_method(D_METHOD("commit_promotion", "type_str"), &BoardRules::commit_promotion);
 	ClassDB::bind_method(D_METHOD("get_turn"), &BoardRules::get_turn);
+	ClassDB::bind_method(D_METHOD("get_game_state"), &BoardRules::get_game_state);
+	ClassDB::bind_method(D_METHOD("get_halfmove_clock"), &BoardRules::get_halfmove_clock);
+
+	BIND_ENUM_CONSTANT(ONGOING);
+	BIND_ENUM_CONSTANT(CHECKMATE);
+	BIND_ENUM_CONSTANT(STALEMATE);
+	BIND_ENUM_CONSTANT(DRAW_REPETITION);
+	BIND_ENUM_CONSTANT(DRAW_FIFTY_MOVES);
+	BIND_ENUM_CONSTANT(DRAW_INSUFFICIENT_MATERIAL);
 	
 	// Expose move generation helpers to GDScript/AI.
 	ClassDB::bind_method(D_METHOD("get_all_possible_moves", "color"), &BoardRules::get_all_possible_moves);
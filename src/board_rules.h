@@ -10,46 +10,43 @@
 #include <godot_cpp/variant/string.hpp>
 #include <godot_cpp/variant/vector2i.hpp>
 
+// The rules themselves live in the Godot-free core; this class only converts to and from Variants.
+#include "core/movegen.h"
+#include "core/position.h"
+
 using namespace godot;
 
-// BoardRules implements the chess rules and board state as a Godot Node2D.
+// BoardRules exposes a chess::Position to GDScript as a Godot Node2D.
+// Coordinates are Vector2i(x, y) with y = 0 on Black's back rank, i.e. square y * 8 + x.
 class BoardRules : public Node2D {
 	GDCLASS(BoardRules, Node2D)
 
 public:
-	// Internal representation of piece type and color.
-	enum PieceType { EMPTY = -1, PAWN = 0, ROOK = 1, KNIGHT = 2, BISHOP = 3, QUEEN = 4, KING = 5 };
-	enum PieceColor { WHITE = 0, BLACK = 1, NONE = -1 };
-
-	struct Piece {
-		PieceType type;
-		PieceColor color;
-		bool has_moved; // Tracks if piece has moved (for castling, pawn double step).
-		bool active;    // false = empty square.
+	// Same values as chess::GameState.
+	enum GameState {
+		ONGOING = chess::GAME_ONGOING,
+		CHECKMATE = chess::GAME_CHECKMATE,
+		STALEMATE = chess::GAME_STALEMATE,
+		DRAW_REPETITION = chess::GAME_DRAW_REPETITION,
+		DRAW_FIFTY_MOVES = chess::GAME_DRAW_FIFTY_MOVES,
+		DRAW_INSUFFICIENT_MATERIAL = chess::GAME_DRAW_INSUFFICIENT_MATERIAL,
 	};
 
 private:
-	// Board is indexed as board[x][y] with x,y in [0,7].
-	Piece board[8][8];
-
-	int turn; // 0 = White, 1 = Black
-
-	// En passant target square; (-1, -1) if none is available.
-	Vector2i en_passant_target;
+	chess::Position position;
 
-	// Promotion state: used when a pawn reaches last rank.
+	// Promotion state: the UI picks the piece after the pawn has reached the last rank.
+	// The move is only played on commit_promotion; until then get_data_at shows the pawn there.
 	bool promotion_pending;
-	Vector2i promotion_square;
+	chess::Move promotion_move;
 
 	// Internal Logic helpers
-	bool is_on_board(Vector2i pos) const;
-	bool is_valid_geometry(const Piece &P, Vector2i start, Vector2i end) const;
-	bool is_path_clear(Vector2i start, Vector2i end) const;
-	bool is_square_attacked(Vector2i square, int by_color) const;
-	bool does_move_cause_self_check(Vector2i start, Vector2i end);
-	bool is_in_check(int color) const;
-	bool is_checkmate(int color); // Declared for future use; not exposed to script.
-	void execute_move_internal(Vector2i start, Vector2i end, bool real_move);
+	static bool is_on_board(Vector2i pos);
+	static chess::Square to_square(Vector2i pos);
+	static Vector2i to_vector(chess::Square square);
+
+	// Legal moves for color, even when it is not that color's turn (generated as if it were).
+	void generate_moves_for(int color, chess::MoveList &moves);
 
 protected:
 	static void _bind_methods();
@@ -75,11 +72,29 @@ public:
 	// Current side to move: 0 = white, 1 = black.
 	int get_turn() const;
 
+	// Whether the game is over and why; the side to move is the one mated or stalemated.
+	GameState get_game_state();
+
+	// Plies since the last capture or pawn move (fifty-move rule at 100).
+	int get_halfmove_clock() const;
+
 	// Returns all legal moves for given color as an Array of Dictionaries.
 	Array get_all_possible_moves(int color);
 
 	// Returns all legal target squares for a piece at start_pos.
 	Array get_valid_moves_for_piece(Vector2i start_pos);
+
+	// Native access (not exposed to script) for ChessAgent, SelfPlay and tools.
+	const chess::Position &get_position() const;
+	void set_position(const chess::Position &new_position);
+
+	// Plays a legal core move, including its promotion piece.
+	void play_move(chess::Move move);
+
+	// Script form of a core move: { "start": Vector2i, "end": Vector2i, "promotion": String (optional) }.
+	static Dictionary move_to_dictionary(chess::Move move);
 };
 
+VARIANT_ENUM_CAST(BoardRules::GameState);
+
 #endif
@@ -0,0 +1,255 @@
+// Builds a Polyglot opening book from PGN games, readable by other Polyglot tools.
+// Usage: chess_book [--max-ply N] [--min-games N] --output book.bin games.pgn...
+// Each (position, move) seen in the first N plies scores 2 for a win, 1 for a draw and 0 for a
+// loss of the side that played it; the weights are those scores scaled into 16 bits.
+
+#include "core/book.h"
+#include "core/movegen.h"
+#include "core/position.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace chess;
+
+namespace {
+
+struct MoveStats {
+	uint64_t score = 0;
+	int games = 0;
+};
+
+typedef std::map<std::pair<uint64_t, uint16_t>, MoveStats> BookStats;
+
+struct Game {
+	std::string fen;
+	std::string result;
+	std::vector<std::string> moves;
+};
+
+// Reads the next game's FEN/Result tags and SAN moves, skipping comments, variations,
+// NAGs, move numbers and the result token.
+bool read_game(std::istream &in, Game &game) {
+	game = Game();
+	bool in_moves = false;
+	std::string line;
+	int comment_depth = 0;
+	int variation_depth = 0;
+
+	while (std::getline(in, line)) {
+		if (comment_depth == 0 && variation_depth == 0 && !line.empty() && line[0] == '[') {
+			if (in_moves) {
+				// A tag after movetext without a result token: the next game has started.
+				in.seekg(-(std::streamoff)line.size() - 1, std::ios::cur);
+				return true;
+			}
+			size_t quote = line.find('"');
+			size_t end = line.rfind('"');
+			if (quote != std::string::npos && end > quote) {
+				std::string value = line.substr(quote + 1, end - quote - 1);
+				if (line.compare(1, 4, "FEN ") == 0) {
+					game.fen = value;
+				} else if (line.compare(1, 7, "Result ") == 0) {
+					game.result = value;
+				}
+			}
+			continue;
+		}
+
+		size_t i = 0;
+		while (i < line.size()) {
+			char c = line[i];
+			if (comment_depth > 0) {
+				comment_depth -= c == '}' ? 1 : 0;
+				i++;
+				continue;
+			}
+			if (c == '{') {
+				comment_depth = 1;
+				i++;
+				continue;
+			}
+			if (c == ';') {
+				break;
+			}
+			if (c == '(') {
+				variation_depth++;
+				i++;
+				continue;
+			}
+			if (c == ')') {
+				variation_depth = std::max(0, variation_depth - 1);
+				i++;
+				continue;
+			}
+			if (std::isspace((unsigned char)c)) {
+				i++;
+				continue;
+			}
+
+			size_t start = i;
+			while (i < line.size() && !std::isspace((unsigned char)line[i]) && line[i] != '{' && line[i] != '(' &&
+					line[i] != ')' && line[i] != ';') {
+				i++;
+			}
+			if (variation_depth > 0) {
+				continue;
+			}
+			std::string token = line.substr(start, i - start);
+			if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+				if (game.result.empty()) {
+					game.result = token;
+				}
+				return true;
+			}
+			if (token[0] == '$') {
+				continue;
+			}
+			// "12." and "12..." prefixes, possibly glued to the move ("12.e4").
+			size_t digits = 0;
+			while (digits < token.size() && std::isdigit((unsigned char)token[digits])) {
+				digits++;
+			}
+			if (digits > 0 && digits < token.size() && token[digits] == '.') {
+				while (digits < token.size() && token[digits] == '.') {
+					digits++;
+				}
+				token = token.substr(digits);
+			} else if (digits == token.size()) {
+				continue;
+			}
+			if (!token.empty()) {
+				game.moves.push_back(token);
+				in_moves = true;
+			}
+		}
+	}
+	return in_moves;
+}
+
+// Adds one game's moves; returns false if a move could not be parsed (the moves before it still count).
+bool add_game(const Game &game, int max_ply, BookStats &stats) {
+	int white_score;
+	if (game.result == "1-0") {
+		white_score = 2;
+	} else if (game.result == "0-1") {
+		white_score = 0;
+	} else if (game.result == "1/2-1/2") {
+		white_score = 1;
+	} else {
+		return true; // Unfinished games say nothing about the moves.
+	}
+
+	Position pos;
+	if (game.fen.empty()) {
+		pos.set_start_position();
+	} else if (!pos.set_fen(game.fen)) {
+		return false;
+	}
+
+	int ply = 0;
+	for (const std::string &san : game.moves) {
+		if (ply >= max_ply) {
+			break;
+		}
+		Move move = parse_san_move(pos, san);
+		if (move == MOVE_NONE) {
+			return false;
+		}
+		MoveStats &entry = stats[std::make_pair(book_key(pos), move_to_book(pos, move))];
+		entry.score += pos.side_to_move() == WHITE ? white_score : 2 - white_score;
+		entry.games++;
+
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		ply++;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	int max_ply = 20;
+	int min_games = 1;
+	std::string output_path;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--max-ply" && i + 1 < argc) {
+			max_ply = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--min-games" && i + 1 < argc) {
+			min_games = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--output" && i + 1 < argc) {
+			output_path = argv[++i];
+		} else if (!arg.empty() && arg[0] != '-') {
+			inputs.push_back(arg);
+		} else {
+			inputs.clear();
+			break;
+		}
+	}
+	if (output_path.empty() || inputs.empty()) {
+		std::fprintf(stderr, "usage: chess_book [--max-ply N] [--min-games N] --output book.bin games.pgn...\n");
+		return 1;
+	}
+	if (!book_keys_valid()) {
+		std::fprintf(stderr, "chess_book: start position key is not %016llx, the key table is damaged\n",
+				(unsigned long long)BOOK_START_KEY);
+		return 1;
+	}
+
+	BookStats stats;
+	int games = 0;
+	int bad_games = 0;
+	for (const std::string &path : inputs) {
+		std::ifstream in(path, std::ios::binary);
+		if (!in) {
+			std::fprintf(stderr, "chess_book: cannot read %s\n", path.c_str());
+			return 1;
+		}
+		Game game;
+		while (read_game(in, game)) {
+			games++;
+			if (!add_game(game, max_ply, stats)) {
+				bad_games++;
+			}
+		}
+	}
+
+	uint64_t max_score = 0;
+	for (const auto &item : stats) {
+		if (item.second.games >= min_games) {
+			max_score = std::max(max_score, item.second.score);
+		}
+	}
+
+	std::vector<BookEntry> entries;
+	for (const auto &item : stats) {
+		if (item.second.games < min_games || item.second.score == 0) {
+			continue;
+		}
+		BookEntry entry;
+		entry.key = item.first.first;
+		entry.move = item.first.second;
+		entry.weight = (uint16_t)std::max<uint64_t>(1, item.second.score * 65535 / max_score);
+		entry.learn = 0;
+		entries.push_back(entry);
+	}
+
+	if (!OpeningBook::write(output_path, entries)) {
+		std::fprintf(stderr, "chess_book: cannot write %s\n", output_path.c_str());
+		return 1;
+	}
+	std::printf("%d games (%d with unreadable moves), %d entries written to %s\n", games, bad_games,
+			(int)entries.size(), output_path.c_str());
+	return 0;
+}
@@ -1,10 +1,18 @@
 #include "chess_agent.h"
+#include "chess_host.h"
 
 // Godot includes for binding, engine checks, and logging.
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+#include "core/evaluate.h"
+#include "core/search_params.h"
+
+#include <algorithm>
+#include <chrono>
+
 using namespace godot;
 
 // Bind methods exposed to GDScript.
@@ -13,14 +21,58 @@ void ChessAgent::_bind_methods() {
         D_METHOD("select_best_move", "possible_moves"),
         &ChessAgent::select_best_move
     );
+    ClassDB::bind_method(D_METHOD("get_search_stats"), &ChessAgent::get_search_stats);
+    ClassDB::bind_method(D_METHOD("start_search", "rules", "options"), &ChessAgent::start_search);
+    ClassDB::bind_method(D_METHOD("is_thinking"), &ChessAgent::is_thinking);
+    ClassDB::bind_method(D_METHOD("start_pondering", "rules", "options"), &ChessAgent::start_pondering);
+    ClassDB::bind_method(D_METHOD("is_pondering"), &ChessAgent::is_pondering);
+    ClassDB::bind_method(D_METHOD("stop_search"), &ChessAgent::stop_search);
+    ClassDB::bind_method(D_METHOD("get_search_result"), &ChessAgent::get_search_result);
+    ClassDB::bind_method(D_METHOD("analyze", "rules", "count", "options"), &ChessAgent::analyze);
+    ClassDB::bind_method(D_METHOD("set_search_param", "name", "value"), &ChessAgent::set_search_param);
+    ClassDB::bind_method(D_METHOD("get_search_params"), &ChessAgent::get_search_params);
+    ClassDB::bind_method(D_METHOD("set_host", "host", "options"), &ChessAgent::set_host);
+    ClassDB::bind_method(D_METHOD("get_host"), &ChessAgent::get_host);
+    ClassDB::bind_method(D_METHOD("get_host_stats"), &ChessAgent::get_host_stats);
+    ClassDB::bind_method(D_METHOD("set_eval_cache_size", "megabytes"), &ChessAgent::set_eval_cache_size);
+    ClassDB::bind_method(D_METHOD("set_eval_mode", "mode"), &ChessAgent::set_eval_mode);
+    ClassDB::bind_method(D_METHOD("get_eval_mode"), &ChessAgent::get_eval_mode);
+    ClassDB::bind_method(D_METHOD("set_search_engine", "name"), &ChessAgent::set_search_engine);
+    ClassDB::bind_method(D_METHOD("get_search_engine"), &ChessAgent::get_search_engine);
+    ClassDB::bind_method(D_METHOD("set_skill_level", "level"), &ChessAgent::set_skill_level);
+    ClassDB::bind_method(D_METHOD("set_elo", "elo"), &ChessAgent::set_elo);
+    ClassDB::bind_method(D_METHOD("get_skill_level"), &ChessAgent::get_skill_level);
+    ClassDB::bind_method(D_METHOD("set_syzygy_path", "path"), &ChessAgent::set_syzygy_path);
+    ClassDB::bind_method(D_METHOD("load_book", "path"), &ChessAgent::load_book);
+    ClassDB::bind_method(D_METHOD("set_book_enabled", "enabled"), &ChessAgent::set_book_enabled);
+    ClassDB::bind_method(D_METHOD("set_book_depth", "plies"), &ChessAgent::set_book_depth);
+    ClassDB::bind_method(D_METHOD("set_book_random", "random"), &ChessAgent::set_book_random);
+    ClassDB::bind_method(D_METHOD("set_online_learning", "enabled", "options"), &ChessAgent::set_online_learning);
+    ClassDB::bind_method(D_METHOD("is_online_learning"), &ChessAgent::is_online_learning);
+    ClassDB::bind_method(D_METHOD("finish_game", "rules"), &ChessAgent::finish_game);
+    ClassDB::bind_method(D_METHOD("get_learning_stats"), &ChessAgent::get_learning_stats);
 }
 
 // Constructor: just initialize pointer; actual net is created in _ready.
 ChessAgent::ChessAgent() {
     neural_net = nullptr;
+    ponder_active = false;
+    ponder_key = 0;
+    ponder_prediction = chess::MOVE_NONE;
+    book_enabled = false;
+    book_max_ply = 16;
+    book_random = true;
+    use_mcts = false;
+    host_id = 0;
+    host_session = 0;
+    host_request = 0;
+    record_search = false;
 }
 
-ChessAgent::~ChessAgent() {}
+ChessAgent::~ChessAgent() {
+    stop_search();
+    set_host(nullptr, Dictionary());
+}
 
 // Set up the neural network when the game runs (skip in editor).
 void ChessAgent::_ready() {
@@ -28,17 +80,39 @@ void ChessAgent::_ready() {
         return;
     }
 
-    // Instantiate and configure the Neural Network.
-    neural_net = memnew(NeuralNet);
+    initialize_network();
+
+    UtilityFunctions::print("C++ ChessAgent initialized with NeuralNet.");
+}
+
+// Instantiate and configure the Neural Network.
+void ChessAgent::initialize_network() {
+    if (neural_net != nullptr) {
+        return;
+    }
+
+    neural_net = create_network();
     add_child(neural_net);
+    prepare_search_network();
+}
 
+NeuralNet *ChessAgent::create_network() {
+    NeuralNet *network = memnew(NeuralNet);
     Array layers;
     layers.push_back(INPUT_NODES);
     layers.push_back(HIDDEN_NODES);
     layers.push_back(OUTPUT_NODES);
-    neural_net->set_layer_sizes(layers);
+    network->set_layer_sizes(layers);
+    network->set_policy_size(POLICY_NODES);
+    return network;
+}
 
-    UtilityFunctions::print("C++ ChessAgent initialized with NeuralNet.");
+NeuralNet *ChessAgent::get_neural_net() const {
+    return neural_net;
+}
+
+chess::Search &ChessAgent::get_search() {
+    return engine;
 }
 
 // Evaluate each move with the neural net and return the highest-scoring move.
@@ -47,10 +121,38 @@ Dictionary ChessAgent::select_best_move(const Array &possible_moves) {
         return Dictionary();
     }
 
+    initialize_network();
+    apply_learning_checkpoint();
+    const chess::Network &network = neural_net->get_network();
+    network.init_workspace(eval_workspace);
+
+    // Every candidate is one node and one evaluation; there is no tree below it.
+    auto start_time = std::chrono::steady_clock::now();
+    last_stats = chess::SearchStats();
+
     // Default to first move as fallback.
     Dictionary best_move = possible_moves[0]; // Fallback to 0th move
     double best_score = -1.0; // Initialize lower than lowest possible sigmoid (0.0)
 
+    // Hybrid mode: a move whose material score is far behind the best one is not worth a network pass.
+    bool lazy = engine.get_eval_mode() == chess::EVAL_HYBRID;
+    std::vector<int> cheap_scores(possible_moves.size(), 0);
+    int best_cheap = -chess::INFINITE_SCORE;
+    if (lazy) {
+        for (int i = 0; i < possible_moves.size(); i++) {
+            Dictionary move = possible_moves[i];
+            if (!move.has("board") || !move.has("end")) {
+                continue;
+            }
+            Array board = move["board"];
+            Vector2i end = move["end"];
+            Array row = board[end.y];
+            Dictionary mover = row[end.x];
+            cheap_scores[i] = board_material_score(board, (int)mover.get("color", 0));
+            best_cheap = std::max(best_cheap, cheap_scores[i]);
+        }
+    }
+
     // Iterate through all candidate moves.
     // Each move already contains the "future state" of the board in the "board" key.
     for (int i = 0; i < possible_moves.size(); i++) {
@@ -59,79 +161,625 @@ Dictionary ChessAgent::select_best_move(const Array &possible_moves) {
         if (!move.has("board")) {
             continue;
         }
-        
-        // 1. Get the future board state directly from the move data.
-        Array future_board_state = move["board"];
+        if (lazy && cheap_scores[i] + engine.get_params().lazy_eval_margin < best_cheap) {
+            last_stats.evaluations++;
+            last_stats.handcrafted_evaluations++;
+            last_stats.lazy_skips++;
+            continue;
+        }
 
-        // 2. Encode board into neural net input vector.
-        Array inputs = encode_board_to_inputs(future_board_state);
+        // 1. Encode the future board state directly from the move data.
+        encode_board_to_inputs(move["board"], eval_inputs);
 
-        // 3. Run Neural Net to get a scalar evaluation.
-        neural_net->set_inputs(inputs);
-        neural_net->compute();
-        Array outputs = neural_net->get_outputs();
-        double score = (double)outputs[0];
+        // 2. Run the network to get a scalar evaluation.
+        auto eval_start = std::chrono::steady_clock::now();
+        double score = network.forward(eval_inputs.data(), eval_workspace)[0];
+        last_stats.eval_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - eval_start).count();
+        last_stats.nodes++;
+        last_stats.evaluations++;
 
-        // 4. Track best-scoring move.
+        // 3. Track best-scoring move.
         if (score > best_score) {
             best_score = score;
             best_move = move;
         }
     }
 
+    last_stats.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
     UtilityFunctions::print("ChessAgent selected move with score: ", best_score);
     return best_move;
 }
 
 // Encode an 8x8 board of Dictionaries into a 768-length one-hot input vector for the NN.
-Array ChessAgent::encode_board_to_inputs(const Array &board_state_2d) {
-    Array inputs;
-
-    // We need 768 inputs (64 squares * 12 piece types).
-    // Mapping matches the previous logic: 
-    // White: P=0, N=1, B=2, R=3, Q=4, K=5
-    // Black: P=6, N=7, B=8, R=9, Q=10, K=11
-    
-    // PieceType enum from BoardRules (presumed):
-    // PAWN=0, ROOK=1, KNIGHT=2, BISHOP=3, QUEEN=4, KING=5
-    
-    // Re-mapping needed to match the 0-11 channel structure:
-    // White (color=0): Pawn(0)->0, Knight(2)->1, Bishop(3)->2, Rook(1)->3, Queen(4)->4, King(5)->5
-    // Black (color=1): Pawn(0)->6, Knight(2)->7, Bishop(3)->8, Rook(1)->9, Queen(4)->10, King(5)->11
-    
-    // Standard map to convert BoardRules PieceType to "Network Order" (P, N, B, R, Q, K)
-    // BoardRules: P=0, R=1, N=2, B=3, Q=4, K=5
-    // Network:    P=0, N=1, B=2, R=3, Q=4, K=5
-    int type_map[6] = {0, 3, 1, 2, 4, 5}; 
+// Channel layout is chess::feature_index, shared with the search's evaluator.
+void ChessAgent::encode_board_to_inputs(const Array &board_state_2d, std::vector<float> &inputs) {
+    inputs.assign(INPUT_NODES, 0.0f);
 
     // Iterate 8x8 grid
     for (int y = 0; y < 8; y++) {
         Array row = board_state_2d[y];
         for (int x = 0; x < 8; x++) {
-            
             Dictionary piece_data = row[x];
-            int active_channel = -1;
-
-            if (piece_data.has("active") && (bool)piece_data["active"]) {
-                int type = (int)piece_data["type"];   // 0-5
-                int color = (int)piece_data["color"]; // 0=White, 1=Black
-                
-                if (type >= 0 && type <= 5) {
-                    int net_type = type_map[type];
-                    active_channel = net_type + (color * 6);
-                }
+            if (!piece_data.has("active") || !(bool)piece_data["active"]) {
+                continue;
             }
 
-            // Fill 12 channels for this square
-            for (int channel = 0; channel < 12; channel++) {
-                if (channel == active_channel) {
-                    inputs.push_back(1.0);
-                } else {
-                    inputs.push_back(0.0);
-                }
+            int type = (int)piece_data["type"];   // 0-5, BoardRules/chess::PieceType order
+            int color = (int)piece_data["color"]; // 0=White, 1=Black
+            if (type >= 0 && type <= 5) {
+                inputs[chess::feature_index(chess::make_piece(color, type), chess::make_square(x, y))] = 1.0f;
+            }
+        }
+    }
+}
+
+int ChessAgent::board_material_score(const Array &board_state_2d, int color) {
+    chess::PhaseScore score;
+    int phase = 0;
+    for (int y = 0; y < 8; y++) {
+        Array row = board_state_2d[y];
+        for (int x = 0; x < 8; x++) {
+            Dictionary piece_data = row[x];
+            if (!piece_data.has("active") || !(bool)piece_data["active"]) {
+                continue;
             }
+            int type = (int)piece_data["type"];
+            if (type >= 0 && type <= 5) {
+                score += chess::PSQ[chess::make_piece((int)piece_data["color"], type)][chess::make_square(x, y)];
+                phase += chess::PHASE_WEIGHT[type];
+            }
+        }
+    }
+    int value = chess::taper(score, phase);
+    return color == chess::WHITE ? value : -value;
+}
+
+// Search from the rules' current position with the core engine.
+// Only fully completed iterations update the result, so a node cap never returns a half-searched move.
+chess::SearchResult ChessAgent::search(BoardRules *rules, int max_depth, int64_t max_nodes) {
+    initialize_network();
+    prepare_search_network();
+
+    chess::SearchLimits limits;
+    // Without any cap, default to a single ply like select_best_move.
+    limits.depth = (max_depth > 0 || max_nodes > 0) ? max_depth : 1;
+    limits.nodes = max_nodes;
+    const chess::Position &position = rules->get_position();
+    chess::SearchResult result = use_mcts ? mcts.run(position, limits) : engine.run(position, limits);
+    last_stats = result.stats;
+    return result;
+}
+
+// Multi-PV lines as move Dictionaries with score, depth and the PV as further move Dictionaries.
+static Array lines_to_array(const std::vector<chess::RootLine> &lines) {
+    Array array;
+    for (const chess::RootLine &line : lines) {
+        Dictionary entry = BoardRules::move_to_dictionary(line.move);
+        entry["score"] = line.score;
+        entry["depth"] = line.depth;
+        Array pv;
+        for (chess::Move move : line.pv) {
+            pv.push_back(BoardRules::move_to_dictionary(move));
+        }
+        entry["pv"] = pv;
+        array.push_back(entry);
+    }
+    return array;
+}
+
+// Clock and budget options for start_search, for the side to move us.
+static chess::SearchLimits read_limits(const Dictionary &options, int us) {
+    chess::SearchLimits limits;
+    limits.time[us] = (int64_t)options.get("time", 0);
+    limits.increment[us] = (int64_t)options.get("increment", 0);
+    limits.moves_to_go = options.get("moves_to_go", 0);
+    limits.movetime = (int64_t)options.get("movetime", 0);
+    limits.depth = options.get("depth", 0);
+    limits.nodes = (int64_t)options.get("nodes", 0);
+    limits.multi_pv = std::max(1, (int)options.get("multi_pv", 1));
+    if (limits.time[us] <= 0 && limits.movetime <= 0 && limits.depth <= 0 && limits.nodes <= 0) {
+        limits.depth = 1;
+    }
+    return limits;
+}
+
+void ChessAgent::start_search(BoardRules *rules, const Dictionary &options) {
+    if (rules == nullptr) {
+        return;
+    }
+    initialize_network();
+    const chess::Position &position = rules->get_position();
+
+    // Ponderhit: the running search already has this root and keeps everything it found.
+    if (ponder_active && engine.is_searching() && position.key() == ponder_key) {
+        ponder_active = false;
+        engine.ponderhit();
+        searched_position = position;
+        record_search = learner.is_running();
+        return;
+    }
+
+    stop_search();
+    prepare_search_network();
+    async_result = chess::SearchResult();
+    record_search = false;
+
+    // A book move is the result straight away; is_thinking() is already false.
+    int game_ply = 2 * (position.get_fullmove_number() - 1) + (position.side_to_move() == chess::BLACK ? 1 : 0);
+    if (book_enabled && book.is_open() && game_ply < book_max_ply) {
+        chess::Position book_position = position;
+        async_result.best_move = book.probe(book_position, book_random);
+        if (async_result.best_move != chess::MOVE_NONE) {
+            return;
+        }
+    }
+
+    searched_position = position;
+    record_search = learner.is_running();
+    chess::SearchLimits limits = read_limits(options, position.side_to_move());
+    ChessHost *host = get_attached_host();
+    if (host != nullptr) {
+        host_request = host->get_engine_host().submit(host_session, position, limits);
+        if (host_request != 0) {
+            return;
+        }
+        UtilityFunctions::printerr("ChessAgent: the host refused the search; searching locally");
+    }
+
+    auto on_finish = [this](const chess::SearchResult &result) { async_result = result; };
+    if (use_mcts) {
+        mcts.start(position, limits, chess::Mcts::InfoCallback(), on_finish);
+    } else {
+        engine.start(position, limits, chess::Search::InfoCallback(), on_finish);
+    }
+}
+
+bool ChessAgent::is_thinking() const {
+    if (host_request != 0) {
+        ChessHost *host = get_attached_host();
+        chess::RequestState state = host != nullptr ? host->get_engine_host().poll(host_request, nullptr) : chess::REQUEST_UNKNOWN;
+        if (state == chess::REQUEST_QUEUED || state == chess::REQUEST_RUNNING) {
+            return true;
+        }
+    }
+    return (engine.is_searching() && !engine.is_pondering()) || mcts.is_searching();
+}
+
+bool ChessAgent::start_pondering(BoardRules *rules, const Dictionary &options) {
+    if (rules == nullptr || use_mcts || get_attached_host() != nullptr) {
+        return false;
+    }
+    // The finished search's second PV move is the reply it expects. A ponder search still
+    // running (start_pondering called twice) only ends when stopped, as on a ponder miss; its
+    // result is about the position after the guess, so the guess it started from is kept.
+    chess::Move predicted;
+    if (ponder_active) {
+        ponder_active = false;
+        engine.stop();
+        engine.wait();
+        predicted = ponder_prediction;
+    } else {
+        engine.wait();
+        predicted = async_result.ponder_move;
+    }
+    prepare_search_network();
+    if (predicted == chess::MOVE_NONE) {
+        return false;
+    }
+
+    chess::Position position = rules->get_position();
+    chess::MoveList legal;
+    chess::generate_legal_moves(position, legal);
+    if (!legal.contains(predicted)) {
+        return false;
+    }
+    chess::UndoInfo undo;
+    position.make_move(predicted, undo);
+
+    // Limits are for the agent's own move after the prediction; they only apply from ponderhit.
+    chess::SearchLimits limits = read_limits(options, position.side_to_move());
+    limits.ponder = true;
+
+    async_result = chess::SearchResult();
+    record_search = false;
+    ponder_active = true;
+    ponder_key = position.key();
+    ponder_prediction = predicted;
+    engine.start(position, limits, chess::Search::InfoCallback(),
+            [this](const chess::SearchResult &result) { async_result = result; });
+    return true;
+}
+
+bool ChessAgent::is_pondering() const {
+    return ponder_active && engine.is_pondering();
+}
+
+// Takes the host request's result, if one is outstanding, into async_result.
+void ChessAgent::stop_search() {
+    if (host_request != 0) {
+        ChessHost *host = get_attached_host();
+        if (host != nullptr) {
+            host->get_engine_host().cancel(host_request);
+            host->get_engine_host().wait(host_request, async_result);
+        }
+        host_request = 0;
+    }
+    ponder_active = false;
+    engine.stop();
+    mcts.stop();
+    engine.wait();
+    mcts.wait();
+}
+
+Dictionary ChessAgent::get_search_result() {
+    if (host_request != 0) {
+        ChessHost *host = get_attached_host();
+        if (host != nullptr) {
+            host->get_engine_host().wait(host_request, async_result);
         }
+        host_request = 0;
     }
+    engine.wait();
+    mcts.wait();
+    if (async_result.best_move == chess::MOVE_NONE) {
+        return Dictionary();
+    }
+    record_search_result();
+    apply_learning_checkpoint();
+
+    last_stats = async_result.stats;
+    Dictionary result = BoardRules::move_to_dictionary(async_result.best_move);
+    result["score"] = async_result.score;
+    result["depth"] = async_result.depth;
+    result["nodes"] = async_result.nodes;
+    result["time_ms"] = async_result.time_ms;
+    result["lines"] = lines_to_array(async_result.lines);
+    return result;
+}
+
+Array ChessAgent::analyze(BoardRules *rules, int count, const Dictionary &options) {
+    if (rules == nullptr) {
+        return Array();
+    }
+    initialize_network();
+    stop_search();
+    prepare_search_network();
+    const chess::Position &position = rules->get_position();
+    chess::SearchLimits limits = read_limits(options, position.side_to_move());
+    limits.multi_pv = std::max(1, count);
+    chess::SearchResult result = use_mcts ? mcts.run(position, limits) : engine.run(position, limits);
+    last_stats = result.stats;
+    return lines_to_array(result.lines);
+}
+
+// Raw counters plus the derived rates scripts usually want.
+Dictionary ChessAgent::get_search_stats() const {
+    Dictionary stats;
+    stats["nodes"] = last_stats.nodes;
+    stats["qnodes"] = last_stats.qnodes;
+    stats["time_ms"] = last_stats.time_ms;
+    stats["nps"] = last_stats.nps();
+    stats["branching_factor"] = last_stats.branching_factor;
+    stats["tt_probes"] = last_stats.tt_probes;
+    stats["tt_hits"] = last_stats.tt_hits;
+    stats["tt_cutoffs"] = last_stats.tt_cutoffs;
+    stats["tt_hit_rate"] = last_stats.tt_hit_rate();
+    stats["tt_cutoff_rate"] = last_stats.tt_cutoff_rate();
+    stats["beta_cutoffs"] = last_stats.beta_cutoffs;
+    stats["first_move_cutoff_rate"] = last_stats.first_move_cutoff_rate();
+    stats["evaluations"] = last_stats.evaluations;
+    stats["eval_cache_hits"] = last_stats.eval_cache_hits;
+    stats["eval_cache_hit_rate"] = last_stats.eval_cache_hit_rate();
+    stats["handcrafted_evaluations"] = last_stats.handcrafted_evaluations;
+    stats["lazy_skips"] = last_stats.lazy_skips;
+    stats["lazy_skip_rate"] = last_stats.lazy_skip_rate();
+    stats["policy_evaluations"] = last_stats.policy_evaluations;
+    stats["movegen_calls"] = last_stats.movegen_calls;
+    stats["movegen_ms"] = last_stats.movegen_ns / 1e6;
+    stats["eval_ms"] = last_stats.eval_ns / 1e6;
+    stats["null_move_tries"] = last_stats.null_move_tries;
+    stats["null_move_cutoffs"] = last_stats.null_move_cutoffs;
+    stats["lmr_reductions"] = last_stats.lmr_reductions;
+    stats["lmr_researches"] = last_stats.lmr_researches;
+    stats["pvs_searches"] = last_stats.pvs_searches;
+    stats["pvs_researches"] = last_stats.pvs_researches;
+    stats["pvs_research_rate"] = last_stats.pvs_research_rate();
+    stats["aspiration_searches"] = last_stats.aspiration_searches;
+    stats["aspiration_fail_lows"] = last_stats.aspiration_fail_lows;
+    stats["aspiration_fail_highs"] = last_stats.aspiration_fail_highs;
+    stats["aspiration_research_rate"] = last_stats.aspiration_research_rate();
+    stats["reverse_futility_prunes"] = last_stats.reverse_futility_prunes;
+    stats["futility_prunes"] = last_stats.futility_prunes;
+    stats["razoring_prunes"] = last_stats.razoring_prunes;
+    stats["check_extensions"] = last_stats.check_extensions;
+    stats["tb_probes"] = last_stats.tb_probes;
+    stats["tb_hits"] = last_stats.tb_hits;
+    const chess::MctsStats &tree = mcts.get_last_stats();
+    stats["mcts_playouts"] = tree.playouts;
+    stats["mcts_batches"] = tree.batches;
+    stats["mcts_average_batch"] = tree.average_batch();
+    stats["mcts_collisions"] = tree.collisions;
+    stats["mcts_tree_nodes"] = tree.tree_nodes;
+    stats["mcts_reused_nodes"] = tree.reused_nodes;
+    stats["mcts_max_depth"] = tree.max_depth;
+    return stats;
+}
+
+// Parameters only change between searches, so a running one is stopped first.
+bool ChessAgent::set_search_param(const String &name, int value) {
+    stop_search();
+    chess::SearchParams params = engine.get_params();
+    if (!chess::set_search_param(params, name.utf8().get_data(), value)) {
+        UtilityFunctions::printerr("ChessAgent: unknown search parameter ", name);
+        return false;
+    }
+    engine.set_params(params);
+    return true;
+}
+
+Dictionary ChessAgent::get_search_params() const {
+    Dictionary params;
+    for (int i = 0; i < chess::SEARCH_PARAM_COUNT; i++) {
+        const chess::SearchParamInfo &info = chess::SEARCH_PARAM_TABLE[i];
+        params[info.name] = engine.get_params().*info.field;
+    }
+    return params;
+}
+
+bool ChessAgent::set_eval_mode(const String &mode) {
+    stop_search();
+    if (mode == "network") {
+        engine.set_eval_mode(chess::EVAL_NETWORK);
+    } else if (mode == "handcrafted") {
+        engine.set_eval_mode(chess::EVAL_HANDCRAFTED);
+    } else if (mode == "hybrid") {
+        engine.set_eval_mode(chess::EVAL_HYBRID);
+    } else {
+        UtilityFunctions::printerr("ChessAgent: unknown eval mode ", mode);
+        return false;
+    }
+    mcts.set_eval_mode(engine.get_eval_mode());
+    configure_host_session();
+    return true;
+}
+
+ChessHost *ChessAgent::get_attached_host() const {
+    if (host_id == 0) {
+        return nullptr;
+    }
+    return Object::cast_to<ChessHost>(ObjectDB::get_instance(host_id));
+}
+
+void ChessAgent::configure_host_session() {
+    host_config.skill_level = engine.get_skill_level();
+    host_config.eval_mode = engine.get_eval_mode();
+    ChessHost *host = get_attached_host();
+    if (host != nullptr) {
+        host->get_engine_host().configure_session(host_session, host_config);
+    }
+}
+
+bool ChessAgent::set_host(ChessHost *host, const Dictionary &options) {
+    stop_search();
+    chess::SessionConfig config;
+    if (host != nullptr && !ChessHost::read_session_config(options, config)) {
+        return false;
+    }
+
+    ChessHost *previous = get_attached_host();
+    if (previous != nullptr) {
+        previous->get_engine_host().close_session(host_session);
+    }
+    host_id = 0;
+    host_session = 0;
+    if (host == nullptr) {
+        return true;
+    }
+
+    host_config = config;
+    host_config.skill_level = engine.get_skill_level();
+    host_config.eval_mode = engine.get_eval_mode();
+    host_session = host->get_engine_host().open_session(host_config);
+    host_id = host->get_instance_id();
+    return true;
+}
+
+ChessHost *ChessAgent::get_host() const {
+    return get_attached_host();
+}
+
+Dictionary ChessAgent::get_host_stats() const {
+    ChessHost *host = get_attached_host();
+    return host != nullptr ? host->get_session_stats(host_session) : Dictionary();
+}
+
+bool ChessAgent::set_search_engine(const String &name) {
+    stop_search();
+    if (name == "alphabeta") {
+        use_mcts = false;
+    } else if (name == "mcts") {
+        use_mcts = true;
+    } else {
+        UtilityFunctions::printerr("ChessAgent: unknown search engine ", name);
+        return false;
+    }
+    return true;
+}
+
+String ChessAgent::get_search_engine() const {
+    return use_mcts ? "mcts" : "alphabeta";
+}
+
+String ChessAgent::get_eval_mode() const {
+    switch (engine.get_eval_mode()) {
+        case chess::EVAL_HANDCRAFTED: return "handcrafted";
+        case chess::EVAL_HYBRID: return "hybrid";
+        default: return "network";
+    }
+}
+
+void ChessAgent::set_skill_level(int level) {
+    stop_search();
+    engine.set_skill_level(level);
+    configure_host_session();
+}
+
+void ChessAgent::set_elo(int elo) {
+    stop_search();
+    engine.set_elo(elo);
+    configure_host_session();
+}
+
+int ChessAgent::get_skill_level() const {
+    return engine.get_skill_level();
+}
+
+void ChessAgent::set_eval_cache_size(int megabytes) {
+    stop_search();
+    engine.set_eval_cache_size((size_t)std::max(1, megabytes));
+}
+
+int ChessAgent::set_syzygy_path(const String &path) {
+    stop_search();
+    PackedStringArray directories = path.split(";", false);
+    std::string paths;
+    for (int i = 0; i < directories.size(); i++) {
+        String directory = ProjectSettings::get_singleton()->globalize_path(directories[i]);
+        paths += (paths.empty() ? "" : ";") + std::string(directory.utf8().get_data());
+    }
+    int count = tablebases.init(paths);
+    engine.set_tablebases(count > 0 ? &tablebases : nullptr);
+    UtilityFunctions::print("ChessAgent: ", count, " Syzygy tables, up to ", tablebases.max_pieces(), " pieces");
+    return count;
+}
+
+bool ChessAgent::load_book(const String &path) {
+    stop_search();
+    String file = ProjectSettings::get_singleton()->globalize_path(path);
+    if (!book.open(file.utf8().get_data())) {
+        UtilityFunctions::printerr("ChessAgent: could not load opening book ", path);
+        book_enabled = false;
+        return false;
+    }
+    book_enabled = true;
+    UtilityFunctions::print("ChessAgent: opening book with ", (int64_t)book.size(), " entries");
+    return true;
+}
+
+void ChessAgent::set_book_enabled(bool enabled) {
+    book_enabled = enabled;
+}
+
+void ChessAgent::set_book_depth(int plies) {
+    book_max_ply = std::max(0, plies);
+}
+
+void ChessAgent::set_book_random(bool random) {
+    book_random = random;
+}
+
+void ChessAgent::record_search_result() {
+    if (!record_search) {
+        return;
+    }
+    record_search = false;
+    int game_ply = 2 * (searched_position.get_fullmove_number() - 1) + (searched_position.side_to_move() == chess::BLACK ? 1 : 0);
+    // A position no later than the last one recorded means a new game was set up without finish_game.
+    if (!game_records.empty() && game_ply <= game_records.back().ply) {
+        game_records.clear();
+    }
+    game_records.push_back(chess::pack_position(searched_position, game_ply, async_result.score));
+}
+
+void ChessAgent::apply_learning_checkpoint() {
+    if (neural_net == nullptr || engine.is_searching() || mcts.is_searching()) {
+        return;
+    }
+    learner.apply_checkpoint(neural_net->get_network());
+}
+
+void ChessAgent::prepare_search_network() {
+    if (neural_net == nullptr || engine.is_searching() || mcts.is_searching()) {
+        return;
+    }
+    apply_learning_checkpoint();
+    search_network = neural_net->get_snapshot();
+    engine.set_network(search_network.get());
+    mcts.set_network(search_network.get());
+}
+
+bool ChessAgent::set_online_learning(bool enabled, const Dictionary &options) {
+    if (!enabled) {
+        learner.stop();
+        return true;
+    }
+
+    chess::OnlineLearningConfig config;
+    int64_t capacity = options.get("capacity", (int64_t)config.capacity);
+    int64_t min_positions = options.get("min_positions", (int64_t)config.min_positions);
+    config.batch_size = options.get("batch_size", config.batch_size);
+    config.learning_rate = (float)(double)options.get("learning_rate", config.learning_rate);
+    config.result_weight = (float)(double)options.get("result_weight", config.result_weight);
+    config.checkpoint_batches = options.get("checkpoint_batches", config.checkpoint_batches);
+    config.replay_ratio = options.get("replay_ratio", config.replay_ratio);
+    config.seed = (int64_t)options.get("seed", (int64_t)config.seed);
+    if (capacity <= 0 || min_positions < 0 || config.batch_size <= 0 || config.learning_rate <= 0.0f ||
+            config.result_weight < 0.0f || config.result_weight > 1.0f || config.checkpoint_batches <= 0 ||
+            config.replay_ratio <= 0) {
+        UtilityFunctions::printerr("ChessAgent: invalid online learning options ", options);
+        return false;
+    }
+    config.capacity = (size_t)capacity;
+    config.min_positions = (size_t)min_positions;
+
+    initialize_network();
+    // The trainer copies the weights now; a search reading them meanwhile is fine.
+    if (!learner.start(neural_net->get_network(), config)) {
+        UtilityFunctions::printerr("ChessAgent: the network has no value output to train");
+        return false;
+    }
+    return true;
+}
+
+bool ChessAgent::is_online_learning() const {
+    return learner.is_running();
+}
+
+int ChessAgent::finish_game(BoardRules *rules) {
+    std::vector<chess::PackedPosition> records;
+    records.swap(game_records);
+    record_search = false;
+    if (rules == nullptr || !learner.is_running()) {
+        return 0;
+    }
+
+    int state = rules->get_game_state();
+    if (state == BoardRules::ONGOING) {
+        return 0;
+    }
+    // Checkmate: the side to move lost. Everything else ending a game is a draw.
+    int white_result = 0;
+    if (state == BoardRules::CHECKMATE) {
+        white_result = rules->get_turn() == chess::WHITE ? -1 : 1;
+    }
+    for (chess::PackedPosition &record : records) {
+        record.result = (int8_t)(record.side_to_move == chess::WHITE ? white_result : -white_result);
+    }
+    learner.add_game(records);
+    return (int)records.size();
+}
 
-    return inputs;
+Dictionary ChessAgent::get_learning_stats() const {
+    chess::OnlineLearningStats stats = learner.get_stats();
+    Dictionary result;
+    result["games"] = stats.games;
+    result["positions"] = stats.positions_added;
+    result["buffer_size"] = stats.buffer_size;
+    result["batches"] = stats.batches;
+    result["samples"] = stats.samples;
+    result["checkpoints"] = stats.checkpoints;
+    result["applied"] = stats.applied;
+    result["loss"] = stats.loss;
+    return result;
 }
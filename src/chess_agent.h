@@ -6,12 +6,25 @@
 #include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/dictionary.hpp>
 
-// Local dependency: the neural network used to evaluate positions.
+// Local dependencies: the neural network used to evaluate positions and the rules it searches.
 #include "neural_net.h"
+#include "board_rules.h"
+
+// The search itself is part of the Godot-free core.
+#include "core/search.h"
+#include "core/mcts.h"
+#include "core/book.h"
+#include "core/engine_host.h"
+#include "core/online_learning.h"
+
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace godot {
 
+class ChessHost;
+
 // C++ chess agent node that uses NeuralNet to score and pick moves.
 class ChessAgent : public Node {
     GDCLASS(ChessAgent, Node)
@@ -20,15 +33,79 @@ private:
     // Owned neural network instance used for evaluation.
     NeuralNet *neural_net;
 
+    // Core search evaluating with neural_net's weights; one search at a time per agent.
+    chess::Search engine;
+
+    // Snapshot of neural_net's weights that engine and mcts read, replaced only between searches
+    // so scripts can train or reload the network while one runs.
+    std::shared_ptr<const chess::Network> search_network;
+
+    // Monte Carlo tree search over the same network, used instead of engine when use_mcts is set.
+    chess::Mcts mcts;
+    bool use_mcts;
+
+    // Syzygy tables the search probes once set_syzygy_path found some.
+    chess::Tablebases tablebases;
+
+    // Opening book consulted by start_search before searching, up to book_max_ply plies into the game.
+    chess::OpeningBook book;
+    bool book_enabled;
+    int book_max_ply;
+    bool book_random;
+
+    // Shared search service set by set_host (by instance id, so a freed host is noticed), the
+    // session opened there and the request start_search queued, or 0.
+    uint64_t host_id;
+    int host_session;
+    uint64_t host_request;
+    chess::SessionConfig host_config;
+
+    ChessHost *get_attached_host() const;
+    void configure_host_session();
+
+    // Online learning: the positions this agent searched in the current game, labelled by
+    // finish_game and replayed by learner into neural_net's weights between searches.
+    chess::OnlineLearner learner;
+    std::vector<chess::PackedPosition> game_records;
+    chess::Position searched_position;
+    bool record_search;
+
+    // Keep the finished search's root and score for the game's records.
+    void record_search_result();
+    // Swap in the learner's newest weights; only called while no search of this agent runs.
+    void apply_learning_checkpoint();
+    // Same, then hand the current weights to engine and mcts; before each search starts.
+    void prepare_search_network();
+
     // Neural Net configuration:
     // - 768 input nodes: 64 squares * 12 piece channels.
     // - Hidden and output sizes are fixed here for simplicity.
-    const int INPUT_NODES = 768; // 64 squares * 12 types of pieces
-    const int HIDDEN_NODES = 128;
-    const int OUTPUT_NODES = 1;
+    // - A from-to policy head on the hidden layer orders the search's moves once trained.
+    static const int INPUT_NODES = 768; // 64 squares * 12 types of pieces
+    static const int HIDDEN_NODES = 128;
+    static const int OUTPUT_NODES = 1;
+    static const int POLICY_NODES = chess::POLICY_OUTPUTS; // 64 from squares * 64 to squares
 
     // Convert a 8x8 board Array (of Dictionaries) into 768 input features for the net.
-    Array encode_board_to_inputs(const Array &board_state_2d);
+    void encode_board_to_inputs(const Array &board_state_2d, std::vector<float> &inputs);
+
+    // Tapered material + piece-square score of a board Array for color, in centipawns.
+    static int board_material_score(const Array &board_state_2d, int color);
+
+    // Result of the last background search, written by the search thread before it finishes.
+    chess::SearchResult async_result;
+
+    // Position being pondered (after the predicted reply ponder_prediction), if a ponder search is running.
+    bool ponder_active;
+    uint64_t ponder_key;
+    chess::Move ponder_prediction;
+
+    // Statistics of the last search or select_best_move call, for get_search_stats.
+    chess::SearchStats last_stats;
+
+    // Scratch buffers for select_best_move.
+    std::vector<float> eval_inputs;
+    chess::Network::Workspace eval_workspace;
 
 protected:
     static void _bind_methods();
@@ -43,6 +120,106 @@ public:
     // Select the best move from possible_moves using the neural net evaluation.
     // Now only takes the list of moves because each move contains its future board state.
     Dictionary select_best_move(const Array &possible_moves);
+
+    // Counters of the last search or select_best_move call (nodes, nps, TT and cutoff rates, timings).
+    Dictionary get_search_stats() const;
+
+    // Create the evaluation network if it does not exist yet (done by _ready in the scene).
+    void initialize_network();
+    NeuralNet *get_neural_net() const;
+    // A new network with the agent's layout (not yet in the scene tree).
+    static NeuralNet *create_network();
+    chess::Search &get_search();
+
+    // Iterative-deepening search from the current position of rules (C++ only).
+    // max_depth <= 0 removes the depth cap, max_nodes <= 0 removes the node cap.
+    chess::SearchResult search(BoardRules *rules, int max_depth, int64_t max_nodes);
+
+    // Background search for scripts: start it, poll is_thinking() (e.g. from _process), then read
+    // get_search_result(). Optional option keys: time (ms left for the side to move), increment (ms),
+    // moves_to_go, movetime (ms), depth, nodes, multi_pv. Without any limit a 1-ply search is run.
+    // If a ponder search is running on exactly this position it is converted instead (ponderhit),
+    // otherwise it is aborted and a new search starts with the table it warmed up.
+    void start_search(BoardRules *rules, const Dictionary &options);
+    bool is_thinking() const;
+
+    // After the agent has moved: search the position after the reply predicted by the last search
+    // on the opponent's time. Returns false when there is no prediction to ponder on.
+    bool start_pondering(BoardRules *rules, const Dictionary &options);
+    bool is_pondering() const;
+    void stop_search();
+
+    // Waits for a running search. Returns the chosen move as in BoardRules::move_to_dictionary plus
+    // score, depth, nodes, time_ms and lines (see analyze); empty if there was no legal move.
+    Dictionary get_search_result();
+
+    // Blocking multi-PV search: the best `count` moves from one search, best first, each a move
+    // Dictionary with score, depth and pv (an Array of move Dictionaries). Options as for start_search.
+    Array analyze(BoardRules *rules, int count, const Dictionary &options);
+
+    // Selectivity parameters by name (NullMove, LMR, Futility, ...; see core/search_params.cpp).
+    // Returns false for an unknown name; values are clamped to the parameter's range.
+    bool set_search_param(const String &name, int value);
+
+    // Playing strength 1-20 (20, the default, is full strength) or a target Elo (800-2800). Lower
+    // levels cap depth and nodes, so they are also cheaper, and pick among the best few moves.
+    void set_skill_level(int level);
+    void set_elo(int elo);
+    int get_skill_level() const;
+
+    // Search evaluator: "network" (the default; the handcrafted evaluation stands in while no
+    // network is set), "handcrafted" (material, piece-square tables and pawn structure only) or
+    // "hybrid" (the network only where the handcrafted score is within LazyEvalMargin of the
+    // window; select_best_move then skips the network for moves that far behind the best one).
+    bool set_eval_mode(const String &mode);
+    String get_eval_mode() const;
+
+    // Search algorithm for start_search, search and analyze: "alphabeta" (the default) or "mcts"
+    // (PUCT tree search with batched network calls, keeping its tree between moves; nodes limits
+    // count playouts, depth limits are ignored and it does not ponder).
+    bool set_search_engine(const String &name);
+    String get_search_engine() const;
+
+    // Queue start_search's searches on a ChessHost's shared workers and network instead of this
+    // agent's own engine, in a session opened with options (see ChessHost.open_session; the
+    // agent's skill level and eval mode are added). search, analyze and pondering stay local.
+    // A null host detaches the agent. Returns false if the options are invalid.
+    bool set_host(ChessHost *host, const Dictionary &options);
+    ChessHost *get_host() const;
+    // The host session's counters (see ChessHost.get_session_stats); empty without a host.
+    Dictionary get_host_stats() const;
+
+    // Size of the network-output cache shared by the search threads (default 4 MB).
+    void set_eval_cache_size(int megabytes);
+
+    // Directories (res:// and user:// allowed, ';'-separated) holding Syzygy .rtbw/.rtbz files.
+    // Returns the number of tables found; an empty path turns probing off.
+    int set_syzygy_path(const String &path);
+    Dictionary get_search_params() const;
+
+    // Polyglot-layout book built by chess_book (res:// and user:// allowed); enables the book on success.
+    bool load_book(const String &path);
+    void set_book_enabled(bool enabled);
+    // Plies from the start of the game during which book moves are played (default 16).
+    void set_book_depth(int plies);
+    // Weighted random choice between book moves (default) or always the heaviest one.
+    void set_book_random(bool random);
+
+    // Learn from the games this agent plays: every searched position is kept with its score
+    // and, once finish_game gives the result, added to a replay buffer that a background
+    // thread trains a copy of the network on. The live weights are replaced by that copy at
+    // checkpoints, always between two searches, so neither the game nor a search waits for
+    // training. Weights set on the NeuralNet while learning are overwritten at the next
+    // checkpoint. Optional option keys: capacity, min_positions, batch_size, learning_rate,
+    // result_weight (0-1, game result against search score in the target), checkpoint_batches,
+    // replay_ratio, seed. Returns false for invalid options.
+    bool set_online_learning(bool enabled, const Dictionary &options);
+    bool is_online_learning() const;
+    // Label the current game's positions with the result of rules' finished game and queue them
+    // for training; an unfinished game's positions are dropped. Returns the positions added.
+    int finish_game(BoardRules *rules);
+    // Counters: games, positions, buffer_size, batches, samples, checkpoints, applied, loss.
+    Dictionary get_learning_stats() const;
 };
 
 } // namespace godot
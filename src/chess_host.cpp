@@ -0,0 +1,173 @@
+#include "chess_host.h"
+#include "chess_agent.h"
+
+// Godot includes for binding and logging.
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <thread>
+
+using namespace godot;
+
+// Bind methods exposed to GDScript.
+void ChessHost::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_workers", "count"), &ChessHost::set_workers);
+    ClassDB::bind_method(D_METHOD("get_workers"), &ChessHost::get_workers);
+    ClassDB::bind_method(D_METHOD("set_hash_size", "megabytes"), &ChessHost::set_hash_size);
+    ClassDB::bind_method(D_METHOD("get_hash_size"), &ChessHost::get_hash_size);
+    ClassDB::bind_method(D_METHOD("get_neural_net"), &ChessHost::get_neural_net);
+    ClassDB::bind_method(D_METHOD("open_session", "options"), &ChessHost::open_session);
+    ClassDB::bind_method(D_METHOD("configure_session", "session", "options"), &ChessHost::configure_session);
+    ClassDB::bind_method(D_METHOD("close_session", "session"), &ChessHost::close_session);
+    ClassDB::bind_method(D_METHOD("get_session_stats", "session"), &ChessHost::get_session_stats);
+    ClassDB::bind_method(D_METHOD("get_stats"), &ChessHost::get_stats);
+
+    ClassDB::add_property("ChessHost", PropertyInfo(Variant::INT, "workers"), "set_workers", "get_workers");
+    ClassDB::add_property("ChessHost", PropertyInfo(Variant::INT, "hash_size"), "set_hash_size", "get_hash_size");
+}
+
+// The pool is only started by the first search, so editor instances spawn no threads.
+ChessHost::ChessHost() {
+    neural_net = nullptr;
+    int hardware_threads = (int)std::thread::hardware_concurrency();
+    workers = hardware_threads > 0 ? hardware_threads : 1;
+    hash_size = 16;
+    started = false;
+}
+
+// Predelete has normally stopped the pool already, also for a host freed outside the tree.
+ChessHost::~ChessHost() {
+    stop_pool();
+}
+
+void ChessHost::_notification(int p_what) {
+    if (p_what == NOTIFICATION_PREDELETE) {
+        stop_pool();
+    }
+}
+
+void ChessHost::_exit_tree() {
+    stop_pool();
+}
+
+void ChessHost::stop_pool() {
+    if (started) {
+        started = false;
+        host.shutdown();
+    }
+}
+
+void ChessHost::set_workers(int count) {
+    workers = std::max(1, count);
+    if (started) {
+        host.set_workers(workers, (size_t)hash_size);
+    }
+}
+
+int ChessHost::get_workers() const {
+    return workers;
+}
+
+void ChessHost::set_hash_size(int megabytes) {
+    hash_size = std::max(1, megabytes);
+    if (started) {
+        host.set_workers(workers, (size_t)hash_size);
+    }
+}
+
+int ChessHost::get_hash_size() const {
+    return hash_size;
+}
+
+NeuralNet *ChessHost::get_neural_net() {
+    if (neural_net == nullptr) {
+        neural_net = ChessAgent::create_network();
+        add_child(neural_net);
+    }
+    return neural_net;
+}
+
+chess::EngineHost &ChessHost::get_engine_host() {
+    // Workers search on a snapshot, so scripts can train or reload the child meanwhile; requests
+    // queued from here on pick up the new weights.
+    std::shared_ptr<const chess::Network> snapshot = get_neural_net()->get_snapshot();
+    if (snapshot != published_network) {
+        published_network = snapshot;
+        host.set_network(snapshot);
+    }
+    if (!started) {
+        started = true;
+        host.set_workers(workers, (size_t)hash_size);
+    }
+    return host;
+}
+
+// Fills config from options; keys that are missing keep config's values.
+bool ChessHost::read_session_config(const Dictionary &options, chess::SessionConfig &config) {
+    config.priority = options.get("priority", config.priority);
+    config.max_nodes = (int64_t)options.get("max_nodes", config.max_nodes);
+    config.max_time_ms = (int64_t)options.get("max_time_ms", config.max_time_ms);
+    config.max_queued = options.get("max_queued", config.max_queued);
+    config.skill_level = options.get("skill_level", config.skill_level);
+    if (options.has("eval_mode")) {
+        String mode = options["eval_mode"];
+        if (mode == "network") {
+            config.eval_mode = chess::EVAL_NETWORK;
+        } else if (mode == "handcrafted") {
+            config.eval_mode = chess::EVAL_HANDCRAFTED;
+        } else if (mode == "hybrid") {
+            config.eval_mode = chess::EVAL_HYBRID;
+        } else {
+            UtilityFunctions::printerr("ChessHost: unknown eval mode ", mode);
+            return false;
+        }
+    }
+    return true;
+}
+
+int ChessHost::open_session(const Dictionary &options) {
+    chess::SessionConfig config;
+    if (!read_session_config(options, config)) {
+        return 0;
+    }
+    return get_engine_host().open_session(config);
+}
+
+bool ChessHost::configure_session(int session, const Dictionary &options) {
+    chess::SessionConfig config;
+    if (!host.get_session_config(session, config) || !read_session_config(options, config)) {
+        return false;
+    }
+    return host.configure_session(session, config);
+}
+
+void ChessHost::close_session(int session) {
+    host.close_session(session);
+}
+
+Dictionary ChessHost::get_session_stats(int session) const {
+    Dictionary stats;
+    chess::SessionStats counters;
+    if (!host.get_session_stats(session, counters)) {
+        return stats;
+    }
+    stats["submitted"] = counters.submitted;
+    stats["completed"] = counters.completed;
+    stats["cancelled"] = counters.cancelled;
+    stats["rejected"] = counters.rejected;
+    stats["nodes"] = counters.nodes;
+    stats["busy_ms"] = counters.busy_ms;
+    stats["average_wait_ms"] = counters.average_wait_ms();
+    stats["max_wait_ms"] = counters.max_wait_ms;
+    return stats;
+}
+
+Dictionary ChessHost::get_stats() const {
+    Dictionary stats;
+    stats["workers"] = workers;
+    stats["sessions"] = host.session_count();
+    stats["queued"] = host.queued_requests();
+    stats["running"] = host.running_requests();
+    return stats;
+}
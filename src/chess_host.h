@@ -0,0 +1,78 @@
+#ifndef CHESS_HOST_H
+#define CHESS_HOST_H
+
+// Godot node base class and Dictionary type.
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+#include "neural_net.h"
+
+// Worker pool, sessions and scheduling come from the Godot-free core.
+#include "core/engine_host.h"
+
+#include <memory>
+
+namespace godot {
+
+// Search service for many concurrent games: one fixed pool of worker threads and one shared
+// network. ChessAgents attached with ChessAgent.set_host each get a session and queue their
+// searches here instead of searching on their own threads.
+class ChessHost : public Node {
+    GDCLASS(ChessHost, Node)
+
+private:
+    // Shared model, built like a ChessAgent's network; load or train it through get_neural_net().
+    NeuralNet *neural_net;
+    // Snapshot of neural_net's weights last handed to host.
+    std::shared_ptr<const chess::Network> published_network;
+
+    chess::EngineHost host;
+    int workers;
+    int hash_size;
+    bool started;
+
+    // Joins the pool; after it no worker reads the shared network.
+    void stop_pool();
+
+protected:
+    static void _bind_methods();
+    // Stops the pool on predelete, which reaches this class before Node frees the children.
+    void _notification(int p_what);
+
+public:
+    ChessHost();
+    ~ChessHost();
+
+    // Stops the pool before the shared network (a child) is freed; the next search restarts it.
+    void _exit_tree() override;
+
+    // Worker threads (default: one per hardware thread) and the table of each, in MB (default 16).
+    // Changing either restarts the pool; running searches stop with their best move so far.
+    void set_workers(int count);
+    int get_workers() const;
+    void set_hash_size(int megabytes);
+    int get_hash_size() const;
+
+    NeuralNet *get_neural_net();
+
+    // Sessions for scripts driving the host without an agent. Option keys: priority (1-100, the
+    // session's share of the workers when several are busy), max_nodes and max_time_ms (caps on
+    // every search), max_queued, skill_level and eval_mode ("network", "handcrafted", "hybrid").
+    // configure_session changes only the keys given; the others keep their current values.
+    int open_session(const Dictionary &options);
+    bool configure_session(int session, const Dictionary &options);
+    void close_session(int session);
+    // submitted, completed, cancelled, rejected, nodes, busy_ms, average_wait_ms, max_wait_ms.
+    Dictionary get_session_stats(int session) const;
+    // workers, sessions, queued and running requests.
+    Dictionary get_stats() const;
+
+    // The core host with the pool running and the current network snapshot set (C++ only; used
+    // by ChessAgent).
+    chess::EngineHost &get_engine_host();
+    static bool read_session_config(const Dictionary &options, chess::SessionConfig &config);
+};
+
+} // namespace godot
+
+#endif
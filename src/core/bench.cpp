@@ -0,0 +1,26 @@
+#include "bench.h"
+
+namespace chess {
+
+// Openings, middlegames and endgames. The perft favourites with dozens of pending captures
+// are left out: their quiescence trees dwarf everything else and drown the signature.
+const char *const BENCH_POSITIONS[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+	"rnbqkb1r/pp3ppp/4pn2/2pp4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 0 5",
+	"2rq1rk1/pp1bppbp/2np1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 8 12",
+	"r1bq1rk1/pp2nppp/2n1p3/3pP3/2pP4/P1P2N2/2P2PPP/R1BQKB1R w KQ - 1 9",
+	"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+	"8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+	"8/5pk1/6p1/7p/7P/6P1/5PK1/4R3 b - - 0 40",
+	"4r1k1/1q3ppp/p2p4/1p1P4/4Q3/1P5P/P4PP1/4R1K1 w - - 0 30",
+	"8/1p6/p1p5/2P1k3/1P6/P3K3/8/8 w - - 0 50",
+	"r2q1rk1/ppp2ppp/2n1bn2/2bpp3/4P3/2PP1N2/PP1NBPPP/R1BQ1RK1 w - - 0 8",
+};
+
+const int BENCH_POSITION_COUNT = sizeof(BENCH_POSITIONS) / sizeof(BENCH_POSITIONS[0]);
+
+} // namespace chess
@@ -0,0 +1,12 @@
+#ifndef CHESS_CORE_BENCH_H
+#define CHESS_CORE_BENCH_H
+
+namespace chess {
+
+// Fixed positions searched by "bench"; the total node count doubles as a search signature.
+extern const char *const BENCH_POSITIONS[];
+extern const int BENCH_POSITION_COUNT;
+
+} // namespace chess
+
+#endif
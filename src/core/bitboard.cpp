@@ -0,0 +1,81 @@
+#include "bitboard.h"
+
+namespace chess {
+
+Bitboard KNIGHT_ATTACKS[64];
+Bitboard KING_ATTACKS[64];
+Bitboard PAWN_ATTACKS[2][64];
+
+// Rays by direction; the first four increase the square index, the last four decrease it.
+static Bitboard RAYS[8][64];
+static const int RAY_DX[8] = { 1, -1, 0, 1, -1, 1, 0, -1 };
+static const int RAY_DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+static bool on_board(int x, int y) {
+	return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+static Bitboard offsets_bb(int x, int y, const int (*offsets)[2], int count) {
+	Bitboard b = 0;
+	for (int i = 0; i < count; i++) {
+		int tx = x + offsets[i][0];
+		int ty = y + offsets[i][1];
+		if (on_board(tx, ty)) {
+			b |= square_bb(make_square(tx, ty));
+		}
+	}
+	return b;
+}
+
+static void init_tables() {
+	static const int knight_offsets[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+	static const int king_offsets[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+	// White pawns move towards y = 0, black pawns towards y = 7.
+	static const int pawn_offsets[2][2][2] = { { { -1, -1 }, { 1, -1 } }, { { -1, 1 }, { 1, 1 } } };
+
+	for (int square = 0; square < 64; square++) {
+		int x = file_of(square);
+		int y = row_of(square);
+		KNIGHT_ATTACKS[square] = offsets_bb(x, y, knight_offsets, 8);
+		KING_ATTACKS[square] = offsets_bb(x, y, king_offsets, 8);
+		PAWN_ATTACKS[WHITE][square] = offsets_bb(x, y, pawn_offsets[WHITE], 2);
+		PAWN_ATTACKS[BLACK][square] = offsets_bb(x, y, pawn_offsets[BLACK], 2);
+
+		for (int dir = 0; dir < 8; dir++) {
+			Bitboard ray = 0;
+			for (int tx = x + RAY_DX[dir], ty = y + RAY_DY[dir]; on_board(tx, ty); tx += RAY_DX[dir], ty += RAY_DY[dir]) {
+				ray |= square_bb(make_square(tx, ty));
+			}
+			RAYS[dir][square] = ray;
+		}
+	}
+}
+
+static struct TableInitializer {
+	TableInitializer() { init_tables(); }
+} table_initializer;
+
+// Attacks along one ray, cut at (and including) the first blocker.
+static inline Bitboard ray_attacks(int dir, Square square, Bitboard occupied) {
+	Bitboard attacks = RAYS[dir][square];
+	Bitboard blockers = attacks & occupied;
+	if (blockers) {
+		Square blocker = dir < 4 ? lsb(blockers) : msb(blockers);
+		attacks ^= RAYS[dir][blocker];
+	}
+	return attacks;
+}
+
+// Directions 0 (east), 2 (south), 4 (west), 6 (north).
+Bitboard rook_attacks(Square square, Bitboard occupied) {
+	return ray_attacks(0, square, occupied) | ray_attacks(2, square, occupied) |
+			ray_attacks(4, square, occupied) | ray_attacks(6, square, occupied);
+}
+
+// Directions 1 (south-west), 3 (south-east), 5 (north-east), 7 (north-west).
+Bitboard bishop_attacks(Square square, Bitboard occupied) {
+	return ray_attacks(1, square, occupied) | ray_attacks(3, square, occupied) |
+			ray_attacks(5, square, occupied) | ray_attacks(7, square, occupied);
+}
+
+} // namespace chess
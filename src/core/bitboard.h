@@ -0,0 +1,23 @@
+#ifndef CHESS_CORE_BITBOARD_H
+#define CHESS_CORE_BITBOARD_H
+
+#include "types.h"
+
+namespace chess {
+
+// Precomputed leaper attacks, filled once at static initialisation.
+extern Bitboard KNIGHT_ATTACKS[64];
+extern Bitboard KING_ATTACKS[64];
+extern Bitboard PAWN_ATTACKS[2][64]; // Squares attacked by a pawn of [color] standing on [square].
+
+// Slider attacks for a given occupancy (classical ray scan, no lookup tables to build).
+Bitboard rook_attacks(Square square, Bitboard occupied);
+Bitboard bishop_attacks(Square square, Bitboard occupied);
+
+inline Bitboard queen_attacks(Square square, Bitboard occupied) {
+	return rook_attacks(square, occupied) | bishop_attacks(square, occupied);
+}
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef CHESS_CORE_BOOK_H
+#define CHESS_CORE_BOOK_H
+
+#include "mapped_file.h"
+#include "position.h"
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+// One 16-byte Polyglot record, big-endian on disk, sorted by key.
+struct BookEntry {
+	uint64_t key;
+	uint16_t move;   // to file, to row, from file, from row (3 bits each), promotion (3 bits)
+	uint16_t weight;
+	uint32_t learn;
+};
+
+// Polyglot hash of a position: piece-square, castling, en passant (only when a capture is
+// possible) and side-to-move keys from the standard Random64 table, XORed as in the Polyglot
+// layout, so books from other Polyglot tools can be probed and ours read by them.
+uint64_t book_key(const Position &pos);
+
+const uint64_t BOOK_START_KEY = 0x463B96181691FC9Cull;
+
+// Whether book_key reproduces the start position key and the format's other reference keys.
+// Books are neither opened nor written with a damaged table.
+bool book_keys_valid();
+
+uint16_t move_to_book(const Position &pos, Move move);
+Move move_from_book(Position &pos, uint16_t book_move); // MOVE_NONE unless legal
+
+// Read-only opening book, memory-mapped and binary-searched by key.
+class OpeningBook {
+private:
+	MappedFile file;
+	size_t entry_count;
+	std::mt19937_64 rng;
+	std::mutex rng_mutex;
+
+	BookEntry entry(size_t index) const;
+
+public:
+	OpeningBook();
+
+	bool open(const std::string &path);
+	void close();
+	bool is_open() const { return entry_count > 0; }
+	size_t size() const { return entry_count; }
+
+	// Legal book moves for pos with their weights, best first.
+	std::vector<std::pair<Move, int>> moves(Position &pos) const;
+
+	// A book move for pos, or MOVE_NONE: picked with probability proportional to its weight,
+	// or the heaviest one when weighted_random is false.
+	Move probe(Position &pos, bool weighted_random);
+
+	// Sort entries by key (heaviest move first) and write them as a Polyglot file.
+	static bool write(const std::string &path, std::vector<BookEntry> entries);
+};
+
+} // namespace chess
+
+#endif
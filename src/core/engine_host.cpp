@@ -0,0 +1,398 @@
+#include "engine_host.h"
+
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+// Service charged for a request whose limits give no better guess of its length.
+const int64_t DEFAULT_ESTIMATE_MS = 100;
+const int MAX_PRIORITY = 100;
+
+int64_t elapsed_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// No limit that ends the search by itself: only stop() (or a quota) would.
+bool unbounded(const SearchLimits &limits, int us) {
+	return limits.infinite || limits.ponder ||
+			(limits.depth <= 0 && limits.nodes <= 0 && limits.movetime <= 0 && limits.time[us] <= 0);
+}
+
+// Expected worker time of a request, charged to its session when it starts and corrected
+// once the real time is known.
+int64_t estimate_ms(const SearchLimits &limits, int us, const SessionConfig &config) {
+	int64_t estimate = DEFAULT_ESTIMATE_MS;
+	if (limits.movetime > 0) {
+		estimate = limits.movetime;
+	} else if (limits.time[us] > 0) {
+		estimate = limits.time[us] / std::max(limits.moves_to_go, 20) + limits.increment[us];
+	}
+	if (config.max_time_ms > 0) {
+		estimate = std::min(estimate, config.max_time_ms);
+	}
+	return std::max<int64_t>(estimate, 1);
+}
+
+SessionConfig clamp_config(const SessionConfig &config) {
+	SessionConfig clamped = config;
+	clamped.priority = std::max(1, std::min(config.priority, MAX_PRIORITY));
+	clamped.max_nodes = std::max<int64_t>(config.max_nodes, 0);
+	clamped.max_time_ms = std::max<int64_t>(config.max_time_ms, 0);
+	clamped.max_queued = std::max(config.max_queued, 1);
+	return clamped;
+}
+
+} // namespace
+
+EngineHost::EngineHost() :
+		hash_mb(16), next_session(1), next_request(1), queued(0), virtual_time(0.0), stopping(false) {}
+
+EngineHost::~EngineHost() {
+	shutdown();
+}
+
+void EngineHost::set_workers(int count, size_t megabytes_per_worker) {
+	shutdown();
+	std::lock_guard<std::mutex> lock(mutex);
+	slots.clear();
+	hash_mb = std::max<size_t>(megabytes_per_worker, 1);
+	stopping = false;
+	for (int i = 0; i < std::max(count, 1); i++) {
+		std::unique_ptr<Slot> slot(new Slot());
+		slot->search.set_threads(1);
+		slot->search.set_hash_size(hash_mb);
+		slots.push_back(std::move(slot));
+	}
+	for (int i = 0; i < (int)slots.size(); i++) {
+		slots[i]->thread = std::thread([this, i]() { worker_loop(i); });
+	}
+}
+
+int EngineHost::get_workers() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return (int)slots.size();
+}
+
+void EngineHost::set_network(std::shared_ptr<const Network> shared_network) {
+	std::lock_guard<std::mutex> lock(mutex);
+	network = std::move(shared_network);
+}
+
+// Running searches are stopped; their pool threads deliver the results before leaving.
+void EngineHost::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		for (auto &slot : slots) {
+			if (slot->current) {
+				slot->search.stop();
+			}
+		}
+	}
+	work_ready.notify_all();
+	for (auto &slot : slots) {
+		if (slot->thread.joinable()) {
+			slot->thread.join();
+		}
+	}
+}
+
+int EngineHost::open_session(const SessionConfig &config) {
+	std::lock_guard<std::mutex> lock(mutex);
+	int id = next_session++;
+	Session &session = sessions[id];
+	session.config = clamp_config(config);
+	session.pass = virtual_time;
+	return id;
+}
+
+bool EngineHost::configure_session(int session, const SessionConfig &config) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(session);
+	if (it == sessions.end()) {
+		return false;
+	}
+	it->second.config = clamp_config(config);
+	return true;
+}
+
+void EngineHost::close_session(int session) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(session);
+	if (it == sessions.end()) {
+		return;
+	}
+	queued -= (int64_t)it->second.queue.size();
+	for (auto request = requests.begin(); request != requests.end();) {
+		Request &entry = *request->second;
+		if (entry.session != session) {
+			++request;
+			continue;
+		}
+		if (entry.state == REQUEST_RUNNING) {
+			// The pool thread forgets it once the search has stopped.
+			entry.cancelled = true;
+			slots[entry.slot]->search.stop();
+			++request;
+		} else {
+			request = requests.erase(request);
+		}
+	}
+	sessions.erase(it);
+	result_ready.notify_all();
+}
+
+bool EngineHost::get_session_config(int session, SessionConfig &config) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(session);
+	if (it == sessions.end()) {
+		return false;
+	}
+	config = it->second.config;
+	return true;
+}
+
+bool EngineHost::get_session_stats(int session, SessionStats &stats) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(session);
+	if (it == sessions.end()) {
+		return false;
+	}
+	stats = it->second.stats;
+	return true;
+}
+
+int EngineHost::session_count() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return (int)sessions.size();
+}
+
+uint64_t EngineHost::submit(int session, const Position &position, const SearchLimits &limits,
+		const ResultCallback &on_result) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(session);
+	if (it == sessions.end()) {
+		return 0;
+	}
+	Session &owner = it->second;
+	bool has_quota = owner.config.max_nodes > 0 || owner.config.max_time_ms > 0;
+	if ((int)owner.queue.size() >= owner.config.max_queued ||
+			(unbounded(limits, position.side_to_move()) && !has_quota)) {
+		owner.stats.rejected++;
+		return 0;
+	}
+
+	// A session that sat idle rejoins at the current virtual time instead of cashing in
+	// the service it did not ask for.
+	if (owner.queue.empty() && owner.running == 0) {
+		owner.pass = std::max(owner.pass, virtual_time);
+	}
+
+	std::shared_ptr<Request> request = std::make_shared<Request>();
+	request->id = next_request++;
+	request->session = session;
+	request->position = position;
+	request->limits = limits;
+	request->on_result = on_result;
+	request->submitted = std::chrono::steady_clock::now();
+	requests[request->id] = request;
+	owner.queue.push_back(request);
+	owner.stats.submitted++;
+	queued++;
+	work_ready.notify_one();
+	return request->id;
+}
+
+bool EngineHost::cancel(uint64_t id) {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto it = requests.find(id);
+	if (it == requests.end() || it->second->state == REQUEST_DONE) {
+		return false;
+	}
+	std::shared_ptr<Request> request = it->second;
+	request->cancelled = true;
+	if (request->state == REQUEST_RUNNING) {
+		slots[request->slot]->search.stop();
+		return true;
+	}
+
+	Session &owner = sessions[request->session];
+	owner.queue.erase(std::find(owner.queue.begin(), owner.queue.end(), request));
+	owner.stats.cancelled++;
+	queued--;
+	request->state = REQUEST_DONE;
+	if (request->on_result) {
+		requests.erase(it);
+		lock.unlock();
+		request->on_result(request->id, request->result);
+		return true;
+	}
+	result_ready.notify_all();
+	return true;
+}
+
+RequestState EngineHost::poll(uint64_t id, SearchResult *result) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = requests.find(id);
+	if (it == requests.end()) {
+		return REQUEST_UNKNOWN;
+	}
+	RequestState state = it->second->state;
+	if (state == REQUEST_DONE && result != nullptr) {
+		*result = std::move(it->second->result);
+		requests.erase(it);
+	}
+	return state;
+}
+
+bool EngineHost::wait(uint64_t id, SearchResult &result) {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto it = requests.end();
+	result_ready.wait(lock, [&]() {
+		it = requests.find(id);
+		return it == requests.end() || it->second->state == REQUEST_DONE;
+	});
+	if (it == requests.end()) {
+		return false;
+	}
+	result = std::move(it->second->result);
+	requests.erase(it);
+	return true;
+}
+
+int64_t EngineHost::queued_requests() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return queued;
+}
+
+int EngineHost::running_requests() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	int running = 0;
+	for (const auto &slot : slots) {
+		running += slot->current ? 1 : 0;
+	}
+	return running;
+}
+
+// Stride scheduling: the busy session with the smallest pass goes next (the lowest id on ties),
+// and pays for the request up front so concurrent workers do not all pick the same session.
+std::shared_ptr<EngineHost::Request> EngineHost::pick_request() {
+	Session *chosen = nullptr;
+	for (auto &item : sessions) {
+		Session &session = item.second;
+		if (!session.queue.empty() && (chosen == nullptr || session.pass < chosen->pass)) {
+			chosen = &session;
+		}
+	}
+	if (chosen == nullptr) {
+		return std::shared_ptr<Request>();
+	}
+
+	std::shared_ptr<Request> request = chosen->queue.front();
+	chosen->queue.pop_front();
+	queued--;
+	virtual_time = chosen->pass;
+	request->charged = (double)estimate_ms(request->limits, request->position.side_to_move(), chosen->config);
+	chosen->pass += request->charged / chosen->config.priority;
+	chosen->running++;
+
+	int64_t waited = elapsed_since(request->submitted);
+	chosen->stats.wait_ms += waited;
+	chosen->stats.max_wait_ms = std::max(chosen->stats.max_wait_ms, waited);
+	request->state = REQUEST_RUNNING;
+	return request;
+}
+
+void EngineHost::worker_loop(int index) {
+	Slot &slot = *slots[index];
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		work_ready.wait(lock, [this]() { return stopping || queued > 0; });
+		if (stopping) {
+			return;
+		}
+		std::shared_ptr<Request> request = pick_request();
+		if (!request) {
+			continue;
+		}
+		request->slot = index;
+		SessionConfig config = sessions[request->session].config;
+		slot.current = request;
+
+		auto start_time = std::chrono::steady_clock::now();
+		run_request(slot, *request, config, lock);
+		slot.current.reset();
+		finish_request(request, elapsed_since(start_time), lock);
+	}
+}
+
+// Searches on the pool thread. The session's time quota is a hard limit of the search itself;
+// cancel, close_session and shutdown stop it from outside. Called and returns with the lock held.
+void EngineHost::run_request(Slot &slot, Request &request, const SessionConfig &config,
+		std::unique_lock<std::mutex> &lock) {
+	int us = request.position.side_to_move();
+	SearchLimits limits = request.limits;
+	limits.ponder = false;
+	if (config.max_nodes > 0 && (limits.nodes <= 0 || limits.nodes > config.max_nodes)) {
+		limits.nodes = config.max_nodes;
+	}
+	if (config.max_time_ms > 0) {
+		limits.max_time = limits.max_time > 0 ? std::min(limits.max_time, config.max_time_ms) : config.max_time_ms;
+	}
+	if (limits.infinite && (config.max_nodes > 0 || config.max_time_ms > 0)) {
+		limits.infinite = false; // The quota ends it instead.
+	}
+	// The clock kept running while the request waited.
+	if (limits.time[us] > 0) {
+		limits.time[us] = std::max<int64_t>(limits.time[us] - elapsed_since(request.submitted), 1);
+	}
+
+	slot.search.set_skill_level(config.skill_level);
+	slot.search.set_eval_mode(config.eval_mode);
+	std::shared_ptr<const Network> weights = network;
+	slot.search.set_network(weights.get());
+	lock.unlock();
+	// run() clears the stop flag when it starts, so a stop() that came just before is repeated
+	// from the first completed iteration.
+	SearchResult result = slot.search.run(request.position, limits, [this, &slot, &request](const SearchInfo &) {
+		if (request.cancelled || stopping) {
+			slot.search.stop();
+		}
+	});
+	lock.lock();
+	request.result = std::move(result);
+}
+
+// Settles the session's account and hands the result over. Called and returns with the lock held.
+void EngineHost::finish_request(const std::shared_ptr<Request> &request, int64_t busy_ms,
+		std::unique_lock<std::mutex> &lock) {
+	request->state = REQUEST_DONE;
+	auto it = sessions.find(request->session);
+	bool closed = it == sessions.end();
+	if (!closed) {
+		Session &owner = it->second;
+		owner.running--;
+		owner.pass += ((double)busy_ms - request->charged) / owner.config.priority;
+		owner.stats.busy_ms += busy_ms;
+		owner.stats.nodes += request->result.nodes;
+		if (request->cancelled) {
+			owner.stats.cancelled++;
+		} else {
+			owner.stats.completed++;
+		}
+	}
+
+	if (closed || request->on_result) {
+		requests.erase(request->id);
+	}
+	if (request->on_result && !closed) {
+		lock.unlock();
+		request->on_result(request->id, request->result);
+		lock.lock();
+	}
+	result_ready.notify_all();
+}
+
+} // namespace chess
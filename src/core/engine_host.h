@@ -0,0 +1,158 @@
+#ifndef CHESS_CORE_ENGINE_HOST_H
+#define CHESS_CORE_ENGINE_HOST_H
+
+#include "evaluate.h"
+#include "network.h"
+#include "position.h"
+#include "search.h"
+#include "skill.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace chess {
+
+// How one session (one game) may use the host.
+struct SessionConfig {
+	int priority = 1;               // Share of the workers against other busy sessions (1-100).
+	int64_t max_nodes = 0;          // Node cap of every request (0: the request's own limits).
+	int64_t max_time_ms = 0;        // Wall-clock cap of every request, counted from its start (0: none).
+	int max_queued = 4;             // Requests waiting at once; further submits are rejected.
+	int skill_level = SkillLevel::MAX_LEVEL;
+	EvalMode eval_mode = EVAL_NETWORK;
+};
+
+struct SessionStats {
+	int64_t submitted = 0;
+	int64_t completed = 0;
+	int64_t cancelled = 0;
+	int64_t rejected = 0;           // Submits refused by a full queue or an unbounded limit.
+	int64_t nodes = 0;
+	int64_t busy_ms = 0;            // Worker time spent on the session's searches.
+	int64_t wait_ms = 0;            // Queue time summed over its requests...
+	int64_t max_wait_ms = 0;        // ...and the longest single wait.
+
+	double average_wait_ms() const { return completed + cancelled > 0 ? (double)wait_ms / (completed + cancelled) : 0.0; }
+};
+
+enum RequestState {
+	REQUEST_UNKNOWN,                // Never submitted, rejected, or its result was already taken.
+	REQUEST_QUEUED,
+	REQUEST_RUNNING,
+	REQUEST_DONE                    // Finished or cancelled; the result is ready to take.
+};
+
+// Serves searches for many concurrent games from one fixed pool of workers, each a single-threaded
+// Search with its own table, all evaluating with one shared read-only network snapshot. Requests queue per
+// session; a free worker takes the oldest request of the busy session with the least weighted
+// service (stride scheduling), so each session's share of the workers follows its priority and
+// no session starves however many requests the others queue. Sessions' quotas cap every request,
+// and time spent waiting in the queue is taken off the mover's clock.
+class EngineHost {
+public:
+	typedef std::function<void(uint64_t request, const SearchResult &result)> ResultCallback;
+
+private:
+	struct Request {
+		uint64_t id = 0;
+		int session = 0;
+		Position position;
+		SearchLimits limits;
+		ResultCallback on_result;
+		RequestState state = REQUEST_QUEUED;
+		std::atomic<bool> cancelled{ false };  // Also read by the search between iterations.
+		int slot = -1;
+		double charged = 0.0;         // Service charged to the session when it started.
+		std::chrono::steady_clock::time_point submitted;
+		SearchResult result;
+	};
+
+	struct Session {
+		SessionConfig config;
+		SessionStats stats;
+		std::deque<std::shared_ptr<Request>> queue;
+		double pass = 0.0;            // Weighted service received so far, in ms / priority.
+		int running = 0;
+	};
+
+	// One pool thread and the single-threaded Search it runs its requests on.
+	struct Slot {
+		Search search;
+		std::thread thread;
+		std::shared_ptr<Request> current;
+	};
+
+	mutable std::mutex mutex;
+	std::condition_variable work_ready;
+	std::condition_variable result_ready;
+	std::vector<std::unique_ptr<Slot>> slots;
+	std::map<int, Session> sessions;
+	std::unordered_map<uint64_t, std::shared_ptr<Request>> requests;
+	std::shared_ptr<const Network> network;
+	size_t hash_mb;
+	int next_session;
+	uint64_t next_request;
+	int64_t queued;
+	double virtual_time;              // Pass of the session served last; idle sessions rejoin here.
+	std::atomic<bool> stopping;
+
+	std::shared_ptr<Request> pick_request();
+	void worker_loop(int index);
+	void run_request(Slot &slot, Request &request, const SessionConfig &config, std::unique_lock<std::mutex> &lock);
+	void finish_request(const std::shared_ptr<Request> &request, int64_t busy_ms, std::unique_lock<std::mutex> &lock);
+
+public:
+	EngineHost();
+	~EngineHost();
+
+	// Pool size and the table of each worker. Running searches are stopped (their results are
+	// still delivered); queued requests wait for the new workers.
+	void set_workers(int count, size_t megabytes_per_worker = 16);
+	int get_workers() const;
+	// Stop the pool until the next set_workers; results of stopped searches are still delivered.
+	void shutdown();
+	// The shared model, never modified while held here (replace it with a new snapshot instead);
+	// nullptr evaluates with the handcrafted evaluation. Each request searches with the snapshot
+	// current when it starts, kept alive until it finishes.
+	void set_network(std::shared_ptr<const Network> shared_network);
+
+	// Sessions: close_session cancels everything the session still has queued or running and
+	// drops its untaken results.
+	int open_session(const SessionConfig &config);
+	bool configure_session(int session, const SessionConfig &config);
+	void close_session(int session);
+	bool get_session_config(int session, SessionConfig &config) const;
+	bool get_session_stats(int session, SessionStats &stats) const;
+	int session_count() const;
+
+	// Queue a search; returns its id, or 0 when the session is unknown, its queue is full, or
+	// the limits are unbounded (infinite or ponder) with no quota to end them. on_result, if
+	// given, runs on a pool thread and the result is not kept for poll/wait.
+	uint64_t submit(int session, const Position &position, const SearchLimits &limits,
+			const ResultCallback &on_result = ResultCallback());
+
+	// A queued request is dropped; a running one is stopped and returns its best move so far.
+	bool cancel(uint64_t request);
+
+	// State of a request; once REQUEST_DONE, poll copies the result out and forgets the request.
+	RequestState poll(uint64_t request, SearchResult *result);
+	// Block until the request is done and take its result; false for an unknown request.
+	bool wait(uint64_t request, SearchResult &result);
+
+	int64_t queued_requests() const;
+	int running_requests() const;
+};
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,55 @@
+#include "eval_cache.h"
+
+#include <cstring>
+
+namespace chess {
+
+EvalCache::EvalCache() {
+	entry_count = 0;
+	network_revision = 0;
+	resize(4);
+}
+
+void EvalCache::resize(size_t megabytes) {
+	size_t count = (megabytes * 1024 * 1024) / sizeof(Entry);
+	entry_count = count > 0 ? count : 1;
+	entries.resize(entry_count);
+	clear();
+}
+
+void EvalCache::clear() {
+	for (size_t i = 0; i < entry_count; i++) {
+		entries[i].check.store(0, std::memory_order_relaxed);
+		entries[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+void EvalCache::set_network_revision(uint64_t revision) {
+	if (revision != network_revision) {
+		network_revision = revision;
+		clear();
+	}
+}
+
+bool EvalCache::probe(uint64_t key, float &output) const {
+	Entry &entry = entries[mul_hi64(key, entry_count)];
+	uint64_t data = entry.data.load(std::memory_order_relaxed);
+	if ((data & VALID_BIT) == 0 || (entry.check.load(std::memory_order_relaxed) ^ data) != key) {
+		return false;
+	}
+	uint32_t bits = (uint32_t)data;
+	std::memcpy(&output, &bits, sizeof(float));
+	return true;
+}
+
+// Always replaces: a leaf evaluation is equally cheap to lose whichever it is.
+void EvalCache::store(uint64_t key, float output) {
+	uint32_t bits;
+	std::memcpy(&bits, &output, sizeof(float));
+	uint64_t data = VALID_BIT | bits;
+	Entry &entry = entries[mul_hi64(key, entry_count)];
+	entry.check.store(key ^ data, std::memory_order_relaxed);
+	entry.data.store(data, std::memory_order_relaxed);
+}
+
+} // namespace chess
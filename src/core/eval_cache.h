@@ -0,0 +1,44 @@
+#ifndef CHESS_CORE_EVAL_CACHE_H
+#define CHESS_CORE_EVAL_CACHE_H
+
+#include "large_pages.h"
+#include "types.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace chess {
+
+// Direct-mapped cache of network outputs by position key, shared by all search threads.
+// Same lock-free scheme as the transposition table: a torn write fails the key check.
+class EvalCache {
+private:
+	struct Entry {
+		std::atomic<uint64_t> check; // key ^ data
+		std::atomic<uint64_t> data;  // VALID_BIT | float bits of the output
+	};
+
+	static const uint64_t VALID_BIT = 1ull << 32;
+
+	LargeArray<Entry> entries;
+	size_t entry_count;
+	uint64_t network_revision; // Network::revision() the cached outputs came from.
+
+public:
+	EvalCache();
+
+	void resize(size_t megabytes);
+	size_t size_mb() const { return entry_count * sizeof(Entry) / (1024 * 1024); }
+	PageKind page_kind() const { return entries.page_kind(); }
+	void clear();
+
+	// Outputs depend on the weights: drop everything when a different network is used.
+	void set_network_revision(uint64_t revision);
+
+	bool probe(uint64_t key, float &output) const;
+	void store(uint64_t key, float output);
+};
+
+} // namespace chess
+
+#endif
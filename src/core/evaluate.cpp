@@ -0,0 +1,72 @@
+#include "evaluate.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace chess {
+
+void encode_position(const Position &pos, float *inputs) {
+	std::fill(inputs, inputs + NETWORK_INPUTS, 0.0f);
+	Bitboard occupied = pos.occupied();
+	while (occupied) {
+		Square square = pop_lsb(occupied);
+		inputs[feature_index(pos.piece_on(square), square)] = 1.0f;
+	}
+}
+
+int output_to_score(float output) {
+	double p = std::min(std::max((double)output, 0.001), 0.999);
+	return (int)std::lround(400.0 * std::log10(p / (1.0 - p)));
+}
+
+Evaluator::Evaluator(const Network *network) {
+	set_network(network);
+}
+
+void Evaluator::set_network(const Network *new_network) {
+	network = new_network;
+	trunk_key = 0;
+	trunk_revision = 0;
+	inputs.assign(NETWORK_INPUTS, 0.0f);
+	active_features.clear();
+	if (network != nullptr) {
+		network->init_workspace(workspace);
+	}
+}
+
+void Evaluator::forward(const Position &pos) {
+	for (int index : active_features) {
+		inputs[index] = 0.0f;
+	}
+	active_features.clear();
+
+	Bitboard occupied = pos.occupied();
+	while (occupied) {
+		Square square = pop_lsb(occupied);
+		int index = feature_index(pos.piece_on(square), square);
+		inputs[index] = 1.0f;
+		active_features.push_back(index);
+	}
+
+	network->forward(inputs.data(), workspace);
+	trunk_key = pos.key();
+	trunk_revision = network->revision();
+}
+
+float Evaluator::output(const Position &pos) {
+	forward(pos);
+	return workspace.activations.back()[0];
+}
+
+void Evaluator::policy(const Position &pos, const Move *moves, int count, float *probabilities) {
+	if (trunk_key != pos.key() || trunk_revision != network->revision()) {
+		forward(pos);
+	}
+	const float *trunk = network->trunk(workspace);
+	for (int i = 0; i < count; i++) {
+		probabilities[i] = network->policy_logit(trunk, policy_index(moves[i]));
+	}
+	softmax(probabilities, count);
+}
+
+} // namespace chess
@@ -0,0 +1,96 @@
+#ifndef CHESS_CORE_EVALUATE_H
+#define CHESS_CORE_EVALUATE_H
+
+#include "hce.h"
+#include "network.h"
+#include "position.h"
+
+#include <vector>
+
+namespace chess {
+
+// 64 squares * 12 piece channels, the input layout ChessAgent has always used.
+const int NETWORK_INPUTS = 768;
+
+// Network channel order is P, N, B, R, Q, K (black offset by 6); PieceType order is P, R, N, B, Q, K.
+inline int network_channel(Piece piece) {
+	static const int type_map[6] = { 0, 3, 1, 2, 4, 5 };
+	return type_map[type_of(piece)] + color_of(piece) * 6;
+}
+
+inline int feature_index(Piece piece, Square square) {
+	return square * 12 + network_channel(piece);
+}
+
+// Policy head layout: one logit per from-to square pair. Promotions share the pawn move's
+// logit; the board encoding is not mirrored, so squares are absolute.
+const int POLICY_OUTPUTS = 64 * 64;
+
+inline int policy_index(Move move) {
+	return move_from(move) * 64 + move_to(move);
+}
+
+// Write the one-hot features of pos into inputs (NETWORK_INPUTS floats, cleared first).
+void encode_position(const Position &pos, float *inputs);
+
+// Logistic mapping of a [0, 1] network output to a centipawn-like score.
+int output_to_score(float output);
+
+// Which evaluator scores positions. The handcrafted one also stands in whenever no network is set.
+// EVAL_HYBRID (search only) runs the network only where the handcrafted score is near the window.
+enum EvalMode {
+	EVAL_NETWORK,
+	EVAL_HANDCRAFTED,
+	EVAL_HYBRID
+};
+
+// Scores positions with a shared Network or the handcrafted evaluation; owns the per-thread
+// input and workspace buffers and the pawn hash table.
+class Evaluator {
+private:
+	const Network *network;
+	Network::Workspace workspace;
+	std::vector<float> inputs;
+	std::vector<int> active_features; // Set in inputs by the previous call, cleared lazily.
+	PawnTable pawn_table;
+
+	// Position and weights the workspace's trunk was computed for, so policy() can reuse it.
+	uint64_t trunk_key;
+	uint64_t trunk_revision;
+
+	void forward(const Position &pos);
+
+public:
+	explicit Evaluator(const Network *network = nullptr);
+
+	void set_network(const Network *network);
+
+	bool has_network() const { return network != nullptr && network->input_size() == NETWORK_INPUTS; }
+
+	bool has_policy() const { return has_network() && network->policy_size() == POLICY_OUTPUTS; }
+
+	// Raw network output for pos; has_network() must hold.
+	float output(const Position &pos);
+
+	// Softmax of the policy logits of moves in pos into probabilities; has_policy() must hold.
+	// Reuses the forward pass of an output() call for the same position, so a node that was
+	// just evaluated pays only for the logits.
+	void policy(const Position &pos, const Move *moves, int count, float *probabilities);
+
+	// Score from the side to move's point of view. The network rates a board for the side
+	// that just moved (as ChessAgent::select_best_move uses it), hence the negation.
+	static int output_to_eval(float output) { return -output_to_score(output); }
+
+	// Material, piece-square tables and pawn structure, from the side to move's point of view.
+	int handcrafted(const Position &pos) { return evaluate_handcrafted(pos, pawn_table); }
+
+	int evaluate(const Position &pos, EvalMode mode = EVAL_NETWORK) {
+		return mode == EVAL_NETWORK && has_network() ? output_to_eval(output(pos)) : handcrafted(pos);
+	}
+
+	void clear_pawn_table() { pawn_table.clear(); }
+};
+
+} // namespace chess
+
+#endif
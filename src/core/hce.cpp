@@ -0,0 +1,126 @@
+#include "hce.h"
+
+namespace chess {
+
+static const PhaseScore DOUBLED_PAWN(-10, -20);   // Per pawn beyond the first on a file.
+static const PhaseScore ISOLATED_PAWN(-10, -15);
+static const PhaseScore BISHOP_PAIR(30, 50);
+
+// Passed pawn bonus by rank counted from the pawn's own side (1 = second rank).
+static const PhaseScore PASSED_PAWN[8] = {
+	PhaseScore(0, 0), PhaseScore(5, 10), PhaseScore(10, 20), PhaseScore(20, 35),
+	PhaseScore(35, 60), PhaseScore(60, 100), PhaseScore(100, 150), PhaseScore(0, 0)
+};
+
+static Bitboard FILE_MASKS[8];
+static Bitboard ADJACENT_FILES[8];
+static Bitboard PASSED_MASKS[2][64]; // Squares ahead of a pawn on its own and neighbouring files.
+
+static void init_masks() {
+	for (int file = 0; file < 8; file++) {
+		FILE_MASKS[file] = 0;
+		for (int row = 0; row < 8; row++) {
+			FILE_MASKS[file] |= square_bb(make_square(file, row));
+		}
+	}
+	for (int file = 0; file < 8; file++) {
+		ADJACENT_FILES[file] = (file > 0 ? FILE_MASKS[file - 1] : 0) | (file < 7 ? FILE_MASKS[file + 1] : 0);
+	}
+	for (int square = 0; square < 64; square++) {
+		Bitboard files = FILE_MASKS[file_of(square)] | ADJACENT_FILES[file_of(square)];
+		Bitboard white_ahead = 0;
+		Bitboard black_ahead = 0;
+		// White pawns advance towards row 0, black pawns towards row 7.
+		for (int row = 0; row < 8; row++) {
+			Bitboard rank = (Bitboard)0xFF << (8 * row);
+			if (row < row_of(square)) {
+				white_ahead |= rank;
+			} else if (row > row_of(square)) {
+				black_ahead |= rank;
+			}
+		}
+		PASSED_MASKS[WHITE][square] = files & white_ahead;
+		PASSED_MASKS[BLACK][square] = files & black_ahead;
+	}
+}
+
+static struct MaskInitializer {
+	MaskInitializer() { init_masks(); }
+} mask_initializer;
+
+PawnTable::PawnTable(size_t entry_count) {
+	size_t count = 1;
+	while (count < entry_count) {
+		count <<= 1;
+	}
+	entries.resize(count);
+	clear();
+}
+
+// Key 0 is the pawnless position, whose score really is zero.
+void PawnTable::clear() {
+	for (Entry &entry : entries) {
+		entry.key = 0;
+		entry.score = PhaseScore();
+	}
+}
+
+PhaseScore PawnTable::probe(const Position &pos) {
+	Entry &entry = entries[pos.pawn_key() & (entries.size() - 1)];
+	if (entry.key != pos.pawn_key()) {
+		entry.key = pos.pawn_key();
+		entry.score = evaluate_pawns(pos);
+	}
+	return entry.score;
+}
+
+PhaseScore evaluate_pawns(const Position &pos) {
+	PhaseScore total;
+	for (int color = WHITE; color <= BLACK; color++) {
+		PhaseScore score;
+		Bitboard ours = pos.pieces(color, PAWN);
+		Bitboard theirs = pos.pieces(1 - color, PAWN);
+
+		for (int file = 0; file < 8; file++) {
+			int count = popcount(ours & FILE_MASKS[file]);
+			if (count > 1) {
+				score += DOUBLED_PAWN * (count - 1);
+			}
+		}
+
+		Bitboard pawns = ours;
+		while (pawns) {
+			Square square = pop_lsb(pawns);
+			if ((ours & ADJACENT_FILES[file_of(square)]) == 0) {
+				score += ISOLATED_PAWN;
+			}
+			// A pawn with another of ours in front only counts once, for the front one.
+			Bitboard ahead = PASSED_MASKS[color][square];
+			if ((theirs & ahead) == 0 && (ours & ahead & FILE_MASKS[file_of(square)]) == 0) {
+				int relative_rank = color == WHITE ? 7 - row_of(square) : row_of(square);
+				score += PASSED_PAWN[relative_rank];
+			}
+		}
+
+		if (color == WHITE) {
+			total += score;
+		} else {
+			total -= score;
+		}
+	}
+	return total;
+}
+
+int evaluate_handcrafted(const Position &pos, PawnTable &pawns) {
+	PhaseScore score = pos.psq() + pawns.probe(pos);
+	if (popcount(pos.pieces(WHITE, BISHOP)) >= 2) {
+		score += BISHOP_PAIR;
+	}
+	if (popcount(pos.pieces(BLACK, BISHOP)) >= 2) {
+		score -= BISHOP_PAIR;
+	}
+	int value = taper(score, pos.game_phase());
+	return pos.side_to_move() == WHITE ? value : -value;
+}
+
+} // namespace chess
@@ -0,0 +1,43 @@
+#ifndef CHESS_CORE_HCE_H
+#define CHESS_CORE_HCE_H
+
+#include "large_pages.h"
+#include "position.h"
+#include "psqt.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace chess {
+
+// Pawn-structure scores by pawn key. Each evaluator owns one, so entries need no atomics.
+class PawnTable {
+private:
+	struct Entry {
+		uint64_t key;
+		PhaseScore score;
+	};
+
+	std::vector<Entry, LargePageAllocator<Entry>> entries;
+
+public:
+	static const size_t DEFAULT_ENTRIES = 1 << 14;
+
+	explicit PawnTable(size_t entry_count = DEFAULT_ENTRIES);
+
+	void clear();
+
+	// Pawn-structure score of pos (White positive), computed and stored on a miss.
+	PhaseScore probe(const Position &pos);
+};
+
+// Doubled, isolated and passed pawns, White positive.
+PhaseScore evaluate_pawns(const Position &pos);
+
+// Handcrafted evaluation from the side to move's point of view: the position's incremental
+// material and piece-square score plus pawn structure and the bishop pair, tapered by phase.
+int evaluate_handcrafted(const Position &pos, PawnTable &pawns);
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,226 @@
+#include "large_pages.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace chess {
+
+namespace {
+
+std::atomic<bool> large_pages_on(true);
+std::atomic<bool> numa_binding_on(true);
+
+size_t round_up(size_t bytes, size_t unit) {
+	return (bytes + unit - 1) / unit * unit;
+}
+
+} // namespace
+
+void set_large_pages_enabled(bool enabled) {
+	large_pages_on = enabled;
+}
+
+bool large_pages_enabled() {
+	return large_pages_on.load();
+}
+
+void set_numa_binding_enabled(bool enabled) {
+	numa_binding_on = enabled;
+}
+
+const char *page_kind_name(PageKind kind) {
+	switch (kind) {
+		case PAGES_LARGE: return "large pages";
+		case PAGES_TRANSPARENT: return "transparent huge pages";
+		default: return "normal pages";
+	}
+}
+
+#if defined(_WIN32)
+
+// MEM_LARGE_PAGES fails without the SeLockMemoryPrivilege right, in which case normal pages are used.
+void *allocate_large(size_t bytes, PageKind &kind) {
+	bytes = std::max<size_t>(bytes, 1);
+	size_t large_minimum = GetLargePageMinimum();
+	if (large_pages_enabled() && large_minimum > 0) {
+		void *memory = VirtualAlloc(nullptr, round_up(bytes, large_minimum),
+				MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (memory != nullptr) {
+			kind = PAGES_LARGE;
+			return memory;
+		}
+	}
+	kind = PAGES_NORMAL;
+	return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void free_large(void *memory, size_t) {
+	if (memory != nullptr) {
+		VirtualFree(memory, 0, MEM_RELEASE);
+	}
+}
+
+#elif defined(__linux__)
+
+// Anonymous mappings come zeroed. Transparent huge pages need a 2 MB aligned range, so a larger
+// range is mapped and trimmed to the aligned part.
+void *allocate_large(size_t bytes, PageKind &kind) {
+	size_t size = round_up(std::max<size_t>(bytes, 1), LARGE_PAGE_SIZE);
+#if defined(MAP_HUGETLB)
+	if (large_pages_enabled()) {
+		void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED) {
+			kind = PAGES_LARGE;
+			return memory;
+		}
+	}
+#endif
+	void *mapped = mmap(nullptr, size + LARGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapped == MAP_FAILED) {
+		return nullptr;
+	}
+	char *begin = (char *)mapped;
+	char *aligned = (char *)round_up((size_t)begin, LARGE_PAGE_SIZE);
+	if (aligned > begin) {
+		munmap(begin, aligned - begin);
+	}
+	munmap(aligned + size, begin + size + LARGE_PAGE_SIZE - aligned - size);
+
+	kind = PAGES_NORMAL;
+#if defined(MADV_HUGEPAGE)
+	if (large_pages_enabled() && madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+		kind = PAGES_TRANSPARENT;
+	}
+#endif
+	return aligned;
+}
+
+void free_large(void *memory, size_t bytes) {
+	if (memory != nullptr) {
+		munmap(memory, round_up(std::max<size_t>(bytes, 1), LARGE_PAGE_SIZE));
+	}
+}
+
+#else
+
+void *allocate_large(size_t bytes, PageKind &kind) {
+	kind = PAGES_NORMAL;
+	void *memory = nullptr;
+	size_t size = round_up(std::max<size_t>(bytes, 1), LARGE_PAGE_SIZE);
+	if (posix_memalign(&memory, LARGE_PAGE_SIZE, size) != 0) {
+		return nullptr;
+	}
+	std::memset(memory, 0, size);
+	return memory;
+}
+
+void free_large(void *memory, size_t) {
+	std::free(memory);
+}
+
+#endif
+
+#if defined(__linux__)
+
+namespace {
+
+// CPU lists of the NUMA nodes ("0-7,16-23" in /sys), restricted to the CPUs this process may use.
+std::vector<std::vector<int>> read_numa_nodes() {
+	std::vector<std::vector<int>> nodes;
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		return nodes;
+	}
+	for (int node = 0; node < 1024; node++) {
+		std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+		std::FILE *file = std::fopen(path.c_str(), "r");
+		if (file == nullptr) {
+			if (node > 0 || !nodes.empty()) {
+				break;
+			}
+			continue;
+		}
+		char line[4096] = {};
+		bool read = std::fgets(line, sizeof(line), file) != nullptr;
+		std::fclose(file);
+
+		std::vector<int> cpus;
+		for (char *range = read ? std::strtok(line, ",\n") : nullptr; range != nullptr; range = std::strtok(nullptr, ",\n")) {
+			int first = 0;
+			int last = 0;
+			int fields = std::sscanf(range, "%d-%d", &first, &last);
+			if (fields < 1) {
+				continue;
+			}
+			last = fields == 2 ? last : first;
+			for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+				if (CPU_ISSET(cpu, &allowed)) {
+					cpus.push_back(cpu);
+				}
+			}
+		}
+		if (!cpus.empty()) {
+			nodes.push_back(cpus);
+		}
+	}
+	return nodes;
+}
+
+const std::vector<std::vector<int>> &numa_nodes() {
+	static const std::vector<std::vector<int>> nodes = read_numa_nodes();
+	return nodes;
+}
+
+} // namespace
+
+int numa_node_count() {
+	return std::max<int>(1, (int)numa_nodes().size());
+}
+
+int bind_thread_to_numa_node(int thread_index) {
+	const std::vector<std::vector<int>> &nodes = numa_nodes();
+	if (!numa_binding_on.load() || nodes.size() < 2) {
+		return -1;
+	}
+	int node = thread_index % (int)nodes.size();
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : nodes[node]) {
+		CPU_SET(cpu, &set);
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? node : -1;
+}
+
+#else
+
+int numa_node_count() {
+	return 1;
+}
+
+int bind_thread_to_numa_node(int) {
+	return -1;
+}
+
+#endif
+
+} // namespace chess
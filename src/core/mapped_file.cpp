@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chess {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), file_handle(nullptr), mapping_handle(nullptr) {}
+
+bool MappedFile::open(const std::string &path) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	file_handle = file;
+	mapping_handle = mapping;
+	bytes = (const uint8_t *)view;
+	length = (size_t)file_size.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes != nullptr) {
+		UnmapViewOfFile(bytes);
+		CloseHandle(mapping_handle);
+		CloseHandle(file_handle);
+	}
+	bytes = nullptr;
+	length = 0;
+	file_handle = nullptr;
+	mapping_handle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : bytes(nullptr), length(0) {}
+
+bool MappedFile::open(const std::string &path) {
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps its own reference to the file.
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	bytes = (const uint8_t *)view;
+	length = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes != nullptr) {
+		munmap((void *)bytes, length);
+	}
+	bytes = nullptr;
+	length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool file_exists(const std::string &path) {
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fclose(file);
+	return true;
+}
+
+} // namespace chess
@@ -0,0 +1,40 @@
+#ifndef CHESS_CORE_MAPPED_FILE_H
+#define CHESS_CORE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace chess {
+
+// Read-only memory mapping of a whole file (tablebases, opening books). Pages are only
+// read from disk when touched, so mapping a large file costs next to nothing.
+class MappedFile {
+private:
+	const uint8_t *bytes;
+	size_t length;
+#if defined(_WIN32)
+	void *file_handle;
+	void *mapping_handle;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	// False if the file is missing, empty or cannot be mapped.
+	bool open(const std::string &path);
+	void close();
+
+	bool is_open() const { return bytes != nullptr; }
+	const uint8_t *data() const { return bytes; }
+	size_t size() const { return length; }
+};
+
+bool file_exists(const std::string &path);
+
+} // namespace chess
+
+#endif
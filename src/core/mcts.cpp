@@ -0,0 +1,650 @@
+#include "mcts.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace chess {
+
+// Victim values in PieceType order (P, R, N, B, Q, K), in pawns, for the move priors.
+static const float PRIOR_VICTIM_VALUES[6] = { 1.0f, 5.0f, 3.0f, 3.0f, 9.0f, 0.0f };
+
+// Progress reports of the main worker, at most this often.
+static const int64_t REPORT_INTERVAL_MS = 1000;
+
+void Mcts::Node::reset(Move node_move, float node_prior) {
+	move = node_move;
+	prior = node_prior;
+	terminal_value = 0.0f;
+	first_child = NO_NODE;
+	child_count = 0;
+	state.store(NODE_UNEXPANDED, std::memory_order_relaxed);
+	visits.store(0, std::memory_order_relaxed);
+	virtual_loss.store(0, std::memory_order_relaxed);
+	value_sum.store(0, std::memory_order_relaxed);
+}
+
+void Mcts::Node::copy_from(const Node &other) {
+	move = other.move;
+	prior = other.prior;
+	terminal_value = other.terminal_value;
+	first_child = NO_NODE;
+	child_count = 0;
+	state.store(other.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	visits.store(other.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	virtual_loss.store(0, std::memory_order_relaxed);
+	value_sum.store(other.value_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+float Mcts::Node::mean_value(float default_value) const {
+	int32_t n = visits.load(std::memory_order_relaxed);
+	return n > 0 ? (float)((double)value_sum.load(std::memory_order_relaxed) / VALUE_ONE / n) : default_value;
+}
+
+void Mcts::NodeArena::resize(size_t count) {
+	nodes.resize(count);
+	capacity = count;
+	used = 0;
+}
+
+uint32_t Mcts::NodeArena::allocate(size_t count) {
+	size_t first = used.fetch_add(count);
+	if (first + count > capacity) {
+		return NO_NODE;
+	}
+	return (uint32_t)first;
+}
+
+// Per-thread state: a position walked from the root and back, and the batch being filled.
+struct Mcts::Worker {
+	enum Descent {
+		DESCENT_EVALUATE, // Leaf expanded, its inputs written to the batch.
+		DESCENT_SCORED,   // Value already known (terminal, or handcrafted without a network).
+		DESCENT_COLLISION
+	};
+
+	Mcts *mcts;
+	int id;
+	Position pos;
+	Evaluator evaluator;
+	Network::Workspace workspace;
+	std::vector<float> batch_inputs;
+	std::vector<std::vector<uint32_t>> batch_paths;
+	std::vector<char> batch_policy; // Leaf waits in NODE_EXPANDING for its policy priors.
+	std::vector<Move> path_moves;
+	std::vector<UndoInfo> undos;
+	MctsStats stats;
+	int64_t handcrafted_evaluations = 0;
+
+	Worker(Mcts *owner, int worker_id) : mcts(owner), id(worker_id) {}
+
+	void prepare_batch() {
+		int size = std::max(1, mcts->params.batch_size);
+		batch_inputs.assign((size_t)size * NETWORK_INPUTS, 0.0f);
+		batch_paths.resize(size);
+		batch_policy.assign(size, 0);
+		if (mcts->network != nullptr) {
+			mcts->network->init_workspace(workspace);
+		}
+	}
+
+	bool use_network() const {
+		return mcts->eval_mode != EVAL_HANDCRAFTED && mcts->network != nullptr && mcts->network->input_size() == NETWORK_INPUTS;
+	}
+
+	bool use_policy() const {
+		return use_network() && mcts->network->policy_size() == POLICY_OUTPUTS;
+	}
+
+	uint32_t select_child(uint32_t index) const {
+		const NodeArena &arena = mcts->arena();
+		const Node &parent = arena[index];
+		int32_t parent_visits = parent.visits.load(std::memory_order_relaxed) + parent.virtual_loss.load(std::memory_order_relaxed);
+		float sqrt_visits = std::sqrt((float)std::max(parent_visits, 1));
+		// The parent's value is for the side that moved into it; its children are rated for the other side.
+		float fpu = std::max(0.0f, 1.0f - parent.mean_value(0.5f) - mcts->params.fpu_reduction);
+
+		uint32_t best = parent.first_child;
+		float best_score = -1e30f;
+		for (uint32_t i = 0; i < parent.child_count; i++) {
+			const Node &child = arena[parent.first_child + i];
+			// Virtual losses count as visits worth nothing until the real value is backed up.
+			int32_t n = child.visits.load(std::memory_order_relaxed) + child.virtual_loss.load(std::memory_order_relaxed);
+			float q = n > 0 ? (float)((double)child.value_sum.load(std::memory_order_relaxed) / VALUE_ONE / n) : fpu;
+			float score = q + mcts->params.c_puct * child.prior * sqrt_visits / (1 + n);
+			if (score > best_score) {
+				best_score = score;
+				best = parent.first_child + i;
+			}
+		}
+		return best;
+	}
+
+	// Cheap priors for networks without a policy head: captures by victim value, queen promotions.
+	void set_children(Node &node, uint32_t first, const MoveList &legal) {
+		NodeArena &arena = mcts->arena();
+		float weights[256];
+		float total = 0.0f;
+		for (int i = 0; i < legal.size; i++) {
+			Move move = legal.moves[i];
+			float weight = 1.0f;
+			if (pos.is_capture(move)) {
+				Piece victim = pos.piece_on(move_to(move));
+				weight += 0.5f * (victim != NO_PIECE ? PRIOR_VICTIM_VALUES[type_of(victim)] : 1.0f);
+			}
+			if (move_promotion(move) == QUEEN) {
+				weight += 3.0f;
+			}
+			weights[i] = weight;
+			total += weight;
+		}
+		for (int i = 0; i < legal.size; i++) {
+			arena[first + i].reset(legal.moves[i], weights[i] / total);
+		}
+		node.first_child = first;
+		node.child_count = (uint16_t)legal.size;
+	}
+
+	// Replace the cheap priors of a leaf's children by the policy and publish the leaf.
+	void set_policy_priors(Node &node, const float *trunk) {
+		NodeArena &arena = mcts->arena();
+		float logits[256];
+		for (uint32_t i = 0; i < node.child_count; i++) {
+			logits[i] = mcts->network->policy_logit(trunk, policy_index(arena[node.first_child + i].move));
+		}
+		softmax(logits, node.child_count);
+		for (uint32_t i = 0; i < node.child_count; i++) {
+			arena[node.first_child + i].prior = logits[i];
+		}
+		node.state.store(NODE_EXPANDED, std::memory_order_release);
+	}
+
+	// The claimed leaf at pos: mark it terminal, or give it children and score it. With a policy
+	// head the leaf stays NODE_EXPANDING until the batch has its priors.
+	Descent expand(Node &node, bool is_root, float *inputs, float &value, bool &policy_pending) {
+		MoveList legal;
+		generate_legal_moves(pos, legal);
+		if (legal.size == 0 || (!is_root && pos.is_draw())) {
+			// Being mated is a win for the side that moved into the node.
+			node.terminal_value = legal.size == 0 && pos.in_check() ? 1.0f : 0.5f;
+			node.state.store(NODE_TERMINAL, std::memory_order_release);
+			value = node.terminal_value;
+			return DESCENT_SCORED;
+		}
+
+		// With the arena full the leaf is still scored, it just stays a leaf.
+		uint32_t first = mcts->arena().allocate(legal.size);
+		policy_pending = false;
+		if (first == NO_NODE) {
+			node.state.store(NODE_UNEXPANDED, std::memory_order_release);
+		} else if (use_policy()) {
+			set_children(node, first, legal);
+			policy_pending = true;
+		} else {
+			set_children(node, first, legal);
+			node.state.store(NODE_EXPANDED, std::memory_order_release);
+		}
+
+		if (use_network()) {
+			encode_position(pos, inputs);
+			return DESCENT_EVALUATE;
+		}
+		// Handcrafted score squashed like the network output, for the side that just moved.
+		handcrafted_evaluations++;
+		value = 1.0f / (1.0f + std::pow(10.0f, evaluator.handcrafted(pos) / 400.0f));
+		return DESCENT_SCORED;
+	}
+
+	// Walk from the root by PUCT, adding a virtual loss to every node on the path.
+	Descent descend(std::vector<uint32_t> &path, float *inputs, float &value, bool &policy_pending) {
+		NodeArena &arena = mcts->arena();
+		path.clear();
+		path_moves.clear();
+		Descent result;
+		uint32_t index = mcts->root_node;
+		for (;;) {
+			Node &node = arena[index];
+			node.virtual_loss.fetch_add(1, std::memory_order_relaxed);
+			path.push_back(index);
+
+			uint8_t state = node.state.load(std::memory_order_acquire);
+			if (state == NODE_UNEXPANDED) {
+				if (node.state.compare_exchange_strong(state, NODE_EXPANDING, std::memory_order_acquire)) {
+					result = expand(node, path.size() == 1, inputs, value, policy_pending);
+					break;
+				}
+			}
+			if (state == NODE_TERMINAL) {
+				value = node.terminal_value;
+				result = DESCENT_SCORED;
+				break;
+			}
+			if (state == NODE_EXPANDING) {
+				result = DESCENT_COLLISION;
+				break;
+			}
+
+			index = select_child(index);
+			Move move = arena[index].move;
+			undos.resize(path_moves.size() + 1);
+			pos.make_move(move, undos.back());
+			path_moves.push_back(move);
+		}
+
+		for (size_t i = path_moves.size(); i-- > 0;) {
+			pos.unmake_move(path_moves[i], undos[i]);
+		}
+		int depth = (int)path.size() - 1;
+		if (depth > stats.max_depth) {
+			stats.max_depth = depth;
+			int seen = mcts->max_depth.load(std::memory_order_relaxed);
+			while (depth > seen && !mcts->max_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+			}
+		}
+		if (result == DESCENT_COLLISION) {
+			for (uint32_t node : path) {
+				arena[node].virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+		return result;
+	}
+
+	// Add value (for the side that moved into the leaf) up the path, flipping sides at each ply.
+	void backup(const std::vector<uint32_t> &path, float value) {
+		NodeArena &arena = mcts->arena();
+		for (size_t i = path.size(); i-- > 0;) {
+			Node &node = arena[path[i]];
+			node.value_sum.fetch_add((int64_t)std::lround(value * VALUE_ONE), std::memory_order_relaxed);
+			node.visits.fetch_add(1, std::memory_order_relaxed);
+			node.virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+			value = 1.0f - value;
+		}
+		stats.playouts++;
+		mcts->playouts.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void search() {
+		int64_t last_report = 0;
+		while (!mcts->stop_flag.load(std::memory_order_relaxed)) {
+			int pending = 0;
+			bool collided = false;
+			for (int i = 0; i < (int)batch_paths.size() && !mcts->stop_flag.load(std::memory_order_relaxed); i++) {
+				float value = 0.0f;
+				bool policy_pending = false;
+				Descent descent = descend(batch_paths[pending], &batch_inputs[(size_t)pending * NETWORK_INPUTS], value,
+						policy_pending);
+				if (descent == DESCENT_EVALUATE) {
+					batch_policy[pending] = policy_pending;
+					pending++;
+				} else if (descent == DESCENT_SCORED) {
+					backup(batch_paths[pending], value);
+				} else {
+					// The rest of the tree is likely crowded too: score what we have.
+					stats.collisions++;
+					collided = true;
+					break;
+				}
+			}
+
+			if (pending > 0) {
+				const float *outputs = mcts->network->forward_batch(batch_inputs.data(), pending, workspace);
+				int stride = mcts->network->output_size();
+				for (int i = 0; i < pending; i++) {
+					if (batch_policy[i]) {
+						set_policy_priors(mcts->arena()[batch_paths[i].back()], mcts->network->trunk(workspace, i));
+					}
+					backup(batch_paths[i], outputs[i * stride]);
+				}
+				stats.batches++;
+				stats.batched_leaves += pending;
+			} else if (collided) {
+				std::this_thread::yield();
+			}
+
+			if (id == 0) {
+				mcts->check_limits();
+				int64_t elapsed = mcts->elapsed_ms();
+				if (mcts->on_iteration && elapsed - last_report >= REPORT_INTERVAL_MS) {
+					last_report = elapsed;
+					mcts->on_iteration(mcts->make_info());
+				}
+			}
+		}
+	}
+};
+
+Mcts::Mcts()
+		: network(nullptr), eval_mode(EVAL_NETWORK), current_arena(0), root_node(NO_NODE), tree_revision(0), has_tree(false), playout_limit(0), reused_nodes(0),
+		  stop_flag(false), searching(false), playouts(0), max_depth(0) {
+	set_threads(1);
+	set_tree_size(64);
+}
+
+Mcts::~Mcts() {
+	stop();
+	wait();
+}
+
+void Mcts::set_network(const Network *new_network) {
+	network = new_network;
+	for (auto &worker : workers) {
+		worker->evaluator.set_network(network);
+	}
+}
+
+void Mcts::set_threads(int count) {
+	count = std::max(1, std::min(count, 256));
+	workers.clear();
+	for (int i = 0; i < count; i++) {
+		workers.emplace_back(new Worker(this, i));
+		workers.back()->evaluator.set_network(network);
+	}
+}
+
+void Mcts::set_tree_size(size_t megabytes) {
+	size_t count = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(Node);
+	count = std::min<size_t>(count, NO_NODE - 1);
+	arenas[0].resize(count);
+	arenas[1].resize(count);
+	clear();
+}
+
+void Mcts::clear() {
+	has_tree = false;
+	root_node = NO_NODE;
+	arenas[0].used = 0;
+	arenas[1].used = 0;
+	for (auto &worker : workers) {
+		worker->evaluator.clear_pawn_table();
+	}
+}
+
+int64_t Mcts::elapsed_ms() const {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+// Copy the subtree under from_root into the other arena, children kept contiguous.
+uint32_t Mcts::copy_subtree(uint32_t from_root) {
+	NodeArena &source = arenas[current_arena];
+	NodeArena &target = arenas[1 - current_arena];
+	target.used = 0;
+	uint32_t new_root = target.allocate(1);
+	target[new_root].copy_from(source[from_root]);
+
+	std::vector<std::pair<uint32_t, uint32_t>> queue(1, std::make_pair(from_root, new_root));
+	for (size_t next = 0; next < queue.size(); next++) {
+		const Node &from = source[queue[next].first];
+		Node &to = target[queue[next].second];
+		if (from.state.load() != NODE_EXPANDED || from.child_count == 0) {
+			continue;
+		}
+		uint32_t first = target.allocate(from.child_count);
+		to.first_child = first;
+		to.child_count = from.child_count;
+		for (uint32_t i = 0; i < from.child_count; i++) {
+			target[first + i].copy_from(source[from.first_child + i]);
+			queue.push_back(std::make_pair(from.first_child + i, first + i));
+		}
+	}
+	current_arena = 1 - current_arena;
+	return new_root;
+}
+
+// Keep the tree when position is its root or lies one or two plies below it (our move and
+// the reply); otherwise start a new one.
+void Mcts::reuse_tree(const Position &position) {
+	reused_nodes = 0;
+	uint32_t found = NO_NODE;
+	// Values backed up from older weights (or another evaluator) are not kept.
+	uint64_t revision = network != nullptr && eval_mode != EVAL_HANDCRAFTED ? network->revision() : 0;
+	if (has_tree && root_node != NO_NODE && revision == tree_revision) {
+		if (tree_position.key() == position.key()) {
+			found = root_node;
+		} else {
+			NodeArena &nodes = arena();
+			Position walk = tree_position;
+			const Node &top = nodes[root_node];
+			for (uint32_t i = 0; i < top.child_count && found == NO_NODE; i++) {
+				const Node &child = nodes[top.first_child + i];
+				UndoInfo undo;
+				walk.make_move(child.move, undo);
+				if (walk.key() == position.key()) {
+					found = top.first_child + i;
+				}
+				for (uint32_t j = 0; j < child.child_count && found == NO_NODE; j++) {
+					const Node &grandchild = nodes[child.first_child + j];
+					UndoInfo reply_undo;
+					walk.make_move(grandchild.move, reply_undo);
+					if (walk.key() == position.key()) {
+						found = child.first_child + j;
+					}
+					walk.unmake_move(grandchild.move, reply_undo);
+				}
+				walk.unmake_move(child.move, undo);
+			}
+		}
+	}
+
+	// Copying also drops the nodes left unreachable, even when the root stays the same.
+	if (found != NO_NODE) {
+		found = copy_subtree(found);
+	}
+	if (found == NO_NODE) {
+		arena().used = 0;
+		found = arena().allocate(1);
+		arena()[found].reset(MOVE_NONE, 1.0f);
+	} else {
+		reused_nodes = (int64_t)arena().used.load();
+	}
+	// A draw by repetition below the old root is not one at the new root: search it again.
+	if (arena()[found].state.load() == NODE_TERMINAL) {
+		arena().used = found + 1;
+		arena()[found].reset(MOVE_NONE, 1.0f);
+		reused_nodes = 0;
+	}
+	root_node = found;
+	tree_position = position;
+	tree_revision = revision;
+	has_tree = true;
+}
+
+void Mcts::check_limits() {
+	if (limits.infinite) {
+		return;
+	}
+	if ((playout_limit > 0 && playouts.load() >= playout_limit) ||
+			(time_manager.enabled() && elapsed_ms() >= time_manager.optimum())) {
+		stop_flag = true;
+	}
+}
+
+uint32_t Mcts::best_child(uint32_t index) const {
+	const NodeArena &nodes = arena();
+	const Node &node = nodes[index];
+	if (node.state.load() != NODE_EXPANDED) {
+		return NO_NODE;
+	}
+	uint32_t best = NO_NODE;
+	int32_t best_visits = -1;
+	float best_value = -1.0f;
+	for (uint32_t i = 0; i < node.child_count; i++) {
+		const Node &child = nodes[node.first_child + i];
+		int32_t visits = child.visits.load();
+		float value = child.mean_value(0.0f);
+		// A proven mate is taken however few visits it has.
+		if (child.state.load() == NODE_TERMINAL && child.terminal_value == 1.0f) {
+			return node.first_child + i;
+		}
+		if (visits > best_visits || (visits == best_visits && value > best_value)) {
+			best = node.first_child + i;
+			best_visits = visits;
+			best_value = value;
+		}
+	}
+	return best_visits > 0 ? best : NO_NODE;
+}
+
+std::vector<Move> Mcts::principal_variation() const {
+	std::vector<Move> pv;
+	uint32_t index = root_node;
+	while ((int)pv.size() < MAX_PLY && (index = best_child(index)) != NO_NODE) {
+		pv.push_back(arena()[index].move);
+	}
+	return pv;
+}
+
+// Mean value of a root child as a score for the side to move at the root.
+static int child_score(float value, bool proven_mate) {
+	return proven_mate ? MATE_SCORE - 1 : output_to_score(value);
+}
+
+SearchInfo Mcts::make_info() const {
+	SearchInfo info;
+	info.pv = principal_variation();
+	info.depth = (int)info.pv.size();
+	info.seldepth = max_depth.load();
+	info.nodes = playouts.load();
+	info.time_ms = elapsed_ms();
+	info.hashfull = (int)(std::min(arena().used.load(), arena().capacity) * 1000 / std::max<size_t>(arena().capacity, 1));
+	uint32_t best = best_child(root_node);
+	if (best != NO_NODE) {
+		const Node &node = arena()[best];
+		info.score = child_score(node.mean_value(0.5f), node.state.load() == NODE_TERMINAL && node.terminal_value == 1.0f);
+	}
+	return info;
+}
+
+SearchResult Mcts::search_root() {
+	SearchResult result;
+	MoveList legal;
+	generate_legal_moves(root, legal);
+	time_manager.start(limits, root.side_to_move());
+	playout_limit = limits.nodes > 0 ? limits.nodes : (time_manager.enabled() || limits.infinite ? 0 : params.default_playouts);
+	playouts = 0;
+	max_depth = 0;
+	for (auto &worker : workers) {
+		worker->pos = root;
+		worker->stats = MctsStats();
+		worker->handcrafted_evaluations = 0;
+		worker->prepare_batch();
+	}
+	last_stats = MctsStats();
+	if (legal.size == 0) {
+		return result;
+	}
+
+	reuse_tree(root);
+	std::vector<std::thread> helpers;
+	for (size_t i = 1; i < workers.size(); i++) {
+		helpers.emplace_back([this, i]() {
+			bind_thread_to_numa_node((int)i);
+			workers[i]->search();
+		});
+	}
+	workers[0]->search();
+	for (std::thread &helper : helpers) {
+		helper.join();
+	}
+
+	SearchInfo info = make_info();
+	if (on_iteration) {
+		on_iteration(info);
+	}
+
+	const Node &top = arena()[root_node];
+	std::vector<uint32_t> children;
+	for (uint32_t i = 0; i < top.child_count; i++) {
+		children.push_back(top.first_child + i);
+	}
+	std::stable_sort(children.begin(), children.end(),
+			[this](uint32_t a, uint32_t b) { return arena()[a].visits.load() > arena()[b].visits.load(); });
+	int line_count = std::max(1, std::min(limits.multi_pv, (int)children.size()));
+	for (int i = 0; i < line_count && i < (int)children.size(); i++) {
+		const Node &child = arena()[children[i]];
+		RootLine line;
+		line.move = child.move;
+		line.score = child_score(child.mean_value(0.5f), child.state.load() == NODE_TERMINAL && child.terminal_value == 1.0f);
+		line.depth = info.depth;
+		line.pv.push_back(child.move);
+		for (uint32_t index = children[i]; (index = best_child(index)) != NO_NODE && (int)line.pv.size() < MAX_PLY;) {
+			line.pv.push_back(arena()[index].move);
+		}
+		result.lines.push_back(line);
+	}
+
+	result.best_move = info.pv.empty() ? legal.moves[0] : info.pv[0];
+	result.ponder_move = info.pv.size() > 1 ? info.pv[1] : MOVE_NONE;
+	result.score = info.score;
+	if (!result.lines.empty() && result.lines[0].move != result.best_move) {
+		// A proven mate outranks the most visited move; keep lines[0] on the played move.
+		for (size_t i = 1; i < result.lines.size(); i++) {
+			if (result.lines[i].move == result.best_move) {
+				std::swap(result.lines[0], result.lines[i]);
+			}
+		}
+	}
+	result.depth = info.depth;
+	result.nodes = playouts.load();
+	result.time_ms = elapsed_ms();
+
+	for (auto &worker : workers) {
+		last_stats.batches += worker->stats.batches;
+		last_stats.batched_leaves += worker->stats.batched_leaves;
+		last_stats.collisions += worker->stats.collisions;
+		result.stats.handcrafted_evaluations += worker->handcrafted_evaluations;
+	}
+	last_stats.playouts = result.nodes;
+	last_stats.max_depth = max_depth.load();
+	last_stats.tree_nodes = (int64_t)std::min(arena().used.load(), arena().capacity);
+	last_stats.reused_nodes = reused_nodes;
+	result.stats.nodes = result.nodes;
+	result.stats.evaluations = last_stats.batched_leaves + result.stats.handcrafted_evaluations;
+	result.stats.time_ms = result.time_ms;
+	return result;
+}
+
+void Mcts::prepare(const Position &position, const SearchLimits &search_limits,
+		const InfoCallback &info_callback, const FinishCallback &finish_callback) {
+	wait();
+	root = position;
+	limits = search_limits;
+	on_iteration = info_callback;
+	on_finish = finish_callback;
+	stop_flag = false;
+	start_time = std::chrono::steady_clock::now();
+	searching = true;
+}
+
+void Mcts::start(const Position &position, const SearchLimits &search_limits,
+		const InfoCallback &info_callback, const FinishCallback &finish_callback) {
+	prepare(position, search_limits, info_callback, finish_callback);
+	main_thread = std::thread([this]() {
+		// As in Search::start, only multi-threaded searches are pinned.
+		if (workers.size() > 1) {
+			bind_thread_to_numa_node(0);
+		}
+		last_result = search_root();
+		if (on_finish) {
+			on_finish(last_result);
+		}
+		searching = false;
+	});
+}
+
+void Mcts::wait() {
+	if (main_thread.joinable()) {
+		main_thread.join();
+	}
+}
+
+SearchResult Mcts::run(const Position &position, const SearchLimits &search_limits, const InfoCallback &info_callback) {
+	prepare(position, search_limits, info_callback, FinishCallback());
+	last_result = search_root();
+	searching = false;
+	return last_result;
+}
+
+void Mcts::stop() {
+	stop_flag = true;
+}
+
+} // namespace chess
@@ -0,0 +1,176 @@
+#ifndef CHESS_CORE_MCTS_H
+#define CHESS_CORE_MCTS_H
+
+#include "evaluate.h"
+#include "large_pages.h"
+#include "movegen.h"
+#include "network.h"
+#include "position.h"
+#include "search.h"
+#include "timeman.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+struct MctsParams {
+	float c_puct = 1.5f;          // Exploration weight of the prior against the mean value.
+	float fpu_reduction = 0.2f;   // Unvisited children start at the parent's value minus this.
+	int batch_size = 16;          // Leaves each thread collects before one forward_batch call.
+	int64_t default_playouts = 1600; // Budget when the limits give neither nodes nor time.
+};
+
+// Counters of one MCTS search, beside the usual SearchResult.
+struct MctsStats {
+	int64_t playouts = 0;        // Leaf values backed up to the root (terminal ones included).
+	int64_t batches = 0;         // Network calls...
+	int64_t batched_leaves = 0;  // ...and the leaves they scored.
+	int64_t collisions = 0;      // Descents abandoned at a leaf another thread was expanding.
+	int64_t tree_nodes = 0;      // Arena nodes in use at the end of the search...
+	int64_t reused_nodes = 0;    // ...of which kept from the previous search.
+	int max_depth = 0;
+
+	double average_batch() const { return batches > 0 ? (double)batched_leaves / batches : 0.0; }
+};
+
+// PUCT Monte Carlo tree search over the value network, an alternative to the alpha-beta Search.
+// Nodes live in a preallocated arena, children contiguous, so a tree is a handful of indices.
+// Threads descend concurrently, each adding a virtual loss along its path so the others spread
+// out, and collect up to batch_size leaves for a single Network::forward_batch call, which also
+// gives the children's priors when the network has a policy head. Without a network the
+// handcrafted evaluation, squashed to a win probability, scores the leaves.
+// Once the arena is full, leaves are still scored but no longer expanded. The subtree under
+// the position actually reached is kept for the next search.
+class Mcts {
+public:
+	typedef Search::InfoCallback InfoCallback;
+	typedef Search::FinishCallback FinishCallback;
+
+private:
+	static const uint32_t NO_NODE = 0xFFFFFFFFu;
+	static const int64_t VALUE_ONE = 1 << 16; // Fixed-point unit of value_sum.
+
+	enum NodeState : uint8_t {
+		NODE_UNEXPANDED,
+		NODE_EXPANDING,  // Claimed by one thread; others treat it as a collision.
+		NODE_EXPANDED,
+		NODE_TERMINAL    // Mate, stalemate or draw: terminal_value is exact.
+	};
+
+	// Values are win probabilities for the side that played move, the same convention
+	// as the network output.
+	struct Node {
+		Move move;
+		float prior;
+		float terminal_value;
+		uint32_t first_child;
+		uint16_t child_count;
+		std::atomic<uint8_t> state;
+		std::atomic<int32_t> visits;
+		std::atomic<int32_t> virtual_loss;
+		std::atomic<int64_t> value_sum;
+
+		void reset(Move node_move, float node_prior);
+		void copy_from(const Node &other);
+		float mean_value(float default_value) const;
+	};
+
+	// Fixed pool of nodes handed out by an atomic bump pointer.
+	struct NodeArena {
+		LargeArray<Node> nodes;
+		size_t capacity = 0;
+		std::atomic<size_t> used;
+
+		NodeArena() : used(0) {}
+		void resize(size_t count);
+		uint32_t allocate(size_t count); // Index of count fresh nodes, or NO_NODE when full.
+		Node &operator[](uint32_t index) { return nodes[index]; }
+		const Node &operator[](uint32_t index) const { return nodes[index]; }
+	};
+
+	struct Worker;
+	friend struct Worker;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	const Network *network;
+	EvalMode eval_mode;
+	MctsParams params;
+
+	// Two arenas: the tree kept between searches is compacted from one into the other.
+	NodeArena arenas[2];
+	int current_arena;
+	uint32_t root_node;
+	Position tree_position;   // Position at root_node, valid while has_tree.
+	uint64_t tree_revision;   // Network revision the tree's values came from.
+	bool has_tree;
+
+	Position root;
+	SearchLimits limits;
+	InfoCallback on_iteration;
+	FinishCallback on_finish;
+	std::chrono::steady_clock::time_point start_time;
+	TimeManager time_manager;
+	int64_t playout_limit;
+	SearchResult last_result;
+	MctsStats last_stats;
+	int64_t reused_nodes;
+
+	std::atomic<bool> stop_flag;
+	std::atomic<bool> searching;
+	std::atomic<int64_t> playouts;
+	std::atomic<int> max_depth;
+	std::thread main_thread;
+
+	NodeArena &arena() { return arenas[current_arena]; }
+	const NodeArena &arena() const { return arenas[current_arena]; }
+	void reuse_tree(const Position &position);
+	uint32_t copy_subtree(uint32_t from_root);
+	void prepare(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback, const FinishCallback &finish_callback);
+	void check_limits();
+	int64_t elapsed_ms() const;
+	uint32_t best_child(uint32_t node) const; // Most visited child, or NO_NODE.
+	std::vector<Move> principal_variation() const;
+	SearchInfo make_info() const;
+	SearchResult search_root();
+
+public:
+	Mcts();
+	~Mcts();
+
+	// Configuration; not to be changed while a search is running.
+	void set_network(const Network *network);
+	void set_threads(int count);
+	int get_threads() const { return (int)workers.size(); }
+	void set_tree_size(size_t megabytes); // Memory for each of the two node arenas; drops the tree.
+	// EVAL_HANDCRAFTED scores every leaf without the network; EVAL_HYBRID counts as EVAL_NETWORK,
+	// since a tree search has no window to be lazy about.
+	void set_eval_mode(EvalMode mode) { eval_mode = mode; }
+	EvalMode get_eval_mode() const { return eval_mode; }
+	void set_params(const MctsParams &mcts_params) { params = mcts_params; }
+	const MctsParams &get_params() const { return params; }
+
+	// Forget the tree (new game).
+	void clear();
+
+	// Same protocol as Search: limits.nodes counts playouts, time limits are used whole (the
+	// optimum budget), depth and ponder are ignored (ponder with an infinite search).
+	void start(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback = InfoCallback(), const FinishCallback &finish_callback = FinishCallback());
+	void wait();
+	SearchResult run(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback = InfoCallback());
+	void stop();
+	bool is_searching() const { return searching.load(); }
+
+	const MctsStats &get_last_stats() const { return last_stats; }
+};
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,334 @@
+#include "movegen.h"
+#include "bitboard.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace chess {
+
+bool MoveList::contains(Move move) const {
+	for (int i = 0; i < size; i++) {
+		if (moves[i] == move) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void add_targets(MoveList &list, Square from, Bitboard targets) {
+	while (targets) {
+		list.push(encode_move(from, pop_lsb(targets)));
+	}
+}
+
+static void add_pawn_move(MoveList &list, Square from, Square to, bool promotes, GenType type) {
+	if (!promotes) {
+		list.push(encode_move(from, to));
+		return;
+	}
+	list.push(encode_move(from, to, QUEEN));
+	if (type == GEN_ALL) {
+		list.push(encode_move(from, to, ROOK));
+		list.push(encode_move(from, to, BISHOP));
+		list.push(encode_move(from, to, KNIGHT));
+	}
+}
+
+static void generate_pawn_moves(const Position &pos, MoveList &list, GenType type) {
+	int us = pos.side_to_move();
+	int them = 1 - us;
+	int push = (us == WHITE) ? -8 : 8;
+	int start_row = (us == WHITE) ? 6 : 1;
+	int promotion_row = (us == WHITE) ? 0 : 7;
+	Bitboard occupied = pos.occupied();
+	Bitboard enemies = pos.pieces(them);
+
+	Bitboard pawns = pos.pieces(us, PAWN);
+	while (pawns) {
+		Square from = pop_lsb(pawns);
+		Square to = from + push;
+		bool promotes = row_of(to) == promotion_row;
+
+		// Pushes: quiet moves, except promotions which quiescence also wants.
+		if (!(occupied & square_bb(to)) && (type == GEN_ALL || promotes)) {
+			add_pawn_move(list, from, to, promotes, type);
+			Square double_to = to + push;
+			if (type == GEN_ALL && row_of(from) == start_row && !(occupied & square_bb(double_to))) {
+				list.push(encode_move(from, double_to));
+			}
+		}
+
+		Bitboard captures = PAWN_ATTACKS[us][from] & enemies;
+		while (captures) {
+			add_pawn_move(list, from, pop_lsb(captures), promotes, type);
+		}
+		if (pos.en_passant_square() != NO_SQUARE && (PAWN_ATTACKS[us][from] & square_bb(pos.en_passant_square()))) {
+			list.push(encode_move(from, pos.en_passant_square()));
+		}
+	}
+}
+
+// Castling needs the rook at home, empty squares between, and no attacked square on the king's path.
+static void generate_castling(const Position &pos, MoveList &list) {
+	int us = pos.side_to_move();
+	int them = 1 - us;
+	int y = (us == WHITE) ? 7 : 0;
+	int rights = pos.castling_rights() >> (us * 2);
+	Square king = make_square(4, y);
+	Bitboard occupied = pos.occupied();
+	Piece rook = make_piece(us, ROOK);
+
+	if (!(rights & 3) || pos.piece_on(king) != make_piece(us, KING) || pos.is_square_attacked(king, them)) {
+		return;
+	}
+	if ((rights & 1) && pos.piece_on(make_square(7, y)) == rook &&
+			!(occupied & (square_bb(make_square(5, y)) | square_bb(make_square(6, y)))) &&
+			!pos.is_square_attacked(make_square(5, y), them) && !pos.is_square_attacked(make_square(6, y), them)) {
+		list.push(encode_move(king, make_square(6, y)));
+	}
+	if ((rights & 2) && pos.piece_on(make_square(0, y)) == rook &&
+			!(occupied & (square_bb(make_square(1, y)) | square_bb(make_square(2, y)) | square_bb(make_square(3, y)))) &&
+			!pos.is_square_attacked(make_square(3, y), them) && !pos.is_square_attacked(make_square(2, y), them)) {
+		list.push(encode_move(king, make_square(2, y)));
+	}
+}
+
+void generate_moves(const Position &pos, MoveList &list, GenType type) {
+	int us = pos.side_to_move();
+	Bitboard occupied = pos.occupied();
+	Bitboard targets = (type == GEN_CAPTURES) ? pos.pieces(1 - us) : ~pos.pieces(us);
+
+	generate_pawn_moves(pos, list, type);
+
+	Bitboard knights = pos.pieces(us, KNIGHT);
+	while (knights) {
+		Square from = pop_lsb(knights);
+		add_targets(list, from, KNIGHT_ATTACKS[from] & targets);
+	}
+	Bitboard bishops = pos.pieces(us, BISHOP);
+	while (bishops) {
+		Square from = pop_lsb(bishops);
+		add_targets(list, from, bishop_attacks(from, occupied) & targets);
+	}
+	Bitboard rooks = pos.pieces(us, ROOK);
+	while (rooks) {
+		Square from = pop_lsb(rooks);
+		add_targets(list, from, rook_attacks(from, occupied) & targets);
+	}
+	Bitboard queens = pos.pieces(us, QUEEN);
+	while (queens) {
+		Square from = pop_lsb(queens);
+		add_targets(list, from, queen_attacks(from, occupied) & targets);
+	}
+	Square king = pos.king_square(us);
+	if (king != NO_SQUARE) {
+		add_targets(list, king, KING_ATTACKS[king] & targets);
+		if (type == GEN_ALL) {
+			generate_castling(pos, list);
+		}
+	}
+}
+
+void generate_legal_moves(Position &pos, MoveList &list) {
+	MoveList pseudo;
+	generate_moves(pos, pseudo, GEN_ALL);
+	for (Move move : pseudo) {
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		if (!pos.was_last_move_illegal()) {
+			list.push(move);
+		}
+		pos.unmake_move(move, undo);
+	}
+}
+
+GameState get_game_state(Position &pos) {
+	MoveList legal;
+	generate_legal_moves(pos, legal);
+	if (legal.size == 0) {
+		return pos.in_check() ? GAME_CHECKMATE : GAME_STALEMATE;
+	}
+	if (pos.has_insufficient_material()) {
+		return GAME_DRAW_INSUFFICIENT_MATERIAL;
+	}
+	if (pos.is_fifty_move_draw()) {
+		return GAME_DRAW_FIFTY_MOVES;
+	}
+	if (pos.repetition_count() >= 2) {
+		return GAME_DRAW_REPETITION;
+	}
+	return GAME_ONGOING;
+}
+
+Move parse_uci_move(Position &pos, const std::string &text) {
+	MoveList legal;
+	generate_legal_moves(pos, legal);
+	for (Move move : legal) {
+		if (move_to_uci(move) == text) {
+			return move;
+		}
+	}
+	return MOVE_NONE;
+}
+
+static const char SAN_PIECES[] = "PRNBQK"; // PieceType order
+
+static bool is_castling(const Position &pos, Move move) {
+	Square from = move_from(move);
+	return type_of(pos.piece_on(from)) == KING && std::abs(file_of(move_to(move)) - file_of(from)) == 2;
+}
+
+Move parse_san_move(Position &pos, const std::string &text) {
+	std::string san;
+	for (char c : text) {
+		if (c != '+' && c != '#' && c != '!' && c != '?' && c != 'x' && c != ':' && c != '=' && c != '-') {
+			san += c;
+		}
+	}
+	if (san.size() >= 4 && san.compare(san.size() - 4, 4, "e.p.") == 0) {
+		san.resize(san.size() - 4);
+	}
+
+	MoveList legal;
+	generate_legal_moves(pos, legal);
+
+	// Castling, also written with zeros.
+	if (san == "OO" || san == "00" || san == "OOO" || san == "000") {
+		bool queen_side = san.size() == 3;
+		for (Move move : legal) {
+			if (is_castling(pos, move) && (file_of(move_to(move)) < file_of(move_from(move))) == queen_side) {
+				return move;
+			}
+		}
+		return MOVE_NONE;
+	}
+
+	int piece_type = PAWN;
+	size_t begin = 0;
+	if (!san.empty() && san[0] != '\0' && std::strchr(SAN_PIECES, san[0]) != nullptr) {
+		piece_type = (int)(std::strchr(SAN_PIECES, san[0]) - SAN_PIECES);
+		begin = 1;
+	}
+
+	int promotion = 0;
+	if (piece_type == PAWN && san.size() > begin && std::strchr("RNBQ", san.back()) != nullptr) {
+		promotion = (int)(std::strchr(SAN_PIECES, san.back()) - SAN_PIECES);
+		san.pop_back();
+	}
+	if (san.size() < begin + 2) {
+		return MOVE_NONE;
+	}
+	int to_file = san[san.size() - 2] - 'a';
+	int to_rank = san[san.size() - 1] - '1';
+	if (to_file < 0 || to_file > 7 || to_rank < 0 || to_rank > 7) {
+		return MOVE_NONE;
+	}
+	Square to = make_square(to_file, 7 - to_rank);
+
+	// Whatever sits between the piece letter and the destination narrows down the origin.
+	int from_file = -1;
+	int from_rank = -1;
+	for (size_t i = begin; i + 2 < san.size(); i++) {
+		if (san[i] >= 'a' && san[i] <= 'h') {
+			from_file = san[i] - 'a';
+		} else if (san[i] >= '1' && san[i] <= '8') {
+			from_rank = san[i] - '1';
+		} else {
+			return MOVE_NONE;
+		}
+	}
+
+	Move found = MOVE_NONE;
+	for (Move move : legal) {
+		Square from = move_from(move);
+		if (move_to(move) != to || type_of(pos.piece_on(from)) != piece_type || move_promotion(move) != promotion ||
+				(from_file >= 0 && file_of(from) != from_file) || (from_rank >= 0 && 7 - row_of(from) != from_rank)) {
+			continue;
+		}
+		if (found != MOVE_NONE) {
+			return MOVE_NONE; // Ambiguous.
+		}
+		found = move;
+	}
+	return found;
+}
+
+std::string move_to_san(Position &pos, Move move) {
+	Square from = move_from(move);
+	Square to = move_to(move);
+	int piece_type = type_of(pos.piece_on(from));
+	std::string san;
+
+	if (is_castling(pos, move)) {
+		san = file_of(to) > file_of(from) ? "O-O" : "O-O-O";
+	} else {
+		bool capture = pos.is_capture(move);
+		if (piece_type == PAWN) {
+			if (capture) {
+				san += (char)('a' + file_of(from));
+			}
+		} else {
+			san += SAN_PIECES[piece_type];
+			// Disambiguate by file if that suffices, else by rank, else by both.
+			MoveList legal;
+			generate_legal_moves(pos, legal);
+			bool clash = false;
+			bool same_file = false;
+			bool same_rank = false;
+			for (Move other : legal) {
+				Square other_from = move_from(other);
+				if (other == move || move_to(other) != to || other_from == from || type_of(pos.piece_on(other_from)) != piece_type) {
+					continue;
+				}
+				clash = true;
+				same_file |= file_of(other_from) == file_of(from);
+				same_rank |= row_of(other_from) == row_of(from);
+			}
+			if (clash) {
+				if (!same_file) {
+					san += (char)('a' + file_of(from));
+				} else if (!same_rank) {
+					san += (char)('1' + 7 - row_of(from));
+				} else {
+					san += square_to_string(from);
+				}
+			}
+		}
+		if (capture) {
+			san += 'x';
+		}
+		san += square_to_string(to);
+		if (move_promotion(move) != 0) {
+			san += '=';
+			san += SAN_PIECES[move_promotion(move)];
+		}
+	}
+
+	UndoInfo undo;
+	pos.make_move(move, undo);
+	if (pos.in_check()) {
+		MoveList replies;
+		generate_legal_moves(pos, replies);
+		san += replies.size == 0 ? '#' : '+';
+	}
+	pos.unmake_move(move, undo);
+	return san;
+}
+
+uint64_t perft(Position &pos, int depth) {
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	if (depth <= 1) {
+		return depth == 1 ? (uint64_t)moves.size : 1;
+	}
+	uint64_t nodes = 0;
+	for (Move move : moves) {
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		nodes += perft(pos, depth - 1);
+		pos.unmake_move(move, undo);
+	}
+	return nodes;
+}
+
+} // namespace chess
@@ -0,0 +1,59 @@
+#ifndef CHESS_CORE_MOVEGEN_H
+#define CHESS_CORE_MOVEGEN_H
+
+#include "position.h"
+
+#include <string>
+
+namespace chess {
+
+// Fixed-capacity move buffer; no legal chess position has more than 218 moves.
+struct MoveList {
+	Move moves[256];
+	int size = 0;
+
+	void push(Move move) { moves[size++] = move; }
+	Move *begin() { return moves; }
+	Move *end() { return moves + size; }
+	bool contains(Move move) const;
+};
+
+enum GenType {
+	GEN_ALL,      // Every pseudo-legal move.
+	GEN_CAPTURES  // Captures (including en passant) and queen promotions, for quiescence.
+};
+
+// Pseudo-legal moves: the mover's king may be left in check (castling legality is checked).
+void generate_moves(const Position &pos, MoveList &list, GenType type = GEN_ALL);
+
+// Fully legal moves, filtered by playing each one.
+void generate_legal_moves(Position &pos, MoveList &list);
+
+// Result of the game in a position, shared by the search driver, self-play and the UI.
+enum GameState {
+	GAME_ONGOING,
+	GAME_CHECKMATE,
+	GAME_STALEMATE,
+	GAME_DRAW_REPETITION,      // Threefold: the position occurred twice before.
+	GAME_DRAW_FIFTY_MOVES,
+	GAME_DRAW_INSUFFICIENT_MATERIAL
+};
+
+// Mate and stalemate take precedence over the draw rules.
+GameState get_game_state(Position &pos);
+
+// Legal move matching a UCI string such as "e7e8q", or MOVE_NONE.
+Move parse_uci_move(Position &pos, const std::string &text);
+
+// Standard algebraic notation as in PGN and EPD ("Nbd7", "exd6", "e8=Q+", "O-O"). Parsing
+// ignores check marks and annotations and accepts over-disambiguated moves; MOVE_NONE if
+// no legal move matches or the text is ambiguous.
+Move parse_san_move(Position &pos, const std::string &text);
+std::string move_to_san(Position &pos, Move move);
+
+// Leaf count of the legal move tree, for movegen validation and benchmarks.
+uint64_t perft(Position &pos, int depth);
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,457 @@
+#include "network.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+
+namespace chess {
+
+static const char NETWORK_MAGIC[4] = { 'C', 'N', 'E', 'T' };
+static const uint32_t NETWORK_VERSION = 3;
+
+static const char *const ACTIVATION_NAMES[ACTIVATION_COUNT] = { "sigmoid", "relu", "clipped_relu", "fast_sigmoid" };
+
+const char *activation_name(Activation activation) {
+	return activation >= 0 && activation < ACTIVATION_COUNT ? ACTIVATION_NAMES[activation] : "unknown";
+}
+
+bool parse_activation(const std::string &name, Activation &activation) {
+	for (int i = 0; i < ACTIVATION_COUNT; i++) {
+		if (name == ACTIVATION_NAMES[i]) {
+			activation = (Activation)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+void softmax(float *values, int count) {
+	if (count <= 0) {
+		return;
+	}
+	float max_value = *std::max_element(values, values + count);
+	float sum = 0.0f;
+	for (int i = 0; i < count; i++) {
+		values[i] = std::exp(values[i] - max_value);
+		sum += values[i];
+	}
+	for (int i = 0; i < count; i++) {
+		values[i] /= sum;
+	}
+}
+
+static std::atomic<uint64_t> next_revision(1);
+
+Network::Network() : policy_outputs(0), revision_id(0) {}
+
+void Network::touch() {
+	revision_id = next_revision.fetch_add(1);
+}
+
+// One switch per layer rather than per neuron.
+void Network::activate(Activation activation, float *values, size_t count) {
+	switch (activation) {
+		case ACTIVATION_SIGMOID:
+			for (size_t i = 0; i < count; i++) {
+				values[i] = 1.0f / (1.0f + std::exp(-values[i]));
+			}
+			break;
+		case ACTIVATION_RELU:
+			for (size_t i = 0; i < count; i++) {
+				values[i] = values[i] > 0.0f ? values[i] : 0.0f;
+			}
+			break;
+		case ACTIVATION_CLIPPED_RELU:
+			for (size_t i = 0; i < count; i++) {
+				values[i] = std::min(std::max(values[i], 0.0f), 1.0f);
+			}
+			break;
+		case ACTIVATION_FAST_SIGMOID:
+			for (size_t i = 0; i < count; i++) {
+				values[i] = 0.5f + 0.5f * values[i] / (1.0f + std::fabs(values[i]));
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+float Network::derivative(Activation activation, float activated_value) {
+	switch (activation) {
+		case ACTIVATION_SIGMOID:
+			return activated_value * (1.0f - activated_value);
+		case ACTIVATION_RELU:
+			return activated_value > 0.0f ? 1.0f : 0.0f;
+		case ACTIVATION_CLIPPED_RELU:
+			return activated_value > 0.0f && activated_value < 1.0f ? 1.0f : 0.0f;
+		case ACTIVATION_FAST_SIGMOID: {
+			// y = 0.5 + 0.5 * s with s = x / (1 + |x|); dy/dx = 0.5 / (1 + |x|)^2 = 0.5 * (1 - |s|)^2.
+			float flat = 1.0f - std::fabs(2.0f * activated_value - 1.0f);
+			return 0.5f * flat * flat;
+		}
+		default:
+			return 0.0f;
+	}
+}
+
+bool Network::set_activation(int layer, Activation activation) {
+	if (layer < 1 || layer >= (int)layer_sizes.size() || activation < 0 || activation >= ACTIVATION_COUNT) {
+		return false;
+	}
+	activations[layer - 1] = activation;
+	touch();
+	return true;
+}
+
+void Network::set_layer_sizes(const std::vector<int> &sizes, uint64_t seed) {
+	layer_sizes.clear();
+	weights.clear();
+	biases.clear();
+	activations.clear();
+	touch();
+	if (sizes.size() < 2) {
+		return;
+	}
+	layer_sizes = sizes;
+	activations.assign(sizes.size() - 1, ACTIVATION_SIGMOID);
+
+	std::mt19937_64 rng(seed);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	for (size_t layer = 1; layer < layer_sizes.size(); layer++) {
+		WeightBuffer layer_weights((size_t)layer_sizes[layer - 1] * layer_sizes[layer]);
+		for (float &w : layer_weights) {
+			w = uniform(rng);
+		}
+		WeightBuffer layer_biases(layer_sizes[layer]);
+		for (float &b : layer_biases) {
+			b = uniform(rng);
+		}
+		weights.push_back(std::move(layer_weights));
+		biases.push_back(std::move(layer_biases));
+	}
+	set_policy_size(policy_outputs);
+}
+
+void Network::set_policy_size(int size) {
+	policy_outputs = std::max(0, size);
+	policy_weights.assign((size_t)policy_outputs * trunk_size(), 0.0f);
+	policy_biases.assign(policy_outputs, 0.0f);
+	touch();
+}
+
+const float *Network::trunk(const Workspace &workspace) const {
+	return workspace.activations[layer_sizes.size() - 2].data();
+}
+
+const float *Network::trunk(const Workspace &workspace, int sample) const {
+	return workspace.batch[layer_sizes.size() - 2].data() + (size_t)sample * trunk_size();
+}
+
+float Network::policy_logit(const float *trunk_values, int index) const {
+	const int size = trunk_size();
+	const float *row = policy_weights.data() + (size_t)index * size;
+	float logit = policy_biases[index];
+	for (int i = 0; i < size; i++) {
+		logit += row[i] * trunk_values[i];
+	}
+	return logit;
+}
+
+void Network::init_workspace(Workspace &workspace) const {
+	workspace.activations.resize(layer_sizes.size());
+	workspace.deltas.resize(layer_sizes.size());
+	for (size_t i = 0; i < layer_sizes.size(); i++) {
+		workspace.activations[i].assign(layer_sizes[i], 0.0f);
+		workspace.deltas[i].assign(layer_sizes[i], 0.0f);
+	}
+}
+
+const float *Network::forward(const float *inputs, Workspace &workspace) const {
+	if (!is_initialized()) {
+		return nullptr;
+	}
+	// Workspaces outlive topology changes (set_layer_sizes, load): rebuild one sized for another
+	// network, even when only a layer's width differs.
+	bool fits = workspace.activations.size() == layer_sizes.size();
+	for (size_t i = 0; fits && i < layer_sizes.size(); i++) {
+		fits = workspace.activations[i].size() == (size_t)layer_sizes[i];
+	}
+	if (!fits) {
+		init_workspace(workspace);
+	}
+
+	std::memcpy(workspace.activations[0].data(), inputs, sizeof(float) * layer_sizes[0]);
+
+	for (size_t layer = 1; layer < layer_sizes.size(); layer++) {
+		const int in_size = layer_sizes[layer - 1];
+		const int out_size = layer_sizes[layer];
+		const float *in = workspace.activations[layer - 1].data();
+		const float *w = weights[layer - 1].data();
+		float *out = workspace.activations[layer].data();
+
+		std::memcpy(out, biases[layer - 1].data(), sizeof(float) * out_size);
+		for (int i = 0; i < in_size; i++) {
+			const float a = in[i];
+			if (a == 0.0f) {
+				continue;
+			}
+			const float *row = w + (size_t)i * out_size;
+			for (int j = 0; j < out_size; j++) {
+				out[j] += a * row[j];
+			}
+		}
+		activate(activations[layer - 1], out, out_size);
+	}
+
+	return workspace.activations.back().data();
+}
+
+const float *Network::forward_batch(const float *inputs, int count, Workspace &workspace) const {
+	if (!is_initialized() || count <= 0) {
+		return nullptr;
+	}
+	workspace.batch.resize(layer_sizes.size());
+	for (size_t i = 0; i < layer_sizes.size(); i++) {
+		workspace.batch[i].resize((size_t)layer_sizes[i] * count);
+	}
+
+	std::memcpy(workspace.batch[0].data(), inputs, sizeof(float) * layer_sizes[0] * count);
+
+	for (size_t layer = 1; layer < layer_sizes.size(); layer++) {
+		const int in_size = layer_sizes[layer - 1];
+		const int out_size = layer_sizes[layer];
+		const float *in = workspace.batch[layer - 1].data();
+		const float *w = weights[layer - 1].data();
+		float *out = workspace.batch[layer].data();
+
+		for (int b = 0; b < count; b++) {
+			std::memcpy(out + (size_t)b * out_size, biases[layer - 1].data(), sizeof(float) * out_size);
+		}
+		for (int i = 0; i < in_size; i++) {
+			const float *row = w + (size_t)i * out_size;
+			for (int b = 0; b < count; b++) {
+				const float a = in[(size_t)b * in_size + i];
+				if (a == 0.0f) {
+					continue;
+				}
+				float *sample_out = out + (size_t)b * out_size;
+				for (int j = 0; j < out_size; j++) {
+					sample_out[j] += a * row[j];
+				}
+			}
+		}
+		activate(activations[layer - 1], out, (size_t)out_size * count);
+	}
+
+	return workspace.batch.back().data();
+}
+
+void Network::train(const float *inputs, const float *targets, float learning_rate, Workspace &workspace,
+		const PolicyTarget *policy) {
+	if (forward(inputs, workspace) == nullptr) {
+		return;
+	}
+	touch();
+
+	// Output layer deltas from error and activation derivative.
+	const size_t last = layer_sizes.size() - 1;
+	for (int j = 0; j < layer_sizes[last]; j++) {
+		float output = workspace.activations[last][j];
+		workspace.deltas[last][j] = (targets[j] - output) * derivative(activations[last - 1], output);
+	}
+
+	// Policy deltas: the cross-entropy gradient of a softmax is target minus probability.
+	const bool with_policy = policy != nullptr && policy->count > 0 && has_policy();
+	const int trunk_count = trunk_size();
+	const float *trunk_values = trunk(workspace);
+	std::vector<float> &policy_delta = workspace.policy;
+	if (with_policy) {
+		policy_delta.resize(policy->count);
+		for (int k = 0; k < policy->count; k++) {
+			policy_delta[k] = policy_logit(trunk_values, policy->indices[k]);
+		}
+		softmax(policy_delta.data(), policy->count);
+		for (int k = 0; k < policy->count; k++) {
+			policy_delta[k] = policy->weight * (policy->probabilities[k] - policy_delta[k]);
+		}
+	}
+
+	// Backpropagate, computing each layer's deltas before its outgoing weights change.
+	for (size_t layer = last; layer >= 1; layer--) {
+		const int in_size = layer_sizes[layer - 1];
+		const int out_size = layer_sizes[layer];
+		const float *delta = workspace.deltas[layer].data();
+		const float *in = workspace.activations[layer - 1].data();
+		float *w = weights[layer - 1].data();
+
+		if (layer > 1) {
+			float *in_delta = workspace.deltas[layer - 1].data();
+			for (int i = 0; i < in_size; i++) {
+				const float *row = w + (size_t)i * out_size;
+				float error_sum = 0.0f;
+				for (int j = 0; j < out_size; j++) {
+					error_sum += delta[j] * row[j];
+				}
+				// The trunk also answers to the policy head.
+				if (with_policy && layer == last) {
+					for (int k = 0; k < policy->count; k++) {
+						error_sum += policy_delta[k] * policy_weights[(size_t)policy->indices[k] * trunk_count + i];
+					}
+				}
+				in_delta[i] = error_sum * derivative(activations[layer - 2], in[i]);
+			}
+		}
+
+		float *b = biases[layer - 1].data();
+		for (int j = 0; j < out_size; j++) {
+			b[j] += learning_rate * delta[j];
+		}
+		for (int i = 0; i < in_size; i++) {
+			const float scale = learning_rate * in[i];
+			if (scale == 0.0f) {
+				continue;
+			}
+			float *row = w + (size_t)i * out_size;
+			for (int j = 0; j < out_size; j++) {
+				row[j] += scale * delta[j];
+			}
+		}
+	}
+
+	// The trunk activations are still those of the forward pass.
+	for (int k = 0; with_policy && k < policy->count; k++) {
+		const float scale = learning_rate * policy_delta[k];
+		float *row = policy_weights.data() + (size_t)policy->indices[k] * trunk_count;
+		for (int i = 0; i < trunk_count; i++) {
+			row[i] += scale * trunk_values[i];
+		}
+		policy_biases[policy->indices[k]] += scale;
+	}
+}
+
+double Network::cost(const float *inputs, const float *targets, Workspace &workspace) const {
+	const float *outputs = forward(inputs, workspace);
+	if (outputs == nullptr) {
+		return 0.0;
+	}
+	double total_squared_error = 0.0;
+	for (int i = 0; i < output_size(); i++) {
+		double diff = (double)targets[i] - outputs[i];
+		total_squared_error += diff * diff;
+	}
+	return 0.5 * total_squared_error;
+}
+
+double Network::policy_cost(const float *inputs, const PolicyTarget &policy, Workspace &workspace) const {
+	if (!has_policy() || policy.count <= 0 || forward(inputs, workspace) == nullptr) {
+		return 0.0;
+	}
+	const float *trunk_values = trunk(workspace);
+	std::vector<float> probabilities(policy.count);
+	for (int k = 0; k < policy.count; k++) {
+		probabilities[k] = policy_logit(trunk_values, policy.indices[k]);
+	}
+	softmax(probabilities.data(), policy.count);
+	double entropy = 0.0;
+	for (int k = 0; k < policy.count; k++) {
+		entropy -= policy.probabilities[k] * std::log(std::max(probabilities[k], 1e-12f));
+	}
+	return entropy;
+}
+
+bool Network::save(const std::string &path) const {
+	std::FILE *file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	uint32_t count = (uint32_t)layer_sizes.size();
+	bool ok = std::fwrite(NETWORK_MAGIC, 1, 4, file) == 4;
+	ok = ok && std::fwrite(&NETWORK_VERSION, sizeof(uint32_t), 1, file) == 1;
+	ok = ok && std::fwrite(&count, sizeof(uint32_t), 1, file) == 1;
+	for (int size : layer_sizes) {
+		uint32_t value = (uint32_t)size;
+		ok = ok && std::fwrite(&value, sizeof(uint32_t), 1, file) == 1;
+	}
+	for (Activation activation : activations) {
+		uint32_t value = (uint32_t)activation;
+		ok = ok && std::fwrite(&value, sizeof(uint32_t), 1, file) == 1;
+	}
+	uint32_t policy_count = (uint32_t)policy_outputs;
+	ok = ok && std::fwrite(&policy_count, sizeof(uint32_t), 1, file) == 1;
+	for (size_t layer = 0; ok && layer < weights.size(); layer++) {
+		ok = std::fwrite(weights[layer].data(), sizeof(float), weights[layer].size(), file) == weights[layer].size();
+		ok = ok && std::fwrite(biases[layer].data(), sizeof(float), biases[layer].size(), file) == biases[layer].size();
+	}
+	ok = ok && std::fwrite(policy_weights.data(), sizeof(float), policy_weights.size(), file) == policy_weights.size();
+	ok = ok && std::fwrite(policy_biases.data(), sizeof(float), policy_biases.size(), file) == policy_biases.size();
+	ok = std::fclose(file) == 0 && ok;
+	return ok;
+}
+
+// Loads into temporaries first so a bad file leaves the current network untouched.
+bool Network::load(const std::string &path) {
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t count = 0;
+	bool ok = std::fread(magic, 1, 4, file) == 4 && std::memcmp(magic, NETWORK_MAGIC, 4) == 0;
+	ok = ok && std::fread(&version, sizeof(uint32_t), 1, file) == 1 && version >= 1 && version <= NETWORK_VERSION;
+	ok = ok && std::fread(&count, sizeof(uint32_t), 1, file) == 1 && count >= 2 && count <= 16;
+
+	std::vector<int> sizes;
+	for (uint32_t i = 0; ok && i < count; i++) {
+		uint32_t value = 0;
+		ok = std::fread(&value, sizeof(uint32_t), 1, file) == 1 && value > 0 && value <= (1u << 16);
+		sizes.push_back((int)value);
+	}
+
+	std::vector<Activation> new_activations(ok ? sizes.size() - 1 : 0, ACTIVATION_SIGMOID);
+	for (size_t i = 0; ok && version >= 2 && i < new_activations.size(); i++) {
+		uint32_t value = 0;
+		ok = std::fread(&value, sizeof(uint32_t), 1, file) == 1 && value < ACTIVATION_COUNT;
+		new_activations[i] = (Activation)value;
+	}
+
+	uint32_t new_policy_outputs = 0;
+	if (ok && version >= 3) {
+		ok = std::fread(&new_policy_outputs, sizeof(uint32_t), 1, file) == 1 && new_policy_outputs <= (1u << 16);
+	}
+
+	std::vector<WeightBuffer> new_weights;
+	std::vector<WeightBuffer> new_biases;
+	for (size_t layer = 1; ok && layer < sizes.size(); layer++) {
+		WeightBuffer layer_weights((size_t)sizes[layer - 1] * sizes[layer]);
+		WeightBuffer layer_biases(sizes[layer]);
+		ok = std::fread(layer_weights.data(), sizeof(float), layer_weights.size(), file) == layer_weights.size();
+		ok = ok && std::fread(layer_biases.data(), sizeof(float), layer_biases.size(), file) == layer_biases.size();
+		new_weights.push_back(std::move(layer_weights));
+		new_biases.push_back(std::move(layer_biases));
+	}
+
+	WeightBuffer new_policy_weights(ok ? (size_t)new_policy_outputs * sizes[sizes.size() - 2] : 0);
+	WeightBuffer new_policy_biases(ok ? new_policy_outputs : 0);
+	ok = ok && std::fread(new_policy_weights.data(), sizeof(float), new_policy_weights.size(), file) == new_policy_weights.size();
+	ok = ok && std::fread(new_policy_biases.data(), sizeof(float), new_policy_biases.size(), file) == new_policy_biases.size();
+	std::fclose(file);
+
+	if (ok) {
+		layer_sizes = sizes;
+		weights = std::move(new_weights);
+		biases = std::move(new_biases);
+		activations = new_activations;
+		policy_outputs = (int)new_policy_outputs;
+		policy_weights = std::move(new_policy_weights);
+		policy_biases = std::move(new_policy_biases);
+		touch();
+	}
+	return ok;
+}
+
+} // namespace chess
@@ -0,0 +1,139 @@
+#ifndef CHESS_CORE_NETWORK_H
+#define CHESS_CORE_NETWORK_H
+
+#include "large_pages.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+// Per-layer activation. Clipped ReLU is min(max(x, 0), 1); the fast sigmoid is the rational
+// 0.5 + 0.5 * x / (1 + |x|), with no exp. The search maps the output layer's value through
+// output_to_score, so that layer should stay in [0, 1] (sigmoid, fast sigmoid or clipped ReLU).
+enum Activation {
+	ACTIVATION_SIGMOID,
+	ACTIVATION_RELU,
+	ACTIVATION_CLIPPED_RELU,
+	ACTIVATION_FAST_SIGMOID,
+	ACTIVATION_COUNT
+};
+
+const char *activation_name(Activation activation);
+bool parse_activation(const std::string &name, Activation &activation);
+
+// Parameter storage; the larger layers get huge pages.
+typedef std::vector<float, LargePageAllocator<float>> WeightBuffer;
+
+// In-place softmax, shifted by the maximum so large logits do not overflow.
+void softmax(float *values, int count);
+
+// Fully-connected network, the Godot-free counterpart of NeuralNet.
+// Parameters are read-only during inference, so one Network can serve many threads,
+// each with its own Workspace.
+// Besides the value output layer the network can have a policy head: a linear layer of
+// logits reading the same trunk (the last hidden layer). Logits are computed one index at a
+// time, so a caller pays only for the moves it asks about.
+class Network {
+public:
+	// Per-thread scratch space for forward and backward passes.
+	struct Workspace {
+		std::vector<std::vector<float>> activations; // [layer][neuron]
+		std::vector<std::vector<float>> deltas;      // [layer][neuron]
+		std::vector<std::vector<float>> batch;       // [layer][sample * size + neuron], forward_batch only
+		std::vector<float> policy;                   // Candidate probabilities, train only
+	};
+
+	// Policy part of a training sample: candidate indices (usually the legal moves) with target
+	// probabilities summing to 1. The loss is the cross-entropy of the softmax over the
+	// candidates, scaled by weight against the value loss.
+	struct PolicyTarget {
+		const int *indices = nullptr;
+		const float *probabilities = nullptr;
+		int count = 0;
+		float weight = 1.0f;
+	};
+
+private:
+	std::vector<int> layer_sizes;
+
+	// weights[layer] is input-major: weights[layer][input * outputs + output].
+	// Each input then adds one contiguous row, and zero inputs (most of a one-hot board) are skipped.
+	std::vector<WeightBuffer> weights;
+	std::vector<WeightBuffer> biases;
+	std::vector<Activation> activations; // [layer - 1], one per non-input layer.
+
+	// Policy head, output-major so one logit is a contiguous dot product with the trunk:
+	// policy_weights[index * trunk_size() + input]. Empty when there is no head.
+	int policy_outputs;
+	WeightBuffer policy_weights;
+	WeightBuffer policy_biases;
+
+	// Identifies the current weights; copies share it, every change takes a fresh one.
+	uint64_t revision_id;
+	void touch();
+
+	static void activate(Activation activation, float *values, size_t count);
+	// Derivative expressed through the activated value, which is what backpropagation keeps.
+	static float derivative(Activation activation, float activated_value);
+
+public:
+	Network();
+
+	// Set the topology and fill weights and biases uniformly in [-1, 1] from seed. Every layer
+	// starts with the sigmoid activation. A policy head keeps its size but restarts at zero.
+	void set_layer_sizes(const std::vector<int> &sizes, uint64_t seed);
+
+	// Add (or with 0 remove) a policy head of size logits. It starts at zero, a uniform policy,
+	// so an untrained head changes nothing for its users.
+	void set_policy_size(int size);
+	int policy_size() const { return policy_outputs; }
+	bool has_policy() const { return policy_outputs > 0 && is_initialized(); }
+	int trunk_size() const { return is_initialized() ? layer_sizes[layer_sizes.size() - 2] : 0; }
+
+	// The trunk the policy head reads, after forward (or sample of forward_batch) on workspace.
+	const float *trunk(const Workspace &workspace) const;
+	const float *trunk(const Workspace &workspace, int sample) const;
+	float policy_logit(const float *trunk_values, int index) const;
+
+	// Activation of layer 1..size-1 (the input layer has none); false for a bad layer index.
+	bool set_activation(int layer, Activation activation);
+	Activation get_activation(int layer) const { return activations[layer - 1]; }
+	const std::vector<Activation> &get_activations() const { return activations; }
+	const std::vector<int> &get_layer_sizes() const { return layer_sizes; }
+	bool is_initialized() const { return layer_sizes.size() >= 2; }
+	int input_size() const { return is_initialized() ? layer_sizes.front() : 0; }
+	int output_size() const { return is_initialized() ? layer_sizes.back() : 0; }
+	uint64_t revision() const { return revision_id; }
+
+	void init_workspace(Workspace &workspace) const;
+
+	// Forward pass over input_size() inputs; returns the output layer inside workspace.
+	const float *forward(const float *inputs, Workspace &workspace) const;
+
+	// Forward pass over count samples stored back to back; returns count * output_size() outputs.
+	// Each weight row is applied to the whole batch while it is in cache.
+	const float *forward_batch(const float *inputs, int count, Workspace &workspace) const;
+
+	// One backpropagation / gradient-descent step on a single sample (same rule as NeuralNet::train).
+	// With a policy target (and a policy head) both losses train the shared trunk.
+	void train(const float *inputs, const float *targets, float learning_rate, Workspace &workspace,
+			const PolicyTarget *policy = nullptr);
+
+	// Half squared error for one sample.
+	double cost(const float *inputs, const float *targets, Workspace &workspace) const;
+
+	// Policy cross-entropy for one sample; 0 without a policy head.
+	double policy_cost(const float *inputs, const PolicyTarget &policy, Workspace &workspace) const;
+
+	// Binary model file: "CNET", version, layer count, sizes, one activation id per non-input
+	// layer (version 2; version 1 files load as all-sigmoid), the policy size (version 3), then
+	// per layer weights and biases, then the policy weights and biases.
+	bool save(const std::string &path) const;
+	bool load(const std::string &path);
+};
+
+} // namespace chess
+
+#endif
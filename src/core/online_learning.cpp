@@ -0,0 +1,235 @@
+#include "online_learning.h"
+#include "evaluate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace chess {
+
+namespace {
+
+// Run the calling thread only on time no other thread of the machine wants. On Linux the nice
+// value is per thread; elsewhere the thread keeps normal priority and relies on yielding.
+void lower_thread_priority() {
+#if defined(_WIN32)
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+#elif defined(__linux__)
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+}
+
+// One-hot inputs of a record, as encode_position builds them from a Position.
+void encode_record(const PackedPosition &record, float *inputs) {
+	int pieces[64];
+	unpack_position(record, pieces);
+	std::fill(inputs, inputs + NETWORK_INPUTS, 0.0f);
+	for (int square = 0; square < 64; square++) {
+		if (pieces[square] >= 0) {
+			inputs[square * 12 + pieces[square]] = 1.0f;
+		}
+	}
+}
+
+} // namespace
+
+OnlineLearner::OnlineLearner() :
+		next_slot(0), positions_added(0), games(0), stopping(false), running(false), batches(0), samples(0),
+		checkpoints(0), applied(0), last_loss(0.0) {
+}
+
+OnlineLearner::~OnlineLearner() {
+	stop();
+}
+
+bool OnlineLearner::start(const Network &live, const OnlineLearningConfig &learning_config) {
+	stop();
+	if (live.input_size() != NETWORK_INPUTS || live.output_size() < 1) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(buffer_mutex);
+	config = learning_config;
+	config.capacity = std::max<size_t>(config.capacity, 1);
+	// A buffer that never fills up to the threshold would never train.
+	config.min_positions = std::min(config.min_positions, config.capacity);
+	config.batch_size = std::max(config.batch_size, 1);
+	config.checkpoint_batches = std::max(config.checkpoint_batches, 1);
+	config.result_weight = std::min(std::max(config.result_weight, 0.0f), 1.0f);
+	// Keep the newest records when the buffer shrinks.
+	if (buffer.size() > config.capacity) {
+		std::vector<PackedPosition> newest;
+		newest.reserve(config.capacity);
+		size_t oldest = next_slot % buffer.size();
+		for (size_t i = buffer.size() - config.capacity; i < buffer.size(); i++) {
+			newest.push_back(buffer[(oldest + i) % buffer.size()]);
+		}
+		buffer.swap(newest);
+	}
+	next_slot = buffer.size() % config.capacity;
+
+	shadow = live;
+	{
+		std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex);
+		checkpoint.reset();
+	}
+	stopping = false;
+	running = true;
+	trainer = std::thread(&OnlineLearner::train_loop, this);
+	return true;
+}
+
+void OnlineLearner::stop() {
+	{
+		std::lock_guard<std::mutex> lock(buffer_mutex);
+		stopping = true;
+	}
+	buffer_changed.notify_all();
+	if (trainer.joinable()) {
+		trainer.join();
+	}
+	running = false;
+}
+
+void OnlineLearner::add_game(const std::vector<PackedPosition> &records) {
+	if (records.empty()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(buffer_mutex);
+		for (const PackedPosition &record : records) {
+			if (buffer.size() < config.capacity) {
+				buffer.push_back(record);
+			} else {
+				buffer[next_slot] = record;
+			}
+			next_slot = (next_slot + 1) % config.capacity;
+		}
+		positions_added += (int64_t)records.size();
+		games++;
+	}
+	buffer_changed.notify_all();
+}
+
+void OnlineLearner::clear_buffer() {
+	std::lock_guard<std::mutex> lock(buffer_mutex);
+	buffer.clear();
+	next_slot = 0;
+}
+
+// The network rates the side that just moved, the record the side to move: both the result and
+// the score (through the logistic curve output_to_score inverts) are flipped.
+float OnlineLearner::target_of(const PackedPosition &record) const {
+	float result_target = 0.5f - 0.5f * record.result;
+	float score_target = (float)(1.0 / (1.0 + std::pow(10.0, record.score / 400.0)));
+	return config.result_weight * result_target + (1.0f - config.result_weight) * score_target;
+}
+
+void OnlineLearner::train_loop() {
+	lower_thread_priority();
+
+	std::mt19937_64 rng(config.seed);
+	Network::Workspace workspace;
+	shadow.init_workspace(workspace);
+	std::vector<PackedPosition> batch(config.batch_size);
+	std::vector<float> inputs(NETWORK_INPUTS);
+	std::vector<float> targets(shadow.output_size(), 0.0f);
+	double loss_sum = 0.0;
+	int64_t loss_count = 0;
+	int since_checkpoint = 0;
+
+	while (true) {
+		// Draw a batch under the lock, train outside it so add_game never waits on training.
+		{
+			std::unique_lock<std::mutex> lock(buffer_mutex);
+			buffer_changed.wait(lock, [&] {
+				return stopping.load() || (buffer.size() >= config.min_positions && !buffer.empty() &&
+						samples.load() < positions_added * (int64_t)config.replay_ratio);
+			});
+			if (stopping) {
+				break;
+			}
+			std::uniform_int_distribution<size_t> pick(0, buffer.size() - 1);
+			for (PackedPosition &record : batch) {
+				record = buffer[pick(rng)];
+			}
+		}
+
+		for (const PackedPosition &record : batch) {
+			encode_record(record, inputs.data());
+			targets[0] = target_of(record);
+			shadow.train(inputs.data(), targets.data(), config.learning_rate, workspace);
+			// The workspace still holds the forward pass before the update.
+			double diff = targets[0] - workspace.activations.back()[0];
+			loss_sum += 0.5 * diff * diff;
+			loss_count++;
+		}
+		samples += (int64_t)batch.size();
+		batches++;
+
+		if (++since_checkpoint >= config.checkpoint_batches) {
+			// The copy is made here; publishing it is a pointer move, replacing an unapplied one.
+			std::unique_ptr<Network> published(new Network(shadow));
+			{
+				std::lock_guard<std::mutex> lock(checkpoint_mutex);
+				checkpoint.swap(published);
+			}
+			last_loss = loss_count > 0 ? loss_sum / loss_count : 0.0;
+			loss_sum = 0.0;
+			loss_count = 0;
+			since_checkpoint = 0;
+			checkpoints++;
+		}
+		std::this_thread::yield();
+	}
+}
+
+bool OnlineLearner::apply_checkpoint(Network &live) {
+	std::unique_ptr<Network> newest;
+	{
+		std::unique_lock<std::mutex> lock(checkpoint_mutex, std::try_to_lock);
+		if (!lock.owns_lock() || !checkpoint) {
+			return false;
+		}
+		newest.swap(checkpoint);
+	}
+	// Someone loaded another model into live meanwhile: the checkpoint no longer fits it.
+	if (newest->get_layer_sizes() != live.get_layer_sizes() || newest->policy_size() != live.policy_size()) {
+		return false;
+	}
+	live = std::move(*newest);
+	applied++;
+	return true;
+}
+
+bool OnlineLearner::has_checkpoint() const {
+	std::lock_guard<std::mutex> lock(checkpoint_mutex);
+	return checkpoint != nullptr;
+}
+
+OnlineLearningStats OnlineLearner::get_stats() const {
+	OnlineLearningStats stats;
+	{
+		std::lock_guard<std::mutex> lock(buffer_mutex);
+		stats.games = games;
+		stats.positions_added = positions_added;
+		stats.buffer_size = (int64_t)buffer.size();
+	}
+	stats.batches = batches;
+	stats.samples = samples;
+	stats.checkpoints = checkpoints;
+	stats.applied = applied;
+	stats.loss = last_loss;
+	return stats;
+}
+
+} // namespace chess
@@ -0,0 +1,106 @@
+#ifndef CHESS_CORE_ONLINE_LEARNING_H
+#define CHESS_CORE_ONLINE_LEARNING_H
+
+#include "network.h"
+#include "training_data.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+struct OnlineLearningConfig {
+	size_t capacity = 100000;      // Replay buffer size in positions; the oldest are overwritten.
+	size_t min_positions = 256;    // No training before the buffer holds this many (at most capacity).
+	int batch_size = 64;           // Samples drawn (uniformly, with replacement) per mini-batch.
+	float learning_rate = 0.01f;
+	float result_weight = 0.5f;    // Target = this much game result + the rest search score.
+	int checkpoint_batches = 100;  // Mini-batches between checkpoints offered to the live network.
+	int replay_ratio = 8;          // Training stops at this many samples per position added, so a
+	                               // small buffer is not overfitted while no new games come in.
+	uint32_t seed = 1;
+};
+
+struct OnlineLearningStats {
+	int64_t games = 0;
+	int64_t positions_added = 0;
+	int64_t buffer_size = 0;
+	int64_t batches = 0;
+	int64_t samples = 0;
+	int64_t checkpoints = 0;       // Published by the training thread...
+	int64_t applied = 0;           // ...and swapped into the live network.
+	double loss = 0.0;             // Mean half squared error of the last checkpoint's batches.
+};
+
+// Learning from finished games while they are being played. Labelled positions go into a
+// bounded replay buffer; a background thread at the lowest scheduling priority trains a shadow
+// copy of the weights on mini-batches from it and regularly publishes a copy of the shadow as a
+// checkpoint. The owner of the live network swaps the newest checkpoint in with
+// apply_checkpoint at a moment when no search reads it: the swap moves buffers, never waits for
+// the training thread, and a search always sees one consistent set of weights (whose new
+// revision also clears the evaluation caches and the MCTS tree).
+// Only the value output is trained; the policy head keeps its weights.
+class OnlineLearner {
+private:
+	OnlineLearningConfig config;
+
+	// Replay buffer, a ring of at most config.capacity records.
+	mutable std::mutex buffer_mutex;
+	std::condition_variable buffer_changed;
+	std::vector<PackedPosition> buffer;
+	size_t next_slot;
+	int64_t positions_added;
+	int64_t games;
+
+	// Newest checkpoint not yet applied; held only for a pointer move on either side.
+	mutable std::mutex checkpoint_mutex;
+	std::unique_ptr<Network> checkpoint;
+
+	// Shadow weights, owned by the training thread while it runs.
+	Network shadow;
+	std::thread trainer;
+	std::atomic<bool> stopping;
+	std::atomic<bool> running;
+	std::atomic<int64_t> batches;
+	std::atomic<int64_t> samples;
+	std::atomic<int64_t> checkpoints;
+	std::atomic<int64_t> applied;
+	std::atomic<double> last_loss;
+
+	void train_loop();
+	float target_of(const PackedPosition &record) const;
+
+public:
+	OnlineLearner();
+	~OnlineLearner();
+	OnlineLearner(const OnlineLearner &) = delete;
+	OnlineLearner &operator=(const OnlineLearner &) = delete;
+
+	// Copy live's weights into the shadow and start training; a running learner is stopped first,
+	// keeping its buffer. False if live has no value output to train.
+	bool start(const Network &live, const OnlineLearningConfig &learning_config);
+	// Stops the thread; an unapplied checkpoint is kept.
+	void stop();
+	bool is_running() const { return running.load(); }
+	const OnlineLearningConfig &get_config() const { return config; }
+
+	// Add one finished game's records, their result fields already set.
+	void add_game(const std::vector<PackedPosition> &records);
+	void clear_buffer();
+
+	// Replace live with the newest checkpoint, if there is one with the same topology. Only call
+	// while nothing reads live. Returns false at once if the trainer is publishing right now.
+	bool apply_checkpoint(Network &live);
+	bool has_checkpoint() const;
+
+	OnlineLearningStats get_stats() const;
+};
+
+} // namespace chess
+
+#endif
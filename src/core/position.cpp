@@ -0,0 +1,551 @@
+#include "position.h"
+#include "bitboard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace chess {
+
+// Zobrist keys from a fixed-seed generator so hashes are reproducible across runs and builds.
+static uint64_t PIECE_KEYS[12][64];
+static uint64_t CASTLING_KEYS[16];
+static uint64_t EN_PASSANT_KEYS[8];
+static uint64_t SIDE_KEY;
+
+// Rights that survive a move touching each square (king and rook home squares clear theirs).
+static int CASTLING_MASK[64];
+
+static uint64_t splitmix64(uint64_t &state) {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static void init_keys() {
+	uint64_t state = 0x43484553534149ULL;
+	for (int piece = 0; piece < 12; piece++) {
+		for (int square = 0; square < 64; square++) {
+			PIECE_KEYS[piece][square] = splitmix64(state);
+		}
+	}
+	for (int i = 0; i < 16; i++) {
+		CASTLING_KEYS[i] = i == 0 ? 0 : splitmix64(state);
+	}
+	for (int i = 0; i < 8; i++) {
+		EN_PASSANT_KEYS[i] = splitmix64(state);
+	}
+	SIDE_KEY = splitmix64(state);
+
+	for (int square = 0; square < 64; square++) {
+		CASTLING_MASK[square] = ALL_CASTLING;
+	}
+	CASTLING_MASK[make_square(4, 7)] &= ~(WHITE_OO | WHITE_OOO);
+	CASTLING_MASK[make_square(7, 7)] &= ~WHITE_OO;
+	CASTLING_MASK[make_square(0, 7)] &= ~WHITE_OOO;
+	CASTLING_MASK[make_square(4, 0)] &= ~(BLACK_OO | BLACK_OOO);
+	CASTLING_MASK[make_square(7, 0)] &= ~BLACK_OO;
+	CASTLING_MASK[make_square(0, 0)] &= ~BLACK_OOO;
+}
+
+static struct KeyInitializer {
+	KeyInitializer() { init_keys(); }
+} key_initializer;
+
+Position::Position() {
+	clear();
+}
+
+void Position::clear() {
+	for (int square = 0; square < 64; square++) {
+		board[square] = NO_PIECE;
+	}
+	std::memset(by_piece, 0, sizeof(by_piece));
+	std::memset(by_color, 0, sizeof(by_color));
+	turn = WHITE;
+	castling = 0;
+	en_passant = NO_SQUARE;
+	halfmove_clock = 0;
+	fullmove_number = 1;
+	hash_key = 0;
+	pawn_hash_key = 0;
+	psq_score = PhaseScore();
+	phase = 0;
+	history.clear();
+	history.reserve(HISTORY_RESERVE);
+}
+
+void Position::add_piece(Piece piece, Square square) {
+	board[square] = piece;
+	by_piece[piece] |= square_bb(square);
+	by_color[color_of(piece)] |= square_bb(square);
+	psq_score += PSQ[piece][square];
+	phase += PHASE_WEIGHT[type_of(piece)];
+	if (type_of(piece) == PAWN) {
+		pawn_hash_key ^= PIECE_KEYS[piece][square];
+	}
+}
+
+void Position::remove_piece(Square square) {
+	Piece piece = board[square];
+	board[square] = NO_PIECE;
+	by_piece[piece] &= ~square_bb(square);
+	by_color[color_of(piece)] &= ~square_bb(square);
+	psq_score -= PSQ[piece][square];
+	phase -= PHASE_WEIGHT[type_of(piece)];
+	if (type_of(piece) == PAWN) {
+		pawn_hash_key ^= PIECE_KEYS[piece][square];
+	}
+}
+
+void Position::move_piece(Square from, Square to) {
+	Piece piece = board[from];
+	Bitboard from_to = square_bb(from) | square_bb(to);
+	board[from] = NO_PIECE;
+	board[to] = piece;
+	by_piece[piece] ^= from_to;
+	by_color[color_of(piece)] ^= from_to;
+	psq_score += PSQ[piece][to] - PSQ[piece][from];
+	if (type_of(piece) == PAWN) {
+		pawn_hash_key ^= PIECE_KEYS[piece][from] ^ PIECE_KEYS[piece][to];
+	}
+}
+
+void Position::put_piece(Piece piece, Square square) {
+	if (board[square] != NO_PIECE) {
+		remove_piece(square);
+	}
+	if (piece != NO_PIECE) {
+		add_piece(piece, square);
+	}
+}
+
+void Position::set_side_to_move(int color) {
+	turn = color;
+}
+
+void Position::set_castling_rights(int rights) {
+	castling = rights & ALL_CASTLING;
+}
+
+void Position::set_en_passant(Square square) {
+	en_passant = square;
+}
+
+void Position::set_halfmove_clock(int clock) {
+	halfmove_clock = clock;
+}
+
+// Recompute the hash from scratch after direct edits.
+void Position::refresh_key() {
+	hash_key = 0;
+	for (int square = 0; square < 64; square++) {
+		if (board[square] != NO_PIECE) {
+			hash_key ^= PIECE_KEYS[board[square]][square];
+		}
+	}
+	hash_key ^= CASTLING_KEYS[castling];
+	hash_key ^= en_passant_key();
+	if (turn == BLACK) {
+		hash_key ^= SIDE_KEY;
+	}
+}
+
+// The en passant file only counts when a pawn of the side to move could take, so the same
+// position after a single or a double push hashes (and repeats) alike.
+uint64_t Position::en_passant_key() const {
+	if (en_passant == NO_SQUARE || !(PAWN_ATTACKS[1 - turn][en_passant] & pieces(turn, PAWN))) {
+		return 0;
+	}
+	return EN_PASSANT_KEYS[file_of(en_passant)];
+}
+
+void Position::set_start_position() {
+	set_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+// Parse the first six FEN fields; clocks are optional. Returns false on malformed placement.
+bool Position::set_fen(const std::string &fen) {
+	clear();
+	std::istringstream stream(fen);
+	std::string placement, side, rights, ep;
+	stream >> placement >> side >> rights >> ep;
+
+	int x = 0;
+	int y = 0;
+	for (char c : placement) {
+		if (c == '/') {
+			x = 0;
+			y++;
+		} else if (c >= '1' && c <= '8') {
+			x += c - '0';
+		} else {
+			const char *letters = "prnbqk";
+			const char *found = std::strchr(letters, c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+			if (found == nullptr || *found == '\0' || x > 7 || y > 7) {
+				clear();
+				return false;
+			}
+			int color = (c >= 'A' && c <= 'Z') ? WHITE : BLACK;
+			add_piece(make_piece(color, (int)(found - letters)), make_square(x, y));
+			x++;
+		}
+	}
+
+	turn = (side == "b") ? BLACK : WHITE;
+	for (char c : rights) {
+		switch (c) {
+			case 'K': castling |= WHITE_OO; break;
+			case 'Q': castling |= WHITE_OOO; break;
+			case 'k': castling |= BLACK_OO; break;
+			case 'q': castling |= BLACK_OOO; break;
+			default: break;
+		}
+	}
+	if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8') {
+		en_passant = make_square(ep[0] - 'a', '8' - ep[1]);
+	}
+	if (!(stream >> halfmove_clock)) {
+		halfmove_clock = 0;
+	}
+	if (!(stream >> fullmove_number)) {
+		fullmove_number = 1;
+	}
+
+	refresh_key();
+	return pieces(WHITE, KING) != 0 && pieces(BLACK, KING) != 0;
+}
+
+std::string Position::get_fen() const {
+	const char *letters = "PRNBQKprnbqk";
+	std::string fen;
+	for (int y = 0; y < 8; y++) {
+		int empty = 0;
+		for (int x = 0; x < 8; x++) {
+			Piece piece = board[make_square(x, y)];
+			if (piece == NO_PIECE) {
+				empty++;
+				continue;
+			}
+			if (empty > 0) {
+				fen += (char)('0' + empty);
+				empty = 0;
+			}
+			fen += letters[piece];
+		}
+		if (empty > 0) {
+			fen += (char)('0' + empty);
+		}
+		if (y < 7) {
+			fen += '/';
+		}
+	}
+
+	fen += turn == WHITE ? " w " : " b ";
+	if (castling == 0) {
+		fen += '-';
+	}
+	if (castling & WHITE_OO) fen += 'K';
+	if (castling & WHITE_OOO) fen += 'Q';
+	if (castling & BLACK_OO) fen += 'k';
+	if (castling & BLACK_OOO) fen += 'q';
+	fen += ' ';
+	fen += en_passant == NO_SQUARE ? "-" : square_to_string(en_passant);
+	fen += " " + std::to_string(halfmove_clock) + " " + std::to_string(fullmove_number);
+	return fen;
+}
+
+Square Position::king_square(int color) const {
+	Bitboard kings = pieces(color, KING);
+	return kings ? lsb(kings) : NO_SQUARE;
+}
+
+// Attack test from the target square outwards, one piece kind at a time.
+bool Position::is_square_attacked(Square square, int by) const {
+	if (square == NO_SQUARE) {
+		return false;
+	}
+	// A pawn of `by` attacks square exactly when an enemy pawn on square would attack it.
+	if (PAWN_ATTACKS[1 - by][square] & pieces(by, PAWN)) {
+		return true;
+	}
+	if (KNIGHT_ATTACKS[square] & pieces(by, KNIGHT)) {
+		return true;
+	}
+	if (KING_ATTACKS[square] & pieces(by, KING)) {
+		return true;
+	}
+	Bitboard occ = occupied();
+	Bitboard queens = pieces(by, QUEEN);
+	if (rook_attacks(square, occ) & (pieces(by, ROOK) | queens)) {
+		return true;
+	}
+	return (bishop_attacks(square, occ) & (pieces(by, BISHOP) | queens)) != 0;
+}
+
+Bitboard Position::attackers_to(Square square, Bitboard occ) const {
+	Bitboard rooks = pieces(WHITE, ROOK) | pieces(BLACK, ROOK) | pieces(WHITE, QUEEN) | pieces(BLACK, QUEEN);
+	Bitboard bishops = pieces(WHITE, BISHOP) | pieces(BLACK, BISHOP) | pieces(WHITE, QUEEN) | pieces(BLACK, QUEEN);
+	return (PAWN_ATTACKS[BLACK][square] & pieces(WHITE, PAWN)) | (PAWN_ATTACKS[WHITE][square] & pieces(BLACK, PAWN)) |
+			(KNIGHT_ATTACKS[square] & (pieces(WHITE, KNIGHT) | pieces(BLACK, KNIGHT))) |
+			(KING_ATTACKS[square] & (pieces(WHITE, KING) | pieces(BLACK, KING))) |
+			(rook_attacks(square, occ) & rooks) | (bishop_attacks(square, occ) & bishops);
+}
+
+// Swap-list SEE: each side recaptures with its least valuable attacker and may stop when behind.
+int Position::see(Move move) const {
+	static const int values[6] = { 100, 500, 320, 330, 900, 20000 };
+	Square from = move_from(move);
+	Square to = move_to(move);
+	Piece mover = board[from];
+	if (mover == NO_PIECE) {
+		return 0;
+	}
+
+	int gain[32];
+	int depth = 0;
+	Bitboard occ = occupied() ^ square_bb(from);
+	gain[0] = 0;
+	if (board[to] != NO_PIECE) {
+		gain[0] = values[type_of(board[to])];
+	} else if (type_of(mover) == PAWN && to == en_passant) {
+		gain[0] = values[PAWN];
+		occ ^= square_bb(to + (color_of(mover) == WHITE ? 8 : -8));
+	}
+	if (move_promotion(move) != 0) {
+		gain[0] += values[move_promotion(move)] - values[PAWN];
+	}
+
+	int on_square = move_promotion(move) != 0 ? move_promotion(move) : type_of(mover);
+	int side = 1 - color_of(mover);
+	Bitboard attackers = attackers_to(to, occ) & occ;
+
+	while (depth < 31) {
+		Bitboard ours = attackers & by_color[side];
+		if (!ours) {
+			break;
+		}
+		// Least valuable attacker, in value order P, N, B, R, Q, K.
+		static const int order[6] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+		int type = KING;
+		Bitboard candidates = 0;
+		for (int t : order) {
+			candidates = ours & by_piece[make_piece(side, t)];
+			if (candidates) {
+				type = t;
+				break;
+			}
+		}
+		depth++;
+		gain[depth] = values[on_square] - gain[depth - 1];
+		// A king may only recapture when nothing else defends the square.
+		if (type == KING && (attackers & by_color[1 - side] & occ)) {
+			depth--;
+			break;
+		}
+		occ ^= square_bb(lsb(candidates));
+		attackers = attackers_to(to, occ) & occ;
+		on_square = type;
+		side = 1 - side;
+	}
+
+	while (depth > 0) {
+		gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+		depth--;
+	}
+	return gain[0];
+}
+
+bool Position::is_capture(Move move) const {
+	Square to = move_to(move);
+	if (board[to] != NO_PIECE) {
+		return true;
+	}
+	Piece piece = board[move_from(move)];
+	return to == en_passant && piece != NO_PIECE && type_of(piece) == PAWN;
+}
+
+void Position::make_move(Move move, UndoInfo &undo) {
+	history.push_back(hash_key);
+	Square from = move_from(move);
+	Square to = move_to(move);
+	int promotion = move_promotion(move);
+	Piece piece = board[from];
+	int us = turn;
+
+	undo.captured = board[to];
+	undo.castling = castling;
+	undo.en_passant = en_passant;
+	undo.halfmove_clock = halfmove_clock;
+	undo.key = hash_key;
+
+	hash_key ^= en_passant_key();
+	en_passant = NO_SQUARE;
+	halfmove_clock++;
+
+	if (undo.captured != NO_PIECE) {
+		hash_key ^= PIECE_KEYS[undo.captured][to];
+		remove_piece(to);
+		halfmove_clock = 0;
+	}
+
+	if (type_of(piece) == PAWN) {
+		halfmove_clock = 0;
+		if (to == undo.en_passant) {
+			// En passant: the captured pawn sits behind the target square.
+			Square captured_square = to + (us == WHITE ? 8 : -8);
+			undo.captured = board[captured_square];
+			hash_key ^= PIECE_KEYS[undo.captured][captured_square];
+			remove_piece(captured_square);
+		} else if (to - from == 16 || from - to == 16) {
+			en_passant = (from + to) / 2;
+		}
+	}
+
+	hash_key ^= PIECE_KEYS[piece][from] ^ PIECE_KEYS[piece][to];
+	move_piece(from, to);
+
+	if (promotion != 0) {
+		Piece promoted = make_piece(us, promotion);
+		hash_key ^= PIECE_KEYS[piece][to] ^ PIECE_KEYS[promoted][to];
+		remove_piece(to);
+		add_piece(promoted, to);
+	}
+
+	// Castling: the king moved two files, bring the rook across.
+	if (type_of(piece) == KING && (to - from == 2 || from - to == 2)) {
+		Square rook_from = to > from ? to + 1 : to - 2;
+		Square rook_to = to > from ? to - 1 : to + 1;
+		Piece rook = board[rook_from];
+		hash_key ^= PIECE_KEYS[rook][rook_from] ^ PIECE_KEYS[rook][rook_to];
+		move_piece(rook_from, rook_to);
+	}
+
+	hash_key ^= CASTLING_KEYS[castling];
+	castling &= CASTLING_MASK[from] & CASTLING_MASK[to];
+	hash_key ^= CASTLING_KEYS[castling];
+
+	if (us == BLACK) {
+		fullmove_number++;
+	}
+	turn = 1 - us;
+	hash_key ^= SIDE_KEY ^ en_passant_key();
+}
+
+void Position::unmake_move(Move move, const UndoInfo &undo) {
+	Square from = move_from(move);
+	Square to = move_to(move);
+	turn = 1 - turn;
+	int us = turn;
+
+	if (move_promotion(move) != 0) {
+		remove_piece(to);
+		add_piece(make_piece(us, PAWN), to);
+	}
+	Piece piece = board[to];
+	move_piece(to, from);
+
+	if (type_of(piece) == KING && (to - from == 2 || from - to == 2)) {
+		Square rook_from = to > from ? to + 1 : to - 2;
+		Square rook_to = to > from ? to - 1 : to + 1;
+		move_piece(rook_to, rook_from);
+	}
+
+	if (undo.captured != NO_PIECE) {
+		if (type_of(piece) == PAWN && to == undo.en_passant) {
+			add_piece(undo.captured, to + (us == WHITE ? 8 : -8));
+		} else {
+			add_piece(undo.captured, to);
+		}
+	}
+
+	if (us == BLACK) {
+		fullmove_number--;
+	}
+	castling = undo.castling;
+	en_passant = undo.en_passant;
+	halfmove_clock = undo.halfmove_clock;
+	hash_key = undo.key;
+	history.pop_back();
+}
+
+// Pass the turn without moving (null-move pruning); not legal when in check.
+void Position::make_null_move(UndoInfo &undo) {
+	history.push_back(hash_key);
+	undo.captured = NO_PIECE;
+	undo.castling = castling;
+	undo.en_passant = en_passant;
+	undo.halfmove_clock = halfmove_clock;
+	undo.key = hash_key;
+
+	hash_key ^= en_passant_key();
+	en_passant = NO_SQUARE;
+	// Positions before a null move cannot repeat after it; resetting the clock (restored on
+	// unmake) keeps the repetition scan from crossing it.
+	halfmove_clock = 0;
+	turn = 1 - turn;
+	hash_key ^= SIDE_KEY;
+}
+
+void Position::unmake_null_move(const UndoInfo &undo) {
+	turn = 1 - turn;
+	en_passant = undo.en_passant;
+	halfmove_clock = undo.halfmove_clock;
+	hash_key = undo.key;
+	history.pop_back();
+}
+
+// Only positions since the last capture or pawn move can repeat, and only every other ply
+// with the same side to move; four plies back is the earliest possible repetition.
+int Position::repetition_count() const {
+	int count = 0;
+	int size = (int)history.size();
+	int window = std::min(halfmove_clock, size);
+	for (int back = 4; back <= window; back += 2) {
+		if (history[size - back] == hash_key) {
+			count++;
+		}
+	}
+	return count;
+}
+
+// Bare kings, a single minor piece, or bishops all on squares of one colour.
+bool Position::has_insufficient_material() const {
+	Bitboard heavy = 0;
+	Bitboard knights = 0;
+	Bitboard bishops = 0;
+	for (int color = 0; color < 2; color++) {
+		heavy |= pieces(color, PAWN) | pieces(color, ROOK) | pieces(color, QUEEN);
+		knights |= pieces(color, KNIGHT);
+		bishops |= pieces(color, BISHOP);
+	}
+	if (heavy != 0) {
+		return false;
+	}
+	if (popcount(knights | bishops) <= 1) {
+		return true;
+	}
+	const Bitboard DARK_SQUARES = 0x55AA55AA55AA55AAULL;
+	return knights == 0 && ((bishops & DARK_SQUARES) == 0 || (bishops & ~DARK_SQUARES) == 0);
+}
+
+std::string square_to_string(Square square) {
+	std::string s;
+	s += (char)('a' + file_of(square));
+	s += (char)('8' - row_of(square));
+	return s;
+}
+
+std::string move_to_uci(Move move) {
+	if (move == MOVE_NONE || move == MOVE_NULL) {
+		return "0000";
+	}
+	std::string s = square_to_string(move_from(move)) + square_to_string(move_to(move));
+	if (move_promotion(move) != 0) {
+		s += "prnbqk"[move_promotion(move)];
+	}
+	return s;
+}
+
+} // namespace chess
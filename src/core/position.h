@@ -0,0 +1,116 @@
+#ifndef CHESS_CORE_POSITION_H
+#define CHESS_CORE_POSITION_H
+
+#include "psqt.h"
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+namespace chess {
+
+// State that make_move overwrites and unmake_move needs back.
+struct UndoInfo {
+	Piece captured;
+	int castling;
+	Square en_passant;
+	int halfmove_clock;
+	uint64_t key;
+};
+
+// Board state with incremental Zobrist hashing; plain value type, safe to copy per thread.
+class Position {
+private:
+	Piece board[64];
+	Bitboard by_piece[12];
+	Bitboard by_color[2];
+
+	int turn;
+	int castling;
+	Square en_passant;
+	int halfmove_clock;
+	int fullmove_number;
+	uint64_t hash_key;
+
+	// Kept up to date by add/remove/move_piece, so make and unmake both maintain them.
+	uint64_t pawn_hash_key;     // Zobrist key of the pawns alone.
+	PhaseScore psq_score;       // Sum of PSQ over the board, White positive.
+	int phase;                  // Sum of PHASE_WEIGHT over the board.
+
+	// Keys of the positions before each move made since the last set-up, for repetition checks.
+	std::vector<uint64_t> history;
+	static const int HISTORY_RESERVE = 512;
+
+	void add_piece(Piece piece, Square square);
+	void remove_piece(Square square);
+	void move_piece(Square from, Square to);
+	uint64_t en_passant_key() const;
+
+public:
+	Position();
+
+	// Empty board, white to move; fill with put_piece and finish with refresh_key.
+	void clear();
+	void put_piece(Piece piece, Square square);
+	void set_side_to_move(int color);
+	void set_castling_rights(int rights);
+	void set_en_passant(Square square);
+	void set_halfmove_clock(int clock);
+	void refresh_key();
+
+	void set_start_position();
+	bool set_fen(const std::string &fen);
+	std::string get_fen() const;
+
+	Piece piece_on(Square square) const { return board[square]; }
+	int side_to_move() const { return turn; }
+	int castling_rights() const { return castling; }
+	Square en_passant_square() const { return en_passant; }
+	int get_halfmove_clock() const { return halfmove_clock; }
+	int get_fullmove_number() const { return fullmove_number; }
+	uint64_t key() const { return hash_key; }
+	uint64_t pawn_key() const { return pawn_hash_key; }
+	const PhaseScore &psq() const { return psq_score; }
+	int game_phase() const { return phase; }
+
+	Bitboard pieces(int color, int type) const { return by_piece[make_piece(color, type)]; }
+	Bitboard pieces(int color) const { return by_color[color]; }
+	Bitboard occupied() const { return by_color[WHITE] | by_color[BLACK]; }
+	Square king_square(int color) const;
+
+	bool is_square_attacked(Square square, int by_color) const;
+	bool in_check() const { return is_square_attacked(king_square(turn), 1 - turn); }
+	bool is_capture(Move move) const;
+
+	// All pieces of both colors attacking square, given an occupancy (x-rays appear as it shrinks).
+	Bitboard attackers_to(Square square, Bitboard occupied) const;
+
+	// Static exchange evaluation: material balance of the capture sequence started by move.
+	int see(Move move) const;
+
+	// Pseudo-legal moves are accepted; the caller checks the mover's king afterwards.
+	void make_move(Move move, UndoInfo &undo);
+	void unmake_move(Move move, const UndoInfo &undo);
+	void make_null_move(UndoInfo &undo);
+	void unmake_null_move(const UndoInfo &undo);
+
+	// Earlier occurrences of this position (same side to move) since the last irreversible move.
+	int repetition_count() const;
+	bool has_insufficient_material() const;
+	bool is_fifty_move_draw() const { return halfmove_clock >= 100; }
+
+	// Draw as the search sees it: a single repetition already counts, since repeating once
+	// can be repeated again.
+	bool is_draw() const { return is_fifty_move_draw() || has_insufficient_material() || repetition_count() >= 1; }
+
+	// True if the side that just moved left its own king attacked.
+	bool was_last_move_illegal() const { return is_square_attacked(king_square(1 - turn), turn); }
+};
+
+// Coordinate notation helpers ("e2e4", "e7e8q").
+std::string square_to_string(Square square);
+std::string move_to_uci(Move move);
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,122 @@
+#include "psqt.h"
+
+namespace chess {
+
+// PieceType order (P, R, N, B, Q, K).
+const int PHASE_WEIGHT[6] = { 0, 2, 1, 1, 4, 0 };
+static const PhaseScore PIECE_VALUES[6] = {
+	PhaseScore(82, 94), PhaseScore(477, 512), PhaseScore(337, 281),
+	PhaseScore(365, 297), PhaseScore(1025, 936), PhaseScore(0, 0)
+};
+
+// Square bonuses for White as the board is printed: a8 first, h1 last (the core's square order).
+// Black reads them mirrored vertically.
+static const int PAWN_MG[64] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 50,  50,  50,  50,  50,  50,  50,  50,
+	 10,  10,  20,  30,  30,  20,  10,  10,
+	  5,   5,  10,  25,  25,  10,   5,   5,
+	  0,   0,   0,  20,  20,   0,   0,   0,
+	  5,  -5, -10,   0,   0, -10,  -5,   5,
+	  5,  10,  10, -20, -20,  10,  10,   5,
+	  0,   0,   0,   0,   0,   0,   0,   0
+};
+
+static const int PAWN_EG[64] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 80,  80,  80,  80,  80,  80,  80,  80,
+	 50,  50,  50,  50,  50,  50,  50,  50,
+	 30,  30,  30,  30,  30,  30,  30,  30,
+	 15,  15,  15,  15,  15,  15,  15,  15,
+	  5,   5,   5,   5,   5,   5,   5,   5,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0
+};
+
+static const int ROOK_TABLE[64] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  5,  10,  10,  10,  10,  10,  10,   5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	  0,   0,   0,   5,   5,   0,   0,   0
+};
+
+static const int KNIGHT_TABLE[64] = {
+	-50, -40, -30, -30, -30, -30, -40, -50,
+	-40, -20,   0,   0,   0,   0, -20, -40,
+	-30,   0,  10,  15,  15,  10,   0, -30,
+	-30,   5,  15,  20,  20,  15,   5, -30,
+	-30,   0,  15,  20,  20,  15,   0, -30,
+	-30,   5,  10,  15,  15,  10,   5, -30,
+	-40, -20,   0,   5,   5,   0, -20, -40,
+	-50, -40, -30, -30, -30, -30, -40, -50
+};
+
+static const int BISHOP_TABLE[64] = {
+	-20, -10, -10, -10, -10, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,  10,  10,   5,   0, -10,
+	-10,   5,   5,  10,  10,   5,   5, -10,
+	-10,   0,  10,  10,  10,  10,   0, -10,
+	-10,  10,  10,  10,  10,  10,  10, -10,
+	-10,   5,   0,   0,   0,   0,   5, -10,
+	-20, -10, -10, -10, -10, -10, -10, -20
+};
+
+static const int QUEEN_TABLE[64] = {
+	-20, -10, -10,  -5,  -5, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,   5,   5,   5,   0, -10,
+	 -5,   0,   5,   5,   5,   5,   0,  -5,
+	  0,   0,   5,   5,   5,   5,   0,  -5,
+	-10,   5,   5,   5,   5,   5,   0, -10,
+	-10,   0,   5,   0,   0,   0,   0, -10,
+	-20, -10, -10,  -5,  -5, -10, -10, -20
+};
+
+// The king hides behind its pawns while there are attackers, then walks to the centre.
+static const int KING_MG[64] = {
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-20, -30, -30, -40, -40, -30, -30, -20,
+	-10, -20, -20, -20, -20, -20, -20, -10,
+	 20,  20,   0,   0,   0,   0,  20,  20,
+	 20,  30,  10,   0,   0,  10,  30,  20
+};
+
+static const int KING_EG[64] = {
+	-50, -40, -30, -20, -20, -30, -40, -50,
+	-30, -20, -10,   0,   0, -10, -20, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -30,   0,   0,   0,   0, -30, -30,
+	-50, -30, -30, -30, -30, -30, -30, -50
+};
+
+static const int *const MG_TABLES[6] = { PAWN_MG, ROOK_TABLE, KNIGHT_TABLE, BISHOP_TABLE, QUEEN_TABLE, KING_MG };
+static const int *const EG_TABLES[6] = { PAWN_EG, ROOK_TABLE, KNIGHT_TABLE, BISHOP_TABLE, QUEEN_TABLE, KING_EG };
+
+PhaseScore PSQ[12][64];
+
+static void init_psq() {
+	for (int type = 0; type < 6; type++) {
+		for (int square = 0; square < 64; square++) {
+			PhaseScore score = PIECE_VALUES[type] + PhaseScore(MG_TABLES[type][square], EG_TABLES[type][square]);
+			PSQ[make_piece(WHITE, type)][square] = score;
+			PSQ[make_piece(BLACK, type)][square ^ 56] = PhaseScore() - score;
+		}
+	}
+}
+
+static struct PsqInitializer {
+	PsqInitializer() { init_psq(); }
+} psq_initializer;
+
+} // namespace chess
@@ -0,0 +1,47 @@
+#ifndef CHESS_CORE_PSQT_H
+#define CHESS_CORE_PSQT_H
+
+#include "types.h"
+
+namespace chess {
+
+// A middlegame/endgame pair, blended by game phase at evaluation time.
+struct PhaseScore {
+	int mg = 0;
+	int eg = 0;
+
+	PhaseScore() {}
+	PhaseScore(int middlegame, int endgame) : mg(middlegame), eg(endgame) {}
+
+	PhaseScore &operator+=(const PhaseScore &other) {
+		mg += other.mg;
+		eg += other.eg;
+		return *this;
+	}
+	PhaseScore &operator-=(const PhaseScore &other) {
+		mg -= other.mg;
+		eg -= other.eg;
+		return *this;
+	}
+	PhaseScore operator+(const PhaseScore &other) const { return PhaseScore(mg + other.mg, eg + other.eg); }
+	PhaseScore operator-(const PhaseScore &other) const { return PhaseScore(mg - other.mg, eg - other.eg); }
+	PhaseScore operator*(int factor) const { return PhaseScore(mg * factor, eg * factor); }
+};
+
+// Game phase from the non-pawn material left: PHASE_MAX with all of it on the board (or more,
+// after promotions), 0 with bare kings and pawns.
+const int PHASE_MAX = 24;
+extern const int PHASE_WEIGHT[6];
+
+// Material plus square bonus for [piece][square], positive for White. Filled at static initialisation.
+extern PhaseScore PSQ[12][64];
+
+// Interpolate mg and eg by phase (clamped to PHASE_MAX).
+inline int taper(const PhaseScore &score, int phase) {
+	phase = phase < PHASE_MAX ? phase : PHASE_MAX;
+	return (score.mg * phase + score.eg * (PHASE_MAX - phase)) / PHASE_MAX;
+}
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,972 @@
+#include "search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace chess {
+
+// Values in PieceType order (P, R, N, B, Q, K), only used for capture ordering.
+static const int ORDER_VALUES[6] = { 100, 500, 320, 330, 900, 20000 };
+
+// Move ordering bands: TT move, captures (MVV-LVA), queen promotions, killers, then history.
+static const int TT_MOVE_SCORE = 1 << 30;
+static const int CAPTURE_SCORE = 1 << 24;
+static const int PROMOTION_SCORE = 1 << 23;
+static const int KILLER_SCORE = 1 << 22;
+static const int HISTORY_MAX = 1 << 16;
+
+// A quiet move's policy probability, times this, is added to its history score.
+static const int POLICY_ORDER_SCALE = 1 << 17;
+
+// Late moves the policy rates at least this many times a uniform share are reduced one ply
+// less, and those under the lower share one ply more.
+static const float POLICY_LMR_HIGH = 2.0f;
+static const float POLICY_LMR_LOW = 0.25f;
+
+// An aspiration margin this wide is given up for the full window.
+static const int ASPIRATION_MAX_WINDOW = 1000;
+
+// Nodes between node-limit checks when several workers share the limit (power of two). A lone
+// worker compares its own count and stops exactly at the limit.
+static const int NODE_CHECK_INTERVAL = 64;
+
+void SearchStats::add(const SearchStats &other) {
+	nodes += other.nodes;
+	qnodes += other.qnodes;
+	tt_probes += other.tt_probes;
+	tt_hits += other.tt_hits;
+	tt_cutoffs += other.tt_cutoffs;
+	beta_cutoffs += other.beta_cutoffs;
+	first_move_cutoffs += other.first_move_cutoffs;
+	null_move_tries += other.null_move_tries;
+	null_move_cutoffs += other.null_move_cutoffs;
+	lmr_reductions += other.lmr_reductions;
+	lmr_researches += other.lmr_researches;
+	pvs_searches += other.pvs_searches;
+	pvs_researches += other.pvs_researches;
+	aspiration_searches += other.aspiration_searches;
+	aspiration_fail_lows += other.aspiration_fail_lows;
+	aspiration_fail_highs += other.aspiration_fail_highs;
+	reverse_futility_prunes += other.reverse_futility_prunes;
+	futility_prunes += other.futility_prunes;
+	razoring_prunes += other.razoring_prunes;
+	check_extensions += other.check_extensions;
+	tb_probes += other.tb_probes;
+	tb_hits += other.tb_hits;
+	evaluations += other.evaluations;
+	eval_cache_hits += other.eval_cache_hits;
+	handcrafted_evaluations += other.handcrafted_evaluations;
+	lazy_skips += other.lazy_skips;
+	policy_evaluations += other.policy_evaluations;
+	movegen_calls += other.movegen_calls;
+	movegen_ns += other.movegen_ns;
+	eval_ns += other.eval_ns;
+}
+
+// Mates and tablebase results, which margins and null-move verification must not touch.
+static bool is_decisive_score(int score) {
+	return std::abs(score) >= TB_WIN_IN_MAX_PLY;
+}
+
+static int64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Per-thread search state. Only the main worker (id 0) checks limits and reports results.
+struct Search::Worker {
+	Search *search;
+	int id;
+	Position pos;
+	Evaluator evaluator;
+
+	// Written only by this worker; relaxed atomic so the main thread can sum node counts.
+	std::atomic<int64_t> nodes;
+	int seldepth;
+	SearchStats stats;
+
+	Move killers[MAX_PLY + 1][2];
+	int history[2][64][64];
+	Move pv[MAX_PLY + 1][MAX_PLY + 1];
+	int pv_length[MAX_PLY + 1];
+
+	// Result of the last completed iteration.
+	int completed_depth;
+	int best_score;
+	std::vector<Move> root_pv;
+	std::vector<RootLine> root_lines;
+
+	// Root moves that already have a line in the current iteration.
+	std::vector<Move> root_excluded;
+
+	Worker(Search *owner, int index) : search(owner), id(index), nodes(0) {
+		clear_history();
+	}
+
+	void clear_history() {
+		std::memset(killers, 0, sizeof(killers));
+		std::memset(history, 0, sizeof(history));
+	}
+
+	// Count a node and, on the main worker, poll the limits. Returns true once the search must unwind.
+	bool count_node_and_poll() {
+		int64_t count = nodes.load(std::memory_order_relaxed) + 1;
+		nodes.store(count, std::memory_order_relaxed);
+		if (id == 0 && ((count & (TimeManager::CHECK_INTERVAL - 1)) == 0 || node_limit_due(count))) {
+			search->check_limits();
+		}
+		return search->stop_flag.load(std::memory_order_relaxed);
+	}
+
+	bool node_limit_due(int64_t count) const {
+		int64_t limit = search->limits.nodes;
+		if (limit <= 0) {
+			return false;
+		}
+		if (search->workers.size() == 1) {
+			return count >= limit;
+		}
+		return (count & (NODE_CHECK_INTERVAL - 1)) == 0;
+	}
+
+	void generate(MoveList &list, GenType type) {
+		if ((stats.movegen_calls++ & (SearchStats::TIMING_SAMPLE - 1)) != 0) {
+			generate_moves(pos, list, type);
+			return;
+		}
+		auto start = std::chrono::steady_clock::now();
+		generate_moves(pos, list, type);
+		stats.movegen_ns += elapsed_ns(start) * SearchStats::TIMING_SAMPLE;
+	}
+
+	// Network output from the shared cache, or a forward pass that is then cached.
+	float network_output() {
+		float output;
+		if (search->eval_cache.probe(pos.key(), output)) {
+			stats.eval_cache_hits++;
+			return output;
+		}
+		output = evaluator.output(pos);
+		search->eval_cache.store(pos.key(), output);
+		return output;
+	}
+
+	// In hybrid mode the handcrafted score stands when it is lazy_eval_margin outside [alpha, beta]:
+	// the network is not expected to move it back into the window.
+	int evaluate(int alpha = -INFINITE_SCORE, int beta = INFINITE_SCORE) {
+		if (search->eval_mode == EVAL_HANDCRAFTED || !evaluator.has_network()) {
+			stats.evaluations++;
+			stats.handcrafted_evaluations++;
+			return evaluator.handcrafted(pos);
+		}
+		if (search->eval_mode == EVAL_HYBRID) {
+			int cheap = evaluator.handcrafted(pos);
+			int margin = search->params.lazy_eval_margin;
+			if (cheap + margin <= alpha || cheap - margin >= beta) {
+				stats.evaluations++;
+				stats.handcrafted_evaluations++;
+				stats.lazy_skips++;
+				return cheap;
+			}
+		}
+		if ((stats.evaluations++ & (SearchStats::TIMING_SAMPLE - 1)) != 0) {
+			return Evaluator::output_to_eval(network_output());
+		}
+		auto start = std::chrono::steady_clock::now();
+		int score = Evaluator::output_to_eval(network_output());
+		stats.eval_ns += elapsed_ns(start) * SearchStats::TIMING_SAMPLE;
+		return score;
+	}
+
+	// Probe the table for this node, keeping the probe/hit counters.
+	bool probe_tt(TTData &tt_data) {
+		stats.tt_probes++;
+		bool hit = search->tt.probe(pos.key(), tt_data);
+		stats.tt_hits += hit;
+		return hit;
+	}
+
+	void score_moves(const MoveList &list, int *scores, Move tt_move, int ply) const {
+		int us = pos.side_to_move();
+		for (int i = 0; i < list.size; i++) {
+			Move move = list.moves[i];
+			Square from = move_from(move);
+			Square to = move_to(move);
+			if (move == tt_move) {
+				scores[i] = TT_MOVE_SCORE;
+			} else if (pos.is_capture(move)) {
+				int victim = pos.piece_on(to) == NO_PIECE ? PAWN : type_of(pos.piece_on(to));
+				int attacker = type_of(pos.piece_on(from));
+				scores[i] = CAPTURE_SCORE + ORDER_VALUES[victim] * 16 - ORDER_VALUES[attacker] / 16;
+			} else if (move_promotion(move) == QUEEN) {
+				scores[i] = PROMOTION_SCORE;
+			} else if (move == killers[ply][0]) {
+				scores[i] = KILLER_SCORE + 1;
+			} else if (move == killers[ply][1]) {
+				scores[i] = KILLER_SCORE;
+			} else {
+				scores[i] = history[us][from][to];
+			}
+		}
+	}
+
+	// Policy probabilities of the moves in list; false where the policy is not used.
+	bool policy_scores(const MoveList &list, float *probabilities, int depth) {
+		const SearchParams &params = search->params;
+		if (!params.policy || depth < params.policy_min_depth || !evaluator.has_policy() || list.size == 0) {
+			return false;
+		}
+		stats.policy_evaluations++;
+		evaluator.policy(pos, list.moves, list.size, probabilities);
+		return true;
+	}
+
+	// Selection sort step: bring the best remaining move to index i (and its policy, if any).
+	static Move pick_next(MoveList &list, int *scores, int i, float *policy = nullptr) {
+		int best = i;
+		for (int j = i + 1; j < list.size; j++) {
+			if (scores[j] > scores[best]) {
+				best = j;
+			}
+		}
+		std::swap(list.moves[i], list.moves[best]);
+		std::swap(scores[i], scores[best]);
+		if (policy != nullptr) {
+			std::swap(policy[i], policy[best]);
+		}
+		return list.moves[i];
+	}
+
+	void update_quiet_stats(Move move, int depth, int ply) {
+		if (killers[ply][0] != move) {
+			killers[ply][1] = killers[ply][0];
+			killers[ply][0] = move;
+		}
+		int &entry = history[pos.side_to_move()][move_from(move)][move_to(move)];
+		int bonus = std::min(depth * depth, 400);
+		entry += bonus - entry * bonus / HISTORY_MAX;
+	}
+
+	void update_pv(int ply, Move move) {
+		pv[ply][ply] = move;
+		for (int i = ply + 1; i < pv_length[ply + 1]; i++) {
+			pv[ply][i] = pv[ply + 1][i];
+		}
+		pv_length[ply] = std::max(pv_length[ply + 1], ply + 1);
+	}
+
+	int quiescence(int alpha, int beta, int ply) {
+		pv_length[ply] = ply;
+		if (count_node_and_poll()) {
+			return 0;
+		}
+		stats.qnodes++;
+		seldepth = std::max(seldepth, ply);
+		if (ply >= MAX_PLY) {
+			return evaluate();
+		}
+
+		// The table collapses the many orders in which independent exchanges can be played.
+		const int alpha_orig = alpha;
+		TTData tt_data;
+		Move tt_move = MOVE_NONE;
+		if (probe_tt(tt_data)) {
+			tt_move = tt_data.move;
+			int tt_score = score_from_tt(tt_data.score, ply);
+			if (tt_data.bound == BOUND_EXACT || (tt_data.bound == BOUND_LOWER && tt_score >= beta) ||
+					(tt_data.bound == BOUND_UPPER && tt_score <= alpha)) {
+				stats.tt_cutoffs++;
+				return tt_score;
+			}
+		}
+
+		// Stand pat unless in check, where every evasion has to be tried.
+		bool in_check = pos.in_check();
+		int best_score = -INFINITE_SCORE;
+		if (!in_check) {
+			best_score = evaluate(alpha, beta);
+			if (best_score >= beta) {
+				return best_score;
+			}
+			alpha = std::max(alpha, best_score);
+		}
+
+		MoveList list;
+		generate(list, in_check ? GEN_ALL : GEN_CAPTURES);
+		int scores[256];
+		score_moves(list, scores, tt_move, ply);
+		Move best_move = MOVE_NONE;
+
+		int legal = 0;
+		for (int i = 0; i < list.size; i++) {
+			Move move = pick_next(list, scores, i);
+			// Captures that lose material cannot raise a stand-pat score worth keeping.
+			if (!in_check && pos.see(move) < 0) {
+				continue;
+			}
+			UndoInfo undo;
+			pos.make_move(move, undo);
+			if (pos.was_last_move_illegal()) {
+				pos.unmake_move(move, undo);
+				continue;
+			}
+			legal++;
+			int score = -quiescence(-beta, -alpha, ply + 1);
+			pos.unmake_move(move, undo);
+
+			if (search->stop_flag.load(std::memory_order_relaxed)) {
+				return 0;
+			}
+			if (score > best_score) {
+				best_score = score;
+				if (score > alpha) {
+					alpha = score;
+					best_move = move;
+					update_pv(ply, move);
+					if (alpha >= beta) {
+						break;
+					}
+				}
+			}
+		}
+
+		if (in_check && legal == 0) {
+			return -MATE_SCORE + ply;
+		}
+
+		int bound = best_score >= beta ? BOUND_LOWER : (best_score > alpha_orig ? BOUND_EXACT : BOUND_UPPER);
+		search->tt.store(pos.key(), best_move, score_to_tt(best_score, ply), 0, bound);
+		return best_score;
+	}
+
+	// Null move pruning is unsound in zugzwang, which is mostly a king-and-pawns affair.
+	bool has_non_pawn_material() const {
+		int us = pos.side_to_move();
+		return (pos.pieces(us, KNIGHT) | pos.pieces(us, BISHOP) | pos.pieces(us, ROOK) | pos.pieces(us, QUEEN)) != 0;
+	}
+
+	int alpha_beta(int alpha, int beta, int depth, int ply, bool allow_null = true) {
+		if (depth <= 0) {
+			return quiescence(alpha, beta, ply);
+		}
+		pv_length[ply] = ply;
+		if (count_node_and_poll()) {
+			return 0;
+		}
+		if (ply >= MAX_PLY) {
+			return evaluate();
+		}
+
+		const SearchParams &params = search->params;
+		const bool root_node = ply == 0;
+		const bool pv_node = beta - alpha > 1;
+		const int alpha_orig = alpha;
+
+		// Repetitions, the fifty-move rule and dead material end the line as a draw.
+		if (!root_node && pos.is_draw()) {
+			return 0;
+		}
+
+		TTData tt_data;
+		Move tt_move = MOVE_NONE;
+		if (probe_tt(tt_data)) {
+			tt_move = tt_data.move;
+			int tt_score = score_from_tt(tt_data.score, ply);
+			if (!root_node && tt_data.depth >= depth &&
+					(tt_data.bound == BOUND_EXACT || (tt_data.bound == BOUND_LOWER && tt_score >= beta) ||
+							(tt_data.bound == BOUND_UPPER && tt_score <= alpha))) {
+				stats.tt_cutoffs++;
+				return tt_score;
+			}
+		}
+
+		// Tablebase WDL: exact right after a capture or pawn move, and castling rights are not
+		// in the tables. Probes with the largest piece count are kept to deeper nodes.
+		const Tablebases *tablebases = search->tablebases;
+		if (!root_node && tablebases != nullptr && pos.get_halfmove_clock() == 0 && tablebases->can_probe(pos)) {
+			int piece_count = popcount(pos.occupied());
+			if (piece_count < tablebases->max_pieces() || depth >= params.syzygy_probe_depth) {
+				stats.tb_probes++;
+				WdlScore wdl;
+				if (tablebases->probe_wdl(pos, wdl)) {
+					stats.tb_hits++;
+					// Cursed wins and blessed losses are draws under the fifty-move rule.
+					int score = wdl < WDL_BLESSED_LOSS ? -TB_WIN_SCORE + ply : wdl > WDL_CURSED_WIN ? TB_WIN_SCORE - ply : 0;
+					int bound = wdl < WDL_BLESSED_LOSS ? BOUND_UPPER : wdl > WDL_CURSED_WIN ? BOUND_LOWER : BOUND_EXACT;
+					if (bound == BOUND_EXACT || (bound == BOUND_LOWER ? score >= beta : score <= alpha)) {
+						search->tt.store(pos.key(), MOVE_NONE, score_to_tt(score, ply), std::min(MAX_PLY - 1, depth + 6), bound);
+						return score;
+					}
+				}
+			}
+		}
+
+		bool in_check = pos.in_check();
+		int static_eval = in_check ? -INFINITE_SCORE : evaluate(alpha, beta);
+
+		// Whole-node pruning, only where the window is null and no evasion is forced.
+		if (!pv_node && !in_check && !root_node) {
+			// Reverse futility: so far above beta that the opponent cannot plausibly recover.
+			if (params.reverse_futility && depth <= params.reverse_futility_depth && !is_decisive_score(beta) &&
+					static_eval - params.reverse_futility_margin * depth >= beta) {
+				stats.reverse_futility_prunes++;
+				return static_eval;
+			}
+
+			// Razoring: hopelessly below alpha, so only tactics can help; let quiescence decide.
+			if (params.razoring && depth <= params.razoring_depth &&
+					static_eval + params.razoring_margin * depth < alpha) {
+				int score = quiescence(alpha, beta, ply);
+				if (score <= alpha) {
+					stats.razoring_prunes++;
+					return score;
+				}
+			}
+
+			// Null move: if passing still fails high, a real move would too.
+			if (params.null_move && allow_null && depth >= params.null_move_min_depth && static_eval >= beta &&
+					!is_decisive_score(beta) && has_non_pawn_material()) {
+				stats.null_move_tries++;
+				int reduction = params.null_move_reduction + depth / params.null_move_depth_divisor;
+				UndoInfo undo;
+				pos.make_null_move(undo);
+				int score = -alpha_beta(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+				pos.unmake_null_move(undo);
+				if (search->stop_flag.load(std::memory_order_relaxed)) {
+					return 0;
+				}
+				if (score >= beta) {
+					stats.null_move_cutoffs++;
+					return is_decisive_score(score) ? beta : score;
+				}
+			}
+		}
+
+		MoveList list;
+		generate(list, GEN_ALL);
+		int scores[256];
+		score_moves(list, scores, tt_move, ply);
+
+		// The policy ranks the quiet moves that history alone would leave in generation order.
+		float policy[256];
+		const bool use_policy = policy_scores(list, policy, depth);
+		const float uniform_share = list.size > 0 ? 1.0f / list.size : 0.0f;
+		for (int i = 0; use_policy && i < list.size; i++) {
+			if (scores[i] < KILLER_SCORE) {
+				scores[i] += (int)(policy[i] * POLICY_ORDER_SCALE);
+			}
+		}
+
+		const bool futility_node = params.futility && !pv_node && !in_check && depth <= params.futility_depth &&
+				!is_decisive_score(alpha);
+		const int futility_value = static_eval + params.futility_margin_base + params.futility_margin * depth;
+
+		int best_score = -INFINITE_SCORE;
+		Move best_move = MOVE_NONE;
+		int legal = 0;
+		for (int i = 0; i < list.size; i++) {
+			Move move = pick_next(list, scores, i, use_policy ? policy : nullptr);
+			if (root_node && skip_root_move(move)) {
+				continue;
+			}
+			bool quiet = !pos.is_capture(move) && move_promotion(move) == 0;
+			bool killer = move == killers[ply][0] || move == killers[ply][1];
+			int move_history = history[pos.side_to_move()][move_from(move)][move_to(move)];
+			UndoInfo undo;
+			pos.make_move(move, undo);
+			if (pos.was_last_move_illegal()) {
+				pos.unmake_move(move, undo);
+				continue;
+			}
+			bool gives_check = pos.in_check();
+
+			// Futility: a quiet move this far below alpha will not get back above it.
+			if (futility_node && quiet && !gives_check && legal > 0 && futility_value <= alpha) {
+				pos.unmake_move(move, undo);
+				stats.futility_prunes++;
+				best_score = std::max(best_score, futility_value);
+				continue;
+			}
+			legal++;
+
+			int extension = params.check_extensions && gives_check && ply < MAX_PLY / 2 ? 1 : 0;
+			stats.check_extensions += extension;
+			int new_depth = depth - 1 + extension;
+
+			// Late quiet moves get a reduced look first; history and killers earn some depth back.
+			int reduction = 0;
+			if (params.lmr && quiet && !gives_check && !in_check && depth >= params.lmr_min_depth &&
+					legal > params.lmr_min_moves) {
+				reduction = search->lmr_table[std::min(depth, 63)][std::min(legal, 63)];
+				reduction -= move_history / params.lmr_history_divisor;
+				reduction -= killer;
+				reduction -= pv_node;
+				if (use_policy) {
+					reduction -= policy[i] >= POLICY_LMR_HIGH * uniform_share;
+					reduction += policy[i] < POLICY_LMR_LOW * uniform_share;
+				}
+				reduction = std::max(0, std::min(reduction, new_depth - 1));
+				stats.lmr_reductions += reduction > 0;
+			}
+
+			// PVS: after the first move only a null window is needed to show a move is no better;
+			// one that beats alpha is searched at full depth, and inside the window with the full window.
+			int score;
+			if (legal == 1 || (!params.pvs && reduction == 0)) {
+				score = -alpha_beta(-beta, -alpha, new_depth, ply + 1);
+			} else if (!params.pvs) {
+				score = -alpha_beta(-alpha - 1, -alpha, new_depth - reduction, ply + 1);
+				if (score > alpha) {
+					stats.lmr_researches++;
+					score = -alpha_beta(-beta, -alpha, new_depth, ply + 1);
+				}
+			} else {
+				stats.pvs_searches += pv_node;
+				score = -alpha_beta(-alpha - 1, -alpha, new_depth - reduction, ply + 1);
+				if (reduction > 0 && score > alpha) {
+					stats.lmr_researches++;
+					score = -alpha_beta(-alpha - 1, -alpha, new_depth, ply + 1);
+				}
+				if (pv_node && score > alpha && score < beta) {
+					stats.pvs_researches++;
+					score = -alpha_beta(-beta, -alpha, new_depth, ply + 1);
+				}
+			}
+			pos.unmake_move(move, undo);
+
+			if (search->stop_flag.load(std::memory_order_relaxed)) {
+				return 0;
+			}
+			if (score > best_score) {
+				best_score = score;
+				best_move = move;
+				if (score > alpha) {
+					alpha = score;
+					update_pv(ply, move);
+					if (alpha >= beta) {
+						stats.beta_cutoffs++;
+						stats.first_move_cutoffs += legal == 1;
+						if (quiet) {
+							update_quiet_stats(move, depth, ply);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		if (legal == 0) {
+			return in_check ? -MATE_SCORE + ply : 0;
+		}
+
+		// A root searched without its better moves has no score of its own to store.
+		if (root_node && !root_excluded.empty()) {
+			return best_score;
+		}
+		int bound = best_score >= beta ? BOUND_LOWER : (best_score > alpha_orig ? BOUND_EXACT : BOUND_UPPER);
+		search->tt.store(pos.key(), bound == BOUND_UPPER ? MOVE_NONE : best_move, score_to_tt(best_score, ply), depth, bound);
+		return best_score;
+	}
+
+	bool skip_root_move(Move move) const {
+		const std::vector<Move> &allowed = search->root_moves;
+		if (!allowed.empty() && std::find(allowed.begin(), allowed.end(), move) == allowed.end()) {
+			return true;
+		}
+		return std::find(root_excluded.begin(), root_excluded.end(), move) != root_excluded.end();
+	}
+
+	// Start from a window around the line's score in the previous iteration. A fail moves the
+	// failing bound past the score and doubles the margin, until the full window is reached.
+	int aspiration_search(int depth, int previous_score) {
+		const SearchParams &params = search->params;
+		if (!params.aspiration || depth < params.aspiration_min_depth || is_decisive_score(previous_score)) {
+			return alpha_beta(-INFINITE_SCORE, INFINITE_SCORE, depth, 0);
+		}
+		int delta = params.aspiration_window;
+		int alpha = std::max(previous_score - delta, -INFINITE_SCORE);
+		int beta = std::min(previous_score + delta, INFINITE_SCORE);
+		stats.aspiration_searches++;
+		while (true) {
+			int score = alpha_beta(alpha, beta, depth, 0);
+			if (search->stop_flag.load(std::memory_order_relaxed)) {
+				return score;
+			}
+			if (score <= alpha && alpha > -INFINITE_SCORE) {
+				stats.aspiration_fail_lows++;
+				beta = (alpha + beta) / 2;
+				alpha = std::max(score - delta, -INFINITE_SCORE);
+			} else if (score >= beta && beta < INFINITE_SCORE) {
+				stats.aspiration_fail_highs++;
+				beta = std::min(score + delta, INFINITE_SCORE);
+			} else {
+				return score;
+			}
+			delta *= 2;
+			if (delta >= ASPIRATION_MAX_WINDOW) {
+				alpha = -INFINITE_SCORE;
+				beta = INFINITE_SCORE;
+			}
+		}
+	}
+
+	// Search the best line, then the best line without that move, and so on. Helpers only
+	// search the best line.
+	bool search_lines(int depth, std::vector<RootLine> &lines) {
+		int line_count = id == 0 ? search->root_line_count : 1;
+		root_excluded.clear();
+		for (int line = 0; line < line_count; line++) {
+			int score = line < (int)root_lines.size() ? aspiration_search(depth, root_lines[line].score)
+													  : alpha_beta(-INFINITE_SCORE, INFINITE_SCORE, depth, 0);
+			if (search->stop_flag.load() || pv_length[0] == 0) {
+				break;
+			}
+			RootLine root_line;
+			root_line.move = pv[0][0];
+			root_line.score = score;
+			root_line.depth = depth;
+			root_line.pv.assign(pv[0], pv[0] + pv_length[0]);
+			lines.push_back(root_line);
+			root_excluded.push_back(root_line.move);
+		}
+		root_excluded.clear();
+		return !search->stop_flag.load() && !lines.empty();
+	}
+
+	// Helpers start one ply deeper on odd ids so the threads spread over different depths.
+	void iterative_deepening() {
+		int max_depth = search->limits.depth > 0 ? std::min(search->limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+		int64_t previous_iteration_nodes = 0;
+		for (int depth = 1 + (id & 1); depth <= max_depth; depth++) {
+			seldepth = 0;
+			int64_t nodes_before = search->total_nodes();
+			std::vector<RootLine> lines;
+			if (!search_lines(depth, lines)) {
+				break;
+			}
+			std::stable_sort(lines.begin(), lines.end(), [](const RootLine &a, const RootLine &b) { return a.score > b.score; });
+			root_lines = lines;
+			if (id != 0) {
+				continue;
+			}
+
+			int64_t iteration_nodes = search->total_nodes() - nodes_before;
+			if (previous_iteration_nodes > 0) {
+				stats.branching_factor = (double)iteration_nodes / previous_iteration_nodes;
+			}
+			previous_iteration_nodes = iteration_nodes;
+
+			completed_depth = depth;
+			best_score = lines[0].score;
+			root_pv = lines[0].pv;
+
+			if (search->on_iteration) {
+				for (size_t line = 0; line < lines.size(); line++) {
+					SearchInfo info;
+					info.depth = depth;
+					info.seldepth = seldepth;
+					info.score = lines[line].score;
+					info.nodes = search->total_nodes();
+					info.time_ms = search->elapsed_ms();
+					info.hashfull = search->tt.hashfull();
+					info.multipv = (int)line + 1;
+					info.pv = lines[line].pv;
+					search->on_iteration(info);
+				}
+			}
+
+			// The time manager decides whether another iteration is worth starting.
+			bool out_of_time = search->time_manager.iteration_finished(depth, root_pv[0], best_score, search->clock_elapsed_ms());
+			if (out_of_time && !search->limits.infinite && !search->pondering.load()) {
+				break;
+			}
+		}
+	}
+};
+
+Search::Search() :
+		network(nullptr), tablebases(nullptr), eval_mode(EVAL_NETWORK), skill_rng(std::random_device()()), root_line_count(1), stop_flag(false),
+		searching(false), pondering(false), clock_start_ms(0) {
+	set_threads(1);
+	set_params(SearchParams());
+}
+
+Search::~Search() {
+	stop();
+	wait();
+}
+
+void Search::set_network(const Network *new_network) {
+	network = new_network;
+	for (auto &worker : workers) {
+		worker->evaluator.set_network(network);
+	}
+}
+
+void Search::set_tablebases(const Tablebases *new_tablebases) {
+	tablebases = new_tablebases;
+}
+
+void Search::set_threads(int count) {
+	count = std::max(1, std::min(count, 256));
+	workers.clear();
+	workers.resize(count);
+	for (int i = 0; i < count; i++) {
+		if (count > 1 && numa_node_count() > 1) {
+			// Built on a thread bound to the worker's node, so its tables are first touched there.
+			std::thread([this, i]() {
+				bind_thread_to_numa_node(i);
+				workers[i].reset(new Worker(this, i));
+			}).join();
+		} else {
+			workers[i].reset(new Worker(this, i));
+		}
+		workers[i]->evaluator.set_network(network);
+	}
+}
+
+void Search::set_hash_size(size_t megabytes) {
+	tt.resize(std::max<size_t>(megabytes, 1));
+}
+
+void Search::set_params(const SearchParams &search_params) {
+	params = search_params;
+	for (int depth = 0; depth < 64; depth++) {
+		for (int move = 0; move < 64; move++) {
+			// base + ln(depth) * ln(move) / divisor, both in hundredths.
+			double reduction = depth > 0 && move > 0 ? std::log(depth) * std::log(move) * 100.0 / params.lmr_divisor : 0.0;
+			lmr_table[depth][move] = (int)(params.lmr_base / 100.0 + reduction);
+		}
+	}
+}
+
+void Search::set_eval_cache_size(size_t megabytes) {
+	eval_cache.resize(std::max<size_t>(megabytes, 1));
+}
+
+void Search::clear() {
+	tt.clear();
+	eval_cache.clear();
+	for (auto &worker : workers) {
+		worker->clear_history();
+		worker->evaluator.clear_pawn_table();
+	}
+}
+
+int64_t Search::elapsed_ms() const {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+int64_t Search::clock_elapsed_ms() const {
+	return elapsed_ms() - clock_start_ms.load();
+}
+
+int64_t Search::total_nodes() const {
+	int64_t sum = 0;
+	for (const auto &worker : workers) {
+		sum += worker->nodes.load(std::memory_order_relaxed);
+	}
+	return sum;
+}
+
+// The reply the table holds for the position after the root move, when the line stopped there
+// (a cut-off or an iteration the search left early); MOVE_NONE unless it is legal.
+Move Search::table_reply(Move move) const {
+	Position pos = root;
+	UndoInfo undo;
+	pos.make_move(move, undo);
+	TTData data;
+	if (!tt.probe(pos.key(), data) || data.move == MOVE_NONE) {
+		return MOVE_NONE;
+	}
+	MoveList replies;
+	generate_legal_moves(pos, replies);
+	for (Move reply : replies) {
+		if (reply == data.move) {
+			return reply;
+		}
+	}
+	return MOVE_NONE;
+}
+
+// Main worker only. A search always completes depth 1 so it has a move to return.
+void Search::check_limits() {
+	if (workers[0]->completed_depth < 1 || limits.infinite || pondering.load()) {
+		return;
+	}
+	if ((limits.nodes > 0 && total_nodes() >= limits.nodes) || (time_manager.enabled() && clock_elapsed_ms() >= time_manager.maximum())) {
+		stop_flag = true;
+	}
+}
+
+SearchResult Search::search_root() {
+	SearchResult result;
+	MoveList legal;
+	generate_legal_moves(root, legal);
+
+	time_manager.start(limits, root.side_to_move());
+	tt.new_search();
+	eval_cache.set_network_revision(network != nullptr ? network->revision() : 0);
+
+	for (auto &worker : workers) {
+		worker->pos = root;
+		worker->nodes.store(0);
+		worker->completed_depth = 0;
+		worker->best_score = 0;
+		worker->root_pv.clear();
+		worker->root_lines.clear();
+		worker->stats = SearchStats();
+	}
+
+	if (legal.size == 0) {
+		return result;
+	}
+
+	// In a tablebase position a won or lost root needs no search: play the DTZ-optimal move.
+	// A drawn one is searched, but only among the moves that keep the draw.
+	Move tablebase_move = MOVE_NONE;
+	int tablebase_score = 0;
+	root_moves.clear();
+	if (tablebases != nullptr && tablebases->can_probe(root)) {
+		Worker &main = *workers[0];
+		std::vector<Move> best_moves;
+		main.stats.tb_probes++;
+		if (tablebases->probe_root(main.pos, best_moves, tablebase_score)) {
+			main.stats.tb_hits++;
+			if (tablebase_score != 0) {
+				tablebase_move = best_moves[0];
+			} else {
+				root_moves = best_moves;
+			}
+		}
+	}
+
+	int root_move_count = root_moves.empty() ? legal.size : (int)root_moves.size();
+	root_line_count = std::max(1, std::min(limits.multi_pv, root_move_count));
+
+	std::vector<std::thread> helpers;
+	if (tablebase_move == MOVE_NONE) {
+		for (size_t i = 1; i < workers.size(); i++) {
+			helpers.emplace_back([this, i]() {
+				bind_thread_to_numa_node((int)i);
+				workers[i]->iterative_deepening();
+			});
+		}
+		workers[0]->iterative_deepening();
+	} else {
+		Worker &main = *workers[0];
+		main.completed_depth = 1;
+		main.best_score = tablebase_score;
+		main.root_pv.assign(1, tablebase_move);
+		RootLine line;
+		line.move = tablebase_move;
+		line.score = tablebase_score;
+		line.depth = 1;
+		line.pv = main.root_pv;
+		main.root_lines.assign(1, line);
+		if (on_iteration) {
+			SearchInfo info;
+			info.depth = 1;
+			info.score = tablebase_score;
+			info.time_ms = elapsed_ms();
+			info.hashfull = tt.hashfull();
+			info.pv = main.root_pv;
+			on_iteration(info);
+		}
+	}
+
+	// An infinite or ponder search only reports its move once it has been told to stop
+	// (or, pondering, once the expected move was played).
+	while ((limits.infinite || pondering.load()) && !stop_flag.load()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	stop_flag = true;
+	for (std::thread &helper : helpers) {
+		helper.join();
+	}
+
+	Worker &main = *workers[0];
+	Move fallback = root_moves.empty() ? legal.moves[0] : root_moves[0];
+	result.best_move = main.root_pv.empty() ? fallback : main.root_pv[0];
+	result.ponder_move = main.root_pv.size() > 1 ? main.root_pv[1] : MOVE_NONE;
+	result.score = main.best_score;
+	if (skill.enabled() && !main.root_lines.empty()) {
+		const RootLine &line = skill.pick(main.root_lines, skill_rng);
+		result.best_move = line.move;
+		result.ponder_move = line.pv.size() > 1 ? line.pv[1] : MOVE_NONE;
+		result.score = line.score;
+	}
+	if (result.ponder_move == MOVE_NONE) {
+		result.ponder_move = table_reply(result.best_move);
+	}
+	result.depth = main.completed_depth;
+	result.nodes = total_nodes();
+	result.time_ms = elapsed_ms();
+	result.lines = main.root_lines;
+
+	for (auto &worker : workers) {
+		result.stats.add(worker->stats);
+	}
+	result.stats.nodes = result.nodes;
+	result.stats.time_ms = result.time_ms;
+	result.stats.branching_factor = main.stats.branching_factor;
+	return result;
+}
+
+void Search::prepare(const Position &position, const SearchLimits &search_limits,
+		const InfoCallback &info_callback, const FinishCallback &finish_callback) {
+	wait();
+	root = position;
+	limits = search_limits;
+	skill.apply(limits);
+	on_iteration = info_callback;
+	on_finish = finish_callback;
+	stop_flag = false;
+	pondering = search_limits.ponder;
+	clock_start_ms = 0;
+	start_time = std::chrono::steady_clock::now();
+	searching = true;
+}
+
+void Search::start(const Position &position, const SearchLimits &search_limits,
+		const InfoCallback &info_callback, const FinishCallback &finish_callback) {
+	prepare(position, search_limits, info_callback, finish_callback);
+	main_thread = std::thread([this]() {
+		// Single-threaded searches (host workers, self-play games) are left to the OS scheduler,
+		// or they would all pile onto the first node.
+		if (workers.size() > 1) {
+			bind_thread_to_numa_node(0);
+		}
+		last_result = search_root();
+		if (on_finish) {
+			on_finish(last_result);
+		}
+		searching = false;
+	});
+}
+
+void Search::wait() {
+	if (main_thread.joinable()) {
+		main_thread.join();
+	}
+}
+
+// Runs on the calling thread, so callers searching move after move (self-play, adapters) spawn no thread for it.
+SearchResult Search::run(const Position &position, const SearchLimits &search_limits, const InfoCallback &info_callback) {
+	prepare(position, search_limits, info_callback, FinishCallback());
+	last_result = search_root();
+	searching = false;
+	return last_result;
+}
+
+void Search::stop() {
+	stop_flag = true;
+}
+
+void Search::ponderhit() {
+	clock_start_ms = elapsed_ms();
+	pondering = false;
+}
+
+} // namespace chess
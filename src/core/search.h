@@ -0,0 +1,220 @@
+#ifndef CHESS_CORE_SEARCH_H
+#define CHESS_CORE_SEARCH_H
+
+#include "eval_cache.h"
+#include "evaluate.h"
+#include "movegen.h"
+#include "network.h"
+#include "position.h"
+#include "search_params.h"
+#include "skill.h"
+#include "syzygy.h"
+#include "timeman.h"
+#include "tt.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+// What a search may spend; zero means "no limit" for every field.
+struct SearchLimits {
+	int depth = 0;
+	int64_t nodes = 0;
+	int64_t movetime = 0;          // Milliseconds for this move.
+	int64_t max_time = 0;          // Hard cap in milliseconds on whatever the other limits allow (0: none).
+	int64_t time[2] = { 0, 0 };    // Remaining clock per color, milliseconds.
+	int64_t increment[2] = { 0, 0 };
+	int moves_to_go = 0;
+	bool infinite = false;         // Keep searching until stop().
+	bool ponder = false;           // Search the expected position, ignoring limits until ponderhit() or stop().
+	int multi_pv = 1;              // Best root moves to search, each with its own score and PV.
+};
+
+// Progress report after each completed iteration of the main thread.
+struct SearchInfo {
+	int depth = 0;
+	int seldepth = 0;
+	int score = 0;
+	int64_t nodes = 0;
+	int64_t time_ms = 0;
+	int hashfull = 0;
+	int multipv = 1;               // 1-based line number, best line first.
+	std::vector<Move> pv;
+};
+
+// Counters kept by each worker in plain integers (nothing shared on the hot path) and summed
+// once the search has finished. Movegen and eval times are sampled on 1 call in TIMING_SAMPLE
+// and scaled up, so the clock is rarely read.
+struct SearchStats {
+	static const int TIMING_SAMPLE = 64;
+
+	int64_t nodes = 0;              // Main search and quiescence nodes.
+	int64_t qnodes = 0;             // Quiescence nodes only.
+	int64_t tt_probes = 0;
+	int64_t tt_hits = 0;
+	int64_t tt_cutoffs = 0;         // Probes whose score ended the node.
+	int64_t beta_cutoffs = 0;       // Fail-highs in the main search...
+	int64_t first_move_cutoffs = 0; // ...of which on the first legal move.
+	int64_t null_move_tries = 0;
+	int64_t null_move_cutoffs = 0;
+	int64_t lmr_reductions = 0;     // Late moves searched at reduced depth...
+	int64_t lmr_researches = 0;     // ...and searched again at full depth because they beat alpha.
+	int64_t pvs_searches = 0;       // Null-window searches of later moves at PV nodes...
+	int64_t pvs_researches = 0;     // ...searched again with the full window because they landed inside it.
+	int64_t aspiration_searches = 0;
+	int64_t aspiration_fail_lows = 0;
+	int64_t aspiration_fail_highs = 0;
+	int64_t reverse_futility_prunes = 0;
+	int64_t futility_prunes = 0;    // Quiet moves skipped near the leaves.
+	int64_t razoring_prunes = 0;
+	int64_t check_extensions = 0;
+	int64_t tb_probes = 0;          // Tablebase WDL probes in the search, plus the root probe...
+	int64_t tb_hits = 0;            // ...that found their table.
+	int64_t evaluations = 0;
+	int64_t eval_cache_hits = 0;    // Evaluations answered without a network pass.
+	int64_t handcrafted_evaluations = 0;
+	int64_t lazy_skips = 0;         // Hybrid evaluations settled by the handcrafted score, skipping the network.
+	int64_t policy_evaluations = 0; // Nodes whose moves were ordered by the policy head.
+	int64_t movegen_calls = 0;
+	int64_t movegen_ns = 0;
+	int64_t eval_ns = 0;
+	int64_t time_ms = 0;
+	double branching_factor = 0.0;  // Nodes of the last iteration over those of the one before.
+
+	void add(const SearchStats &other);
+
+	int64_t nps() const { return time_ms > 0 ? nodes * 1000 / time_ms : 0; }
+	double tt_hit_rate() const { return tt_probes > 0 ? (double)tt_hits / tt_probes : 0.0; }
+	double tt_cutoff_rate() const { return tt_probes > 0 ? (double)tt_cutoffs / tt_probes : 0.0; }
+	double first_move_cutoff_rate() const { return beta_cutoffs > 0 ? (double)first_move_cutoffs / beta_cutoffs : 0.0; }
+	double lazy_skip_rate() const { return evaluations > 0 ? (double)lazy_skips / evaluations : 0.0; }
+	double eval_cache_hit_rate() const { return evaluations > 0 ? (double)eval_cache_hits / evaluations : 0.0; }
+	double null_move_cutoff_rate() const { return null_move_tries > 0 ? (double)null_move_cutoffs / null_move_tries : 0.0; }
+	double lmr_research_rate() const { return lmr_reductions > 0 ? (double)lmr_researches / lmr_reductions : 0.0; }
+	double pvs_research_rate() const { return pvs_searches > 0 ? (double)pvs_researches / pvs_searches : 0.0; }
+	double aspiration_research_rate() const {
+		return aspiration_searches > 0 ? (double)(aspiration_fail_lows + aspiration_fail_highs) / aspiration_searches : 0.0;
+	}
+};
+
+// One multi-PV line: a root move with the score and PV of its own search.
+struct RootLine {
+	Move move = MOVE_NONE;
+	int score = 0;
+	int depth = 0;
+	std::vector<Move> pv;
+};
+
+struct SearchResult {
+	Move best_move = MOVE_NONE;
+	Move ponder_move = MOVE_NONE;
+	int score = 0;
+	int depth = 0;
+	int64_t nodes = 0;
+	int64_t time_ms = 0;
+	std::vector<RootLine> lines; // Best first, from the last completed iteration; best_move leads lines[0].
+	SearchStats stats;
+};
+
+// Iterative-deepening alpha-beta with a shared transposition table. Extra threads search
+// the same root independently (lazy SMP) and only share what they store in the table.
+class Search {
+public:
+	typedef std::function<void(const SearchInfo &)> InfoCallback;
+	typedef std::function<void(const SearchResult &)> FinishCallback;
+
+private:
+	struct Worker;
+	friend struct Worker;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	const Network *network;
+	TranspositionTable tt;
+	EvalCache eval_cache;
+	const Tablebases *tablebases;
+	EvalMode eval_mode;
+	SearchParams params;
+	SkillLevel skill;
+	std::mt19937_64 skill_rng;
+	int lmr_table[64][64]; // Base late-move reduction by [depth][move number], from params.
+
+	// Current search; written by start() before the search thread exists.
+	Position root;
+	SearchLimits limits;
+	InfoCallback on_iteration;
+	FinishCallback on_finish;
+	std::chrono::steady_clock::time_point start_time;
+	TimeManager time_manager;
+	SearchResult last_result;
+	std::vector<Move> root_moves; // When not empty, the only root moves searched.
+	int root_line_count;          // Multi-PV lines the main worker searches, capped by the root moves.
+
+	std::atomic<bool> stop_flag;
+	std::atomic<bool> searching;
+	std::atomic<bool> pondering;
+	std::atomic<int64_t> clock_start_ms; // Elapsed time at which our clock started (the ponderhit).
+	std::thread main_thread;
+
+	void prepare(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback, const FinishCallback &finish_callback);
+	void check_limits();
+	int64_t elapsed_ms() const;
+	int64_t clock_elapsed_ms() const;
+	int64_t total_nodes() const;
+	Move table_reply(Move move) const;
+	SearchResult search_root();
+
+public:
+	Search();
+	~Search();
+
+	// Configuration; not to be changed while a search is running.
+	void set_network(const Network *network);
+	void set_threads(int count);
+	int get_threads() const { return (int)workers.size(); }
+	void set_hash_size(size_t megabytes);
+	PageKind hash_page_kind() const { return tt.page_kind(); }
+	void set_eval_cache_size(size_t megabytes);
+	void set_tablebases(const Tablebases *tablebases); // nullptr to stop probing.
+	void set_eval_mode(EvalMode mode) { eval_mode = mode; }
+	EvalMode get_eval_mode() const { return eval_mode; }
+	void set_params(const SearchParams &search_params);
+	const SearchParams &get_params() const { return params; }
+	// Strength limit (SkillLevel::MAX_LEVEL for full strength); applies from the next search.
+	void set_skill_level(int level) { skill.set_level(level); }
+	void set_elo(int elo) { skill.set_elo(elo); }
+	int get_skill_level() const { return skill.get_level(); }
+
+	// Forget the tables and move-ordering history (new game).
+	void clear();
+
+	// Asynchronous search: returns at once, on_finish runs on the search thread.
+	void start(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback = InfoCallback(), const FinishCallback &finish_callback = FinishCallback());
+
+	// Block until the current search (if any) has finished.
+	void wait();
+
+	// Blocking search on the calling thread (helper threads are still used when set_threads > 1).
+	SearchResult run(const Position &position, const SearchLimits &search_limits,
+			const InfoCallback &info_callback = InfoCallback());
+
+	// Ask the running search to finish as soon as possible; safe from any thread.
+	void stop();
+
+	// The expected move was played: a ponder search becomes a normal timed search, keeping
+	// everything searched so far. Time limits count from this call. Safe from any thread.
+	void ponderhit();
+	bool is_pondering() const { return pondering.load(); }
+	bool is_searching() const { return searching.load(); }
+};
+
+} // namespace chess
+
+#endif
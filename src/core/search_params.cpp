@@ -0,0 +1,52 @@
+#include "search_params.h"
+
+#include <algorithm>
+
+namespace chess {
+
+const SearchParamInfo SEARCH_PARAM_TABLE[] = {
+	{ "PVS", &SearchParams::pvs, 0, 1 },
+	{ "Aspiration", &SearchParams::aspiration, 0, 1 },
+	{ "AspirationMinDepth", &SearchParams::aspiration_min_depth, 1, 64 },
+	{ "AspirationWindow", &SearchParams::aspiration_window, 5, 1000 },
+	{ "NullMove", &SearchParams::null_move, 0, 1 },
+	{ "NullMoveMinDepth", &SearchParams::null_move_min_depth, 1, 16 },
+	{ "NullMoveReduction", &SearchParams::null_move_reduction, 1, 6 },
+	{ "NullMoveDepthDivisor", &SearchParams::null_move_depth_divisor, 1, 16 },
+	{ "LMR", &SearchParams::lmr, 0, 1 },
+	{ "LMRMinDepth", &SearchParams::lmr_min_depth, 1, 16 },
+	{ "LMRMinMoves", &SearchParams::lmr_min_moves, 1, 32 },
+	{ "LMRBase", &SearchParams::lmr_base, 0, 300 },
+	{ "LMRDivisor", &SearchParams::lmr_divisor, 50, 1000 },
+	{ "LMRHistoryDivisor", &SearchParams::lmr_history_divisor, 1024, 1 << 20 },
+	{ "Policy", &SearchParams::policy, 0, 1 },
+	{ "PolicyMinDepth", &SearchParams::policy_min_depth, 1, 64 },
+	{ "ReverseFutility", &SearchParams::reverse_futility, 0, 1 },
+	{ "ReverseFutilityDepth", &SearchParams::reverse_futility_depth, 1, 16 },
+	{ "ReverseFutilityMargin", &SearchParams::reverse_futility_margin, 0, 1000 },
+	{ "Futility", &SearchParams::futility, 0, 1 },
+	{ "FutilityDepth", &SearchParams::futility_depth, 1, 16 },
+	{ "FutilityMarginBase", &SearchParams::futility_margin_base, 0, 1000 },
+	{ "FutilityMargin", &SearchParams::futility_margin, 0, 1000 },
+	{ "Razoring", &SearchParams::razoring, 0, 1 },
+	{ "RazoringDepth", &SearchParams::razoring_depth, 1, 8 },
+	{ "RazoringMargin", &SearchParams::razoring_margin, 0, 2000 },
+	{ "CheckExtensions", &SearchParams::check_extensions, 0, 1 },
+	{ "LazyEvalMargin", &SearchParams::lazy_eval_margin, 0, 5000 },
+	{ "SyzygyProbeDepth", &SearchParams::syzygy_probe_depth, 1, 100 },
+};
+
+const int SEARCH_PARAM_COUNT = sizeof(SEARCH_PARAM_TABLE) / sizeof(SEARCH_PARAM_TABLE[0]);
+
+bool set_search_param(SearchParams &params, const std::string &name, int value) {
+	for (int i = 0; i < SEARCH_PARAM_COUNT; i++) {
+		const SearchParamInfo &info = SEARCH_PARAM_TABLE[i];
+		if (name == info.name) {
+			params.*info.field = std::max(info.min, std::min(value, info.max));
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace chess
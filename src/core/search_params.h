@@ -0,0 +1,68 @@
+#ifndef CHESS_CORE_SEARCH_PARAMS_H
+#define CHESS_CORE_SEARCH_PARAMS_H
+
+#include <string>
+
+namespace chess {
+
+// Selectivity switches and margins. Everything is an int so the whole table can be set by name
+// (UCI options, ChessAgent.set_search_param); switches are 0/1, fractions are in hundredths.
+struct SearchParams {
+	int pvs = 1;                           // Null-window searches for moves after the first, re-searched on fail-high.
+
+	int aspiration = 1;
+	int aspiration_min_depth = 4;
+	int aspiration_window = 25;            // Initial half-width around the previous score; doubles on each fail.
+
+	int null_move = 1;
+	int null_move_min_depth = 3;
+	int null_move_reduction = 3;           // R = reduction + depth / depth_divisor.
+	int null_move_depth_divisor = 4;
+
+	int lmr = 1;
+	int lmr_min_depth = 3;
+	int lmr_min_moves = 3;                 // Legal moves searched at full depth first.
+	int lmr_base = 75;                     // Reduction = base + ln(depth) * ln(move) / divisor (hundredths).
+	int lmr_divisor = 225;
+	int lmr_history_divisor = 16384;       // Every this much history takes one ply off (or adds one).
+
+	int policy = 1;                        // Order quiet moves and adjust LMR by the network's policy head, if it has one.
+	int policy_min_depth = 3;              // Shallower nodes order by history alone.
+
+	int reverse_futility = 1;
+	int reverse_futility_depth = 6;
+	int reverse_futility_margin = 120;     // Per ply of depth.
+
+	int futility = 1;
+	int futility_depth = 3;
+	int futility_margin_base = 100;
+	int futility_margin = 120;             // Per ply of depth.
+
+	int razoring = 1;
+	int razoring_depth = 2;
+	int razoring_margin = 300;             // Per ply of depth.
+
+	int check_extensions = 1;
+
+	int lazy_eval_margin = 300;            // EVAL_HYBRID: handcrafted scores this far outside the window skip the network.
+
+	int syzygy_probe_depth = 1;            // Least depth for WDL probes with the largest tables' piece count.
+};
+
+// One row of the tunable parameter table.
+struct SearchParamInfo {
+	const char *name;
+	int SearchParams::*field;
+	int min;
+	int max;
+};
+
+extern const SearchParamInfo SEARCH_PARAM_TABLE[];
+extern const int SEARCH_PARAM_COUNT;
+
+// Set a parameter by table name, clamped to its range; false if the name is unknown.
+bool set_search_param(SearchParams &params, const std::string &name, int value);
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,151 @@
+#include "selfplay.h"
+#include "movegen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace chess {
+
+void SelfPlayTotals::add(const SelfPlayTotals &other) {
+	games += other.games;
+	positions += other.positions;
+	white_wins += other.white_wins;
+	black_wins += other.black_wins;
+	draws += other.draws;
+	adjudicated += other.adjudicated;
+	nodes += other.nodes;
+	write_failed = write_failed || other.write_failed;
+}
+
+int play_self_play_game(Search &search, const SelfPlayConfig &config, uint32_t game_seed,
+		std::vector<PackedPosition> &records, bool &adjudicated, int64_t &nodes) {
+	std::mt19937 rng(game_seed);
+	Position pos;
+	pos.set_start_position();
+	MoveList moves;
+	UndoInfo undo;
+
+	records.clear();
+	adjudicated = false;
+
+	// 1. Randomised opening so games from the same network diverge.
+	int ply = 0;
+	for (; ply < config.random_opening_plies; ply++) {
+		moves.size = 0;
+		generate_legal_moves(pos, moves);
+		if (moves.size == 0) {
+			break;
+		}
+		std::uniform_int_distribution<int> pick(0, moves.size - 1);
+		pos.make_move(moves.moves[pick(rng)], undo);
+	}
+
+	SearchLimits limits;
+	limits.depth = config.search_depth;
+	limits.nodes = config.search_nodes;
+
+	// 2. Search-driven play until the game ends or is adjudicated.
+	int result = 0;
+	int win_run = 0;
+	int loss_run = 0;
+	int draw_run = 0;
+	while (true) {
+		GameState state = get_game_state(pos);
+		if (state != GAME_ONGOING) {
+			if (state == GAME_CHECKMATE) {
+				result = (pos.side_to_move() == WHITE) ? -1 : 1;
+			}
+			break;
+		}
+		if (ply >= config.max_game_plies) {
+			adjudicated = true;
+			break;
+		}
+
+		SearchResult searched = search.run(pos, limits);
+		nodes += searched.nodes;
+		records.push_back(pack_position(pos, ply, searched.score));
+
+		// Adjudication works on White's point of view so both sides share the counters.
+		int white_score = (pos.side_to_move() == WHITE) ? searched.score : -searched.score;
+		win_run = (white_score >= config.resign_score) ? win_run + 1 : 0;
+		loss_run = (white_score <= -config.resign_score) ? loss_run + 1 : 0;
+		draw_run = (ply >= config.draw_min_ply && std::abs(white_score) <= config.draw_score) ? draw_run + 1 : 0;
+
+		if (config.resign_plies > 0 && (win_run >= config.resign_plies || loss_run >= config.resign_plies)) {
+			result = win_run > 0 ? 1 : -1;
+			adjudicated = true;
+			break;
+		}
+		if (config.draw_plies > 0 && draw_run >= config.draw_plies) {
+			adjudicated = true;
+			break;
+		}
+
+		pos.make_move(searched.best_move, undo);
+		ply++;
+	}
+
+	// 3. Label every record with the final result from its side to move's point of view.
+	for (PackedPosition &record : records) {
+		record.result = (int8_t)(record.side_to_move == WHITE ? result : -result);
+	}
+	return result;
+}
+
+// Each thread owns a single-threaded Search; games are handed out from a shared counter.
+SelfPlayTotals run_self_play(const Network &network, const SelfPlayConfig &config, std::FILE *output) {
+	int thread_count = std::max(1, std::min(config.threads, std::max(config.games, 1)));
+
+	std::atomic<int> next_game(0);
+	std::mutex output_mutex;
+	std::vector<SelfPlayTotals> totals(thread_count);
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < thread_count; t++) {
+		workers.emplace_back([&, t]() {
+			std::unique_ptr<Search> search(new Search());
+			search->set_hash_size(config.hash_mb);
+			search->set_network(&network);
+
+			std::vector<PackedPosition> records;
+			SelfPlayTotals &mine = totals[t];
+			for (int game = next_game++; game < config.games; game = next_game++) {
+				// A fresh table per game keeps every game reproducible from its seed alone.
+				search->clear();
+				bool adjudicated = false;
+				int result = play_self_play_game(*search, config, config.seed + (uint32_t)game * 7919u, records,
+						adjudicated, mine.nodes);
+
+				mine.games++;
+				mine.positions += (int64_t)records.size();
+				mine.white_wins += result > 0;
+				mine.black_wins += result < 0;
+				mine.draws += result == 0;
+				mine.adjudicated += adjudicated;
+
+				// Whole games are written at once so a file never holds a half-labelled game.
+				std::lock_guard<std::mutex> lock(output_mutex);
+				if (!write_packed_positions(output, records)) {
+					mine.write_failed = true;
+				}
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	SelfPlayTotals sum;
+	for (const SelfPlayTotals &t : totals) {
+		sum.add(t);
+	}
+	return sum;
+}
+
+} // namespace chess
@@ -0,0 +1,56 @@
+#ifndef CHESS_CORE_SELFPLAY_H
+#define CHESS_CORE_SELFPLAY_H
+
+#include "network.h"
+#include "search.h"
+#include "training_data.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace chess {
+
+// Settings for one self-play run.
+struct SelfPlayConfig {
+	int games = 100;
+	int threads = 1;
+	int search_depth = 2;          // Fixed-depth search when > 0.
+	int64_t search_nodes = 0;      // Fixed-node search when > 0 (may be combined with depth).
+	int random_opening_plies = 8;  // Uniformly random moves played before searching.
+	int max_game_plies = 400;      // Longer games are adjudicated as draws.
+	int resign_score = 1000;       // A side is lost once its score stays at or below -resign_score...
+	int resign_plies = 6;          // ...for this many consecutive plies (0 disables).
+	int draw_score = 10;           // A game is drawn once |score| stays within draw_score...
+	int draw_plies = 12;           // ...for this many consecutive plies (0 disables)...
+	int draw_min_ply = 80;         // ...after at least this many plies.
+	int hash_mb = 16;              // Transposition table per worker.
+	uint32_t seed = 1;
+};
+
+// Counters for a run, summed over all workers.
+struct SelfPlayTotals {
+	int64_t games = 0;
+	int64_t positions = 0;
+	int64_t white_wins = 0;
+	int64_t black_wins = 0;
+	int64_t draws = 0;
+	int64_t adjudicated = 0;
+	int64_t nodes = 0;
+	bool write_failed = false;
+
+	void add(const SelfPlayTotals &other);
+};
+
+// Play one game from the start position with search and append its labelled positions.
+// Returns the result from White's point of view (1, 0, -1).
+int play_self_play_game(Search &search, const SelfPlayConfig &config, uint32_t game_seed,
+		std::vector<PackedPosition> &records, bool &adjudicated, int64_t &nodes);
+
+// Play config.games games on config.threads threads, all evaluating with network (shared,
+// read-only), and append every game to output as soon as it is finished.
+SelfPlayTotals run_self_play(const Network &network, const SelfPlayConfig &config, std::FILE *output);
+
+} // namespace chess
+
+#endif
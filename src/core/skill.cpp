@@ -0,0 +1,63 @@
+#include "skill.h"
+
+#include "search.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace chess {
+
+// Levels 1..19 search at most 1 + level / 2 plies and BASE_NODES << (level / 2) nodes.
+static const int64_t BASE_NODES = 400;
+
+// Score gaps beyond a pawn count as a pawn when randomising.
+static const int MAX_PUSH_GAP = 100;
+
+void SkillLevel::set_level(int new_level) {
+	level = std::max(MIN_LEVEL, std::min(new_level, MAX_LEVEL));
+}
+
+void SkillLevel::set_elo(int elo) {
+	elo = std::max(MIN_ELO, std::min(elo, MAX_ELO));
+	set_level(MIN_LEVEL + (elo - MIN_ELO) * (MAX_LEVEL - MIN_LEVEL) / (MAX_ELO - MIN_ELO));
+}
+
+void SkillLevel::apply(SearchLimits &limits) const {
+	if (!enabled()) {
+		return;
+	}
+	int max_depth = 1 + level / 2;
+	int64_t max_nodes = BASE_NODES << (level / 2);
+	limits.depth = limits.depth > 0 ? std::min(limits.depth, max_depth) : max_depth;
+	limits.nodes = limits.nodes > 0 ? std::min(limits.nodes, max_nodes) : max_nodes;
+	limits.multi_pv = std::max(limits.multi_pv, MULTI_PV);
+}
+
+// Each line's score gets a random push, larger for weaker levels and for lines further
+// behind the best; the line with the highest pushed score is played.
+const RootLine &SkillLevel::pick(const std::vector<RootLine> &lines, std::mt19937_64 &rng) const {
+	if (!enabled() || lines.size() < 2) {
+		return lines[0];
+	}
+	int weakness = 120 - 2 * level;
+	int top = lines[0].score;
+	int gap = std::min(top - lines.back().score, MAX_PUSH_GAP);
+	size_t chosen = 0;
+	int64_t best_value = INT64_MIN;
+	for (size_t i = 0; i < lines.size(); i++) {
+		// Never trade a forced mate or tablebase result for a random pick.
+		if (std::abs(lines[i].score) >= TB_WIN_IN_MAX_PLY || std::abs(top) >= TB_WIN_IN_MAX_PLY) {
+			continue;
+		}
+		int64_t push = ((int64_t)weakness * (top - lines[i].score) + (int64_t)gap * (int64_t)(rng() % weakness)) / 128;
+		int64_t value = lines[i].score + push;
+		if (value > best_value) {
+			best_value = value;
+			chosen = i;
+		}
+	}
+	return lines[chosen];
+}
+
+} // namespace chess
@@ -0,0 +1,46 @@
+#ifndef CHESS_CORE_SKILL_H
+#define CHESS_CORE_SKILL_H
+
+#include "types.h"
+
+#include <random>
+#include <vector>
+
+namespace chess {
+
+struct SearchLimits;
+struct RootLine;
+
+// Strength limit. Below MAX_LEVEL the search is capped in depth and nodes (so weak play is
+// also cheap) and the move is drawn among the best few multi-PV lines, favouring moves
+// close to the best one; the lower the level, the larger the mistakes it accepts.
+class SkillLevel {
+public:
+	static constexpr int MIN_LEVEL = 1;
+	static constexpr int MAX_LEVEL = 20; // Full strength: no caps, always the best move.
+	static constexpr int MIN_ELO = 800;
+	static constexpr int MAX_ELO = 2800;
+	static constexpr int MULTI_PV = 4;   // Lines searched to choose from.
+
+private:
+	int level;
+
+public:
+	SkillLevel() : level(MAX_LEVEL) {}
+
+	void set_level(int new_level);
+	// Maps MIN_ELO..MAX_ELO linearly onto the levels, 100 Elo per level.
+	void set_elo(int elo);
+	int get_level() const { return level; }
+	bool enabled() const { return level < MAX_LEVEL; }
+
+	// Tighten the depth and node limits and ask for enough lines to choose from.
+	void apply(SearchLimits &limits) const;
+
+	// The move to play from the lines (best first) of the last completed iteration.
+	const RootLine &pick(const std::vector<RootLine> &lines, std::mt19937_64 &rng) const;
+};
+
+} // namespace chess
+
+#endif
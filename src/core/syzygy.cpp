@@ -0,0 +1,1096 @@
+#include "syzygy.h"
+
+#include "movegen.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+// Decoder for the Syzygy format by Ronald de Man. A table file holds, per side to move and
+// (with pawns) per file of the leading pawn, a stream of values indexed by a canonical
+// encoding of the piece placement. The values are compressed by recursive pairing: the
+// stream is made of Huffman-coded symbols, each standing for a pair of shorter symbols,
+// down to single values. Squares inside this file use the tablebase numbering, a1 = 0 and
+// h8 = 63 (the core numbers a8 = 0), and pieces the tablebase codes: 1-6 for white
+// P, N, B, R, Q, K and 9-14 for black.
+
+namespace chess {
+
+namespace {
+
+const uint8_t WDL_MAGIC[4] = { 0x71, 0xE8, 0x23, 0x5D };
+const uint8_t DTZ_MAGIC[4] = { 0xD7, 0x66, 0x0C, 0xA5 };
+
+// Per-table flags in the file.
+enum TableFlag { FLAG_STM = 1, FLAG_MAPPED = 2, FLAG_WIN_PLIES = 4, FLAG_LOSS_PLIES = 8, FLAG_WIDE = 16, FLAG_SINGLE_VALUE = 128 };
+
+enum ProbeState { PROBE_FAIL = 0, PROBE_OK = 1, PROBE_CHANGE_STM = -1, PROBE_ZEROING_BEST_MOVE = 2 };
+
+// Root ranking scale: certain wins rank near MAX_DTZ, wins spoilt by the fifty-move rule near MAX_DTZ / 2.
+const int MAX_DTZ = 1 << 18;
+
+const int TB_PIECE_OF_TYPE[6] = { 1, 4, 2, 3, 5, 6 }; // PieceType order P, R, N, B, Q, K
+
+inline int tb_square(Square square) { return square ^ 56; }
+inline int tb_piece(Piece piece) { return TB_PIECE_OF_TYPE[type_of(piece)] + color_of(piece) * 8; }
+inline int tb_rank(int square) { return square >> 3; }
+inline int tb_file(int square) { return square & 7; }
+inline int off_a1h8(int square) { return tb_rank(square) - tb_file(square); }
+inline int flip_file(int square) { return square ^ 7; }
+inline int flip_rank(int square) { return square ^ 56; }
+inline int edge_distance(int file) { return std::min(file, 7 - file); }
+
+inline uint16_t read_le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+inline uint32_t read_le32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+inline uint32_t read_be32(const uint8_t *p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]; }
+inline uint64_t read_be64(const uint8_t *p) { return ((uint64_t)read_be32(p) << 32) | read_be32(p + 4); }
+
+// Whether count items of size bytes starting at data lie before end.
+inline bool fits(const uint8_t *data, const uint8_t *end, uint64_t count, uint64_t size = 1) {
+	return data <= end && count <= (uint64_t)(end - data) / size;
+}
+
+template <typename T>
+int sign_of(T value) {
+	return (T(0) < value) - (value < T(0));
+}
+
+// Material signature: four bits of count per color and piece type.
+uint64_t material_key(const int counts[2][6]) {
+	uint64_t key = 0;
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < 6; type++) {
+			key |= (uint64_t)counts[color][type] << (4 * (color * 6 + type));
+		}
+	}
+	return key;
+}
+
+uint64_t material_key(const Position &pos) {
+	int counts[2][6];
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < 6; type++) {
+			counts[color][type] = popcount(pos.pieces(color, type));
+		}
+	}
+	return material_key(counts);
+}
+
+// Index tables of the placement encoding, built once.
+struct EncodingTables {
+	int map_b1h1h7[64];          // Squares below the a1-h8 diagonal -> 0..27
+	int map_a1d1d4[64];          // The a1-d1-d4 triangle -> 0..9, diagonal squares last
+	int map_kk[10][64];          // The 462 king pairs with the first king in the triangle
+	int map_pawns[64];           // a2-h7 -> 0..47, higher for pawns nearer the edge and lower
+	int lead_pawn_index[6][64];  // [leading pawn count][square]
+	int lead_pawns_size[6][4];   // [leading pawn count][file a..d]
+	uint64_t binomial[7][64];    // binomial[k][n] = n choose k
+
+	EncodingTables() {
+		std::memset(this, 0, sizeof(*this));
+
+		int code = 0;
+		for (int s = 0; s < 64; s++) {
+			if (off_a1h8(s) < 0) {
+				map_b1h1h7[s] = code++;
+			}
+		}
+
+		std::vector<int> diagonal;
+		code = 0;
+		for (int s = 0; s <= 27; s++) { // a1 .. d4
+			if (off_a1h8(s) < 0 && tb_file(s) <= 3) {
+				map_a1d1d4[s] = code++;
+			} else if (off_a1h8(s) == 0 && tb_file(s) <= 3) {
+				diagonal.push_back(s);
+			}
+		}
+		for (int s : diagonal) {
+			map_a1d1d4[s] = code++;
+		}
+
+		std::vector<std::pair<int, int>> both_on_diagonal;
+		code = 0;
+		for (int index = 0; index < 10; index++) {
+			for (int s1 = 0; s1 <= 27; s1++) {
+				// b1 is the only square mapped to 0; the others only look like it.
+				if (map_a1d1d4[s1] != index || (index == 0 && s1 != 1)) {
+					continue;
+				}
+				for (int s2 = 0; s2 < 64; s2++) {
+					bool touching = std::abs(tb_file(s1) - tb_file(s2)) <= 1 && std::abs(tb_rank(s1) - tb_rank(s2)) <= 1;
+					if (touching) {
+						continue;
+					}
+					if (off_a1h8(s1) == 0 && off_a1h8(s2) > 0) {
+						continue; // First on the diagonal, second above it: a mirror image.
+					}
+					if (off_a1h8(s1) == 0 && off_a1h8(s2) == 0) {
+						both_on_diagonal.push_back(std::make_pair(index, s2));
+					} else {
+						map_kk[index][s2] = code++;
+					}
+				}
+			}
+		}
+		for (const auto &pair : both_on_diagonal) {
+			map_kk[pair.first][pair.second] = code++;
+		}
+
+		binomial[0][0] = 1;
+		for (int n = 1; n < 64; n++) {
+			for (int k = 0; k < 7 && k <= n; k++) {
+				binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+			}
+		}
+
+		int available = 47;
+		for (int lead_count = 1; lead_count <= 5; lead_count++) {
+			for (int file = 0; file <= 3; file++) {
+				int index = 0;
+				for (int rank = 1; rank <= 6; rank++) {
+					int square = rank * 8 + file;
+					if (lead_count == 1) {
+						map_pawns[square] = available--;
+						map_pawns[flip_file(square)] = available--;
+					}
+					lead_pawn_index[lead_count][square] = index;
+					index += (int)binomial[lead_count - 1][map_pawns[square]];
+				}
+				lead_pawns_size[lead_count][file] = index;
+			}
+		}
+	}
+};
+
+const EncodingTables &encoding() {
+	static const EncodingTables tables;
+	return tables;
+}
+
+bool pawns_before(int a, int b) {
+	return encoding().map_pawns[a] < encoding().map_pawns[b];
+}
+
+// A distance-to-zero table has no entry for zeroing moves; the value one ply before them
+// follows from the result alone.
+int dtz_before_zeroing(WdlScore wdl) {
+	return wdl == WDL_WIN ? 1 : wdl == WDL_CURSED_WIN ? 101 : wdl == WDL_BLESSED_LOSS ? -101 : wdl == WDL_LOSS ? -1 : 0;
+}
+
+bool is_zeroing(const Position &pos, Move move) {
+	return pos.is_capture(move) || type_of(pos.piece_on(move_from(move))) == PAWN;
+}
+
+bool is_checkmate(Position &pos) {
+	if (!pos.in_check()) {
+		return false;
+	}
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	return moves.size == 0;
+}
+
+} // namespace
+
+// Decoding data for one sub-table (side to move, leading pawn file), pointing into the mapping.
+struct Tablebases::PairsData {
+	uint8_t flags = 0;
+	int max_sym_len = 0;
+	int min_sym_len = 0;        // With FLAG_SINGLE_VALUE: the value itself.
+	uint32_t block_count = 0;
+	size_t block_size = 0;
+	size_t span = 0;            // One sparse index entry every span values.
+	const uint8_t *lowest_sym = nullptr; // uint16 LE per symbol length
+	const uint8_t *btree = nullptr;      // 3 bytes per symbol: left and right child, 12 bits each
+	const uint8_t *block_lengths = nullptr; // uint16 LE per block: stored values - 1
+	uint32_t block_lengths_size = 0;
+	const uint8_t *sparse_index = nullptr;  // 6 bytes per entry: block (LE32), offset (LE16)
+	size_t sparse_index_size = 0;
+	const uint8_t *data = nullptr;
+	const uint8_t *data_end = nullptr;
+	uint64_t table_size = 0;
+	std::vector<uint64_t> base64;  // Lowest code of each length, left-aligned in 64 bits.
+	std::vector<uint8_t> sym_len;  // Values per symbol - 1.
+	int pieces[MAX_PIECES] = {};   // Order in which the pieces are encoded.
+	uint64_t group_index[MAX_PIECES + 1] = {};
+	int group_len[MAX_PIECES + 1] = {};
+	uint16_t map_index[4] = {};    // DTZ value maps for win, loss, cursed win, blessed loss.
+
+	int left(int sym) const {
+		const uint8_t *lr = btree + 3 * sym;
+		return ((lr[1] & 0xF) << 8) | lr[0];
+	}
+	int right(int sym) const {
+		const uint8_t *lr = btree + 3 * sym;
+		return (lr[2] << 4) | (lr[1] >> 4);
+	}
+};
+
+struct Tablebases::Table {
+	std::string path; // Without extension.
+	uint64_t key = 0;  // Material with the stronger side (the first in the name) as White...
+	uint64_t key2 = 0; // ...and as Black.
+	int piece_count = 0;
+	bool has_pawns = false;
+	bool has_unique_pieces = false;
+	int pawn_count[2] = { 0, 0 }; // Leading color, other color.
+
+	struct File {
+		MappedFile file;
+		std::atomic<bool> ready{ false };
+		bool usable = false;
+		const uint8_t *map = nullptr;    // DTZ value maps.
+		size_t map_size = 0;
+		PairsData items[2][4];           // [side to move][leading pawn file]
+	};
+	File wdl;
+	File dtz;
+
+	// DTZ tables store one side to move only.
+	PairsData *get(bool is_dtz, int stm, int file) {
+		File &part = is_dtz ? dtz : wdl;
+		return &part.items[is_dtz ? 0 : stm % 2][has_pawns ? file : 0];
+	}
+};
+
+namespace {
+
+typedef Tablebases::PairsData PairsData;
+typedef Tablebases::Table Table;
+
+// Group pieces that are encoded together, and the index multiplier of each group. False if
+// the file's piece list makes groups the encoding cannot index.
+bool set_groups(const Table &table, PairsData *d, const int order[2], int file) {
+	const EncodingTables &enc = encoding();
+	int n = 0;
+	int first_len = table.has_pawns ? 0 : table.has_unique_pieces ? 3 : 2;
+	d->group_len[n] = 1;
+
+	// Pieces of one type and color form a group; without pawns the leading group is the
+	// first three pieces (or just the kings when no piece is unique).
+	for (int i = 1; i < table.piece_count; i++) {
+		if (--first_len > 0 || d->pieces[i] == d->pieces[i - 1]) {
+			d->group_len[n]++;
+		} else {
+			d->group_len[++n] = 1;
+		}
+	}
+	d->group_len[++n] = 0;
+	for (int i = 0; i < n; i++) {
+		if (d->group_len[i] > (table.has_pawns && i == 0 ? 5 : 6)) {
+			return false;
+		}
+	}
+
+	// The order in which groups are combined is stored per table: order[0] is the leading
+	// group, order[1] the other side's pawns when both sides have some.
+	bool both_pawns = table.has_pawns && table.pawn_count[1] > 0;
+	int next = both_pawns ? 2 : 1;
+	int free_squares = 64 - d->group_len[0] - (both_pawns ? d->group_len[1] : 0);
+	uint64_t index = 1;
+
+	for (int k = 0; next < n || k == order[0] || k == order[1]; k++) {
+		if (k == order[0]) {
+			d->group_index[0] = index;
+			index *= table.has_pawns ? enc.lead_pawns_size[d->group_len[0]][file] : table.has_unique_pieces ? 31332 : 462;
+		} else if (k == order[1]) {
+			d->group_index[1] = index;
+			index *= enc.binomial[d->group_len[1]][48 - d->group_len[0]];
+		} else {
+			d->group_index[next] = index;
+			index *= enc.binomial[d->group_len[next]][free_squares];
+			free_squares -= d->group_len[next++];
+		}
+	}
+	d->group_index[n] = index;
+	return true;
+}
+
+// Values per symbol, by expanding each symbol into its two children down to the leaves.
+// state is 0 for symbols not seen yet, 1 while expanding and 2 when done. False when a pair
+// refers to a missing symbol or to itself, or expands to more values than a symbol holds.
+bool set_sym_len(PairsData *d, int sym, std::vector<uint8_t> &state) {
+	state[sym] = 1;
+	int right = d->right(sym);
+	if (right == 0xFFF) {
+		d->sym_len[sym] = 0;
+		state[sym] = 2;
+		return true;
+	}
+	int left = d->left(sym);
+	int count = (int)d->sym_len.size();
+	if (left >= count || right >= count || state[left] == 1 || state[right] == 1) {
+		return false;
+	}
+	if ((state[left] == 0 && !set_sym_len(d, left, state)) || (state[right] == 0 && !set_sym_len(d, right, state))) {
+		return false;
+	}
+	int len = d->sym_len[left] + d->sym_len[right] + 1;
+	if (len > 0xFF) {
+		return false;
+	}
+	d->sym_len[sym] = (uint8_t)len;
+	state[sym] = 2;
+	return true;
+}
+
+// Huffman and block layout of one sub-table; returns the data that follows it, or nullptr
+// if the layout does not fit before end or cannot be decoded.
+const uint8_t *set_sizes(PairsData *d, const uint8_t *data, const uint8_t *end) {
+	int groups = 0;
+	while (d->group_len[groups] != 0) {
+		groups++;
+	}
+	d->table_size = d->group_index[groups];
+
+	if (!fits(data, end, 2)) {
+		return nullptr;
+	}
+	d->flags = *data++;
+	if (d->flags & FLAG_SINGLE_VALUE) {
+		d->block_count = 0;
+		d->span = 0;
+		d->block_lengths_size = 0;
+		d->sparse_index_size = 0;
+		d->min_sym_len = *data++;
+		return data;
+	}
+
+	// Block size and span, padding, block count, longest and shortest code.
+	if (!fits(data, end, 9) || data[0] >= 32 || data[1] >= 32) {
+		return nullptr;
+	}
+	d->block_size = (size_t)1 << *data++;
+	d->span = (size_t)1 << *data++;
+	d->sparse_index_size = (size_t)((d->table_size + d->span - 1) / d->span);
+	uint8_t padding = *data++;
+	d->block_count = read_le32(data);
+	data += 4;
+	d->block_lengths_size = d->block_count + padding; // Keeps the sparse index in range.
+	d->max_sym_len = *data++;
+	d->min_sym_len = *data++;
+	// The decoder keeps at least 32 bits buffered, enough for any one code.
+	if (d->min_sym_len < 1 || d->max_sym_len < d->min_sym_len || d->max_sym_len > 32) {
+		return nullptr;
+	}
+	d->lowest_sym = data;
+	d->base64.assign(d->max_sym_len - d->min_sym_len + 1, 0);
+	if (!fits(data, end, d->base64.size() + 1, 2)) {
+		return nullptr;
+	}
+
+	// Canonical Huffman: longer codes have lower values, so the lowest code of each length,
+	// left-aligned in 64 bits, decreases with the length.
+	for (int i = (int)d->base64.size() - 2; i >= 0; i--) {
+		d->base64[i] = (d->base64[i + 1] + read_le16(d->lowest_sym + 2 * i) - read_le16(d->lowest_sym + 2 * (i + 1))) / 2;
+	}
+	for (size_t i = 0; i < d->base64.size(); i++) {
+		d->base64[i] <<= 64 - i - d->min_sym_len;
+	}
+
+	data += d->base64.size() * 2;
+	d->sym_len.assign(read_le16(data), 0);
+	data += 2;
+	d->btree = data;
+	if (d->sym_len.empty() || d->sym_len.size() >= 0xFFF || !fits(data, end, d->sym_len.size() * 3 + (d->sym_len.size() & 1))) {
+		return nullptr;
+	}
+
+	std::vector<uint8_t> state(d->sym_len.size(), 0);
+	for (size_t sym = 0; sym < d->sym_len.size(); sym++) {
+		if (state[sym] == 0 && !set_sym_len(d, (int)sym, state)) {
+			return nullptr;
+		}
+	}
+	return data + d->sym_len.size() * 3 + (d->sym_len.size() & 1);
+}
+
+// Value at index idx of a sub-table, or -1 where the file's contents lead outside it.
+int decompress_pairs(const PairsData *d, uint64_t idx) {
+	if (d->flags & FLAG_SINGLE_VALUE) {
+		return d->min_sym_len;
+	}
+	if (idx >= d->table_size) {
+		return -1;
+	}
+
+	// The sparse index gives a block and offset near idx; walk the block lengths from there.
+	uint64_t k = idx / d->span;
+	uint32_t block = read_le32(d->sparse_index + 6 * k);
+	int offset = read_le16(d->sparse_index + 6 * k + 4);
+	offset += (int)(idx % d->span) - (int)(d->span / 2);
+
+	while (offset < 0) {
+		if (block == 0 || block > d->block_lengths_size) {
+			return -1;
+		}
+		offset += read_le16(d->block_lengths + 2 * (--block)) + 1;
+	}
+	while (true) {
+		if (block >= d->block_lengths_size) {
+			return -1;
+		}
+		if (offset <= read_le16(d->block_lengths + 2 * block)) {
+			break;
+		}
+		offset -= read_le16(d->block_lengths + 2 * block++) + 1;
+	}
+
+	// Decode symbols from the start of the block until the one covering offset.
+	const uint8_t *ptr = d->data + (uint64_t)block * d->block_size;
+	if (block >= d->block_count || !fits(ptr, d->data_end, 8)) {
+		return -1;
+	}
+	uint64_t buffer = read_be64(ptr);
+	ptr += 8;
+	int buffer_bits = 64;
+	int sym;
+
+	while (true) {
+		int len = 0;
+		while (buffer < d->base64[len]) {
+			len++;
+		}
+		sym = (int)((buffer - d->base64[len]) >> (64 - len - d->min_sym_len));
+		sym += read_le16(d->lowest_sym + 2 * len);
+		if (sym < 0 || sym >= (int)d->sym_len.size()) {
+			return -1;
+		}
+
+		if (offset < d->sym_len[sym] + 1) {
+			break;
+		}
+		offset -= d->sym_len[sym] + 1;
+		len += d->min_sym_len;
+		buffer <<= len;
+		buffer_bits -= len;
+		if (buffer_bits <= 32) {
+			if (!fits(ptr, d->data_end, 4)) {
+				return -1;
+			}
+			buffer_bits += 32;
+			buffer |= (uint64_t)read_be32(ptr) << (64 - buffer_bits);
+			ptr += 4;
+		}
+	}
+
+	// The symbol stands for sym_len + 1 values: descend the pair tree to the one at offset.
+	while (d->sym_len[sym] != 0) {
+		int left = d->left(sym);
+		if (offset < d->sym_len[left] + 1) {
+			sym = left;
+		} else {
+			offset -= d->sym_len[left] + 1;
+			sym = d->right(sym);
+		}
+	}
+	return d->left(sym);
+}
+
+// Returns the data after the maps, or nullptr if they do not fit before end.
+const uint8_t *set_dtz_map(Table &table, const uint8_t *data, const uint8_t *end, int max_file) {
+	table.dtz.map = data;
+	for (int file = 0; file <= max_file; file++) {
+		PairsData *d = table.get(true, 0, file);
+		if (!(d->flags & FLAG_MAPPED)) {
+			continue;
+		}
+		if (d->flags & FLAG_WIDE) {
+			data += (uintptr_t)data & 1;
+			for (int i = 0; i < 4; i++) {
+				if (!fits(data, end, 1, 2) || !fits(data + 2, end, read_le16(data), 2)) {
+					return nullptr;
+				}
+				d->map_index[i] = (uint16_t)((data - table.dtz.map) / 2 + 1);
+				data += 2 * read_le16(data) + 2;
+			}
+		} else {
+			for (int i = 0; i < 4; i++) {
+				if (!fits(data, end, 1) || !fits(data + 1, end, *data)) {
+					return nullptr;
+				}
+				d->map_index[i] = (uint16_t)(data - table.dtz.map + 1);
+				data += *data + 1;
+			}
+		}
+	}
+	table.dtz.map_size = data - table.dtz.map;
+	return data + ((uintptr_t)data & 1);
+}
+
+// Fill the sub-table records of a freshly mapped file (data points past the magic). False if
+// any section, as its header describes it, does not fit before end.
+bool init_table_file(Table &table, bool is_dtz, const uint8_t *data, const uint8_t *end) {
+	if (!fits(data, end, 1)) {
+		return false;
+	}
+	data++; // Flags: split (two sides to move) and has pawns, both known from the name.
+
+	const int sides = !is_dtz && table.key != table.key2 ? 2 : 1;
+	const int max_file = table.has_pawns ? 3 : 0;
+	const bool both_pawns = table.has_pawns && table.pawn_count[1] > 0;
+
+	for (int file = 0; file <= max_file; file++) {
+		for (int i = 0; i < sides; i++) {
+			*table.get(is_dtz, i, file) = PairsData();
+		}
+		if (!fits(data, end, 1 + both_pawns + table.piece_count)) {
+			return false;
+		}
+		int order[2][2] = { { *data & 0xF, both_pawns ? *(data + 1) & 0xF : 0xF },
+			{ *data >> 4, both_pawns ? *(data + 1) >> 4 : 0xF } };
+		data += 1 + both_pawns;
+
+		for (int k = 0; k < table.piece_count; k++, data++) {
+			for (int i = 0; i < sides; i++) {
+				table.get(is_dtz, i, file)->pieces[k] = i ? *data >> 4 : *data & 0xF;
+			}
+		}
+		for (int i = 0; i < sides; i++) {
+			if (!set_groups(table, table.get(is_dtz, i, file), order[i], file)) {
+				return false;
+			}
+		}
+	}
+
+	data += (uintptr_t)data & 1;
+
+	for (int file = 0; file <= max_file; file++) {
+		for (int i = 0; i < sides; i++) {
+			data = set_sizes(table.get(is_dtz, i, file), data, end);
+			if (data == nullptr) {
+				return false;
+			}
+		}
+	}
+	if (is_dtz) {
+		data = set_dtz_map(table, data, end, max_file);
+		if (data == nullptr) {
+			return false;
+		}
+	}
+	for (int file = 0; file <= max_file; file++) {
+		for (int i = 0; i < sides; i++) {
+			PairsData *d = table.get(is_dtz, i, file);
+			if (!fits(data, end, d->sparse_index_size, 6)) {
+				return false;
+			}
+			d->sparse_index = data;
+			data += d->sparse_index_size * 6;
+		}
+	}
+	for (int file = 0; file <= max_file; file++) {
+		for (int i = 0; i < sides; i++) {
+			PairsData *d = table.get(is_dtz, i, file);
+			if (!fits(data, end, d->block_lengths_size, 2)) {
+				return false;
+			}
+			d->block_lengths = data;
+			data += d->block_lengths_size * 2;
+		}
+	}
+	for (int file = 0; file <= max_file; file++) {
+		for (int i = 0; i < sides; i++) {
+			data = (const uint8_t *)(((uintptr_t)data + 0x3F) & ~(uintptr_t)0x3F);
+			PairsData *d = table.get(is_dtz, i, file);
+			if (d->block_count > 0 && !fits(data, end, d->block_count, d->block_size)) {
+				return false;
+			}
+			d->data = data;
+			data += (size_t)d->block_count * d->block_size;
+			d->data_end = data;
+		}
+	}
+	return true;
+}
+
+// DTZ values are stored in moves unless the table says plies, and through a value map.
+// -1 if the value lies outside the map.
+int map_dtz_score(Table &table, int file, int value, WdlScore wdl) {
+	static const int WDL_MAP[] = { 1, 3, 0, 2, 0 };
+	const PairsData *d = table.get(true, 0, file);
+	if (d->flags & FLAG_MAPPED) {
+		size_t index = (size_t)d->map_index[WDL_MAP[wdl + 2]] + value;
+		if ((d->flags & FLAG_WIDE) ? 2 * index + 2 > table.dtz.map_size : index >= table.dtz.map_size) {
+			return -1;
+		}
+		value = (d->flags & FLAG_WIDE) ? read_le16(table.dtz.map + 2 * index) : table.dtz.map[index];
+	}
+	if ((wdl == WDL_WIN && !(d->flags & FLAG_WIN_PLIES)) || (wdl == WDL_LOSS && !(d->flags & FLAG_LOSS_PLIES)) ||
+			wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS) {
+		value *= 2;
+	}
+	return value + 1;
+}
+
+} // namespace
+
+Tablebases::Tablebases() : largest(0) {}
+
+Tablebases::~Tablebases() {}
+
+void Tablebases::clear() {
+	std::lock_guard<std::mutex> lock(map_mutex);
+	by_material.clear();
+	tables.clear();
+	largest = 0;
+}
+
+// Table names list the pieces of each side strongest first, e.g. KRPvKR.
+static bool parse_table_name(const std::string &name, int counts[2][6]) {
+	static const char LETTERS[] = "PRNBQK"; // PieceType order
+	std::memset(counts, 0, sizeof(int) * 12);
+	int side = 0;
+	for (size_t i = 0; i < name.size(); i++) {
+		if (name[i] == 'v') {
+			if (side == 1 || i == 0) {
+				return false;
+			}
+			side = 1;
+			continue;
+		}
+		const char *letter = std::strchr(LETTERS, name[i]);
+		if (letter == nullptr || *letter == '\0') {
+			return false;
+		}
+		counts[side][letter - LETTERS]++;
+	}
+	return side == 1 && counts[WHITE][KING] == 1 && counts[BLACK][KING] == 1;
+}
+
+int Tablebases::init(const std::string &paths) {
+	clear();
+#if defined(_WIN32)
+	const char separator = ';';
+#else
+	const char separator = paths.find(';') != std::string::npos ? ';' : ':';
+#endif
+
+	size_t start = 0;
+	while (start <= paths.size()) {
+		size_t end = paths.find(separator, start);
+		if (end == std::string::npos) {
+			end = paths.size();
+		}
+		std::string directory = paths.substr(start, end - start);
+		start = end + 1;
+		if (directory.empty()) {
+			continue;
+		}
+
+		std::error_code error;
+		for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+			std::string file_name = it->path().filename().string();
+			const std::string extension = ".rtbw";
+			if (file_name.size() <= extension.size() ||
+					file_name.compare(file_name.size() - extension.size(), extension.size(), extension) != 0) {
+				continue;
+			}
+			std::string name = file_name.substr(0, file_name.size() - extension.size());
+			int counts[2][6];
+			if (!parse_table_name(name, counts)) {
+				continue;
+			}
+
+			std::unique_ptr<Table> table(new Table());
+			table->path = (std::filesystem::path(directory) / name).string();
+			for (int color = 0; color < 2; color++) {
+				for (int type = 0; type < 6; type++) {
+					table->piece_count += counts[color][type];
+					table->has_unique_pieces |= type != KING && counts[color][type] == 1;
+				}
+			}
+			if (table->piece_count > MAX_PIECES) {
+				continue;
+			}
+			table->key = material_key(counts);
+			std::swap(counts[WHITE], counts[BLACK]);
+			table->key2 = material_key(counts);
+			std::swap(counts[WHITE], counts[BLACK]);
+			if (by_material.count(table->key) != 0) {
+				continue; // Found in an earlier directory.
+			}
+
+			// The leading color is the one with fewer pawns, if both have some.
+			int white_pawns = counts[WHITE][PAWN];
+			int black_pawns = counts[BLACK][PAWN];
+			table->has_pawns = white_pawns + black_pawns > 0;
+			bool white_leads = black_pawns == 0 || (white_pawns > 0 && black_pawns >= white_pawns);
+			table->pawn_count[0] = white_leads ? white_pawns : black_pawns;
+			table->pawn_count[1] = white_leads ? black_pawns : white_pawns;
+
+			largest = std::max(largest, table->piece_count);
+			by_material[table->key] = table.get();
+			by_material[table->key2] = table.get();
+			tables.push_back(std::move(table));
+		}
+	}
+	return (int)tables.size();
+}
+
+bool Tablebases::can_probe(const Position &pos) const {
+	return largest > 0 && pos.castling_rights() == 0 && popcount(pos.occupied()) <= largest;
+}
+
+Tablebases::Table *Tablebases::find(const Position &pos) const {
+	auto it = by_material.find(material_key(pos));
+	return it == by_material.end() ? nullptr : it->second;
+}
+
+// Map a table file on first use; later calls only read the ready flag.
+bool Tablebases::map_table(Table &table, bool dtz) const {
+	Table::File &part = dtz ? table.dtz : table.wdl;
+	if (part.ready.load(std::memory_order_acquire)) {
+		return part.usable;
+	}
+	std::lock_guard<std::mutex> lock(map_mutex);
+	if (part.ready.load(std::memory_order_relaxed)) {
+		return part.usable;
+	}
+	const uint8_t *magic = dtz ? DTZ_MAGIC : WDL_MAGIC;
+	// Every section the headers describe must lie inside the file: a truncated or damaged
+	// table is treated as missing rather than read past the mapping.
+	part.usable = part.file.open(table.path + (dtz ? ".rtbz" : ".rtbw")) && part.file.size() > 4 &&
+			std::memcmp(part.file.data(), magic, 4) == 0 &&
+			init_table_file(table, dtz, part.file.data() + 4, part.file.data() + part.file.size());
+	if (!part.usable) {
+		part.file.close();
+	}
+	part.ready.store(true, std::memory_order_release);
+	return part.usable;
+}
+
+// Encode the placement of pos into a sub-table index and read the stored value
+// (WDL: the score, DTZ: plies to zeroing). state becomes PROBE_CHANGE_STM when a
+// one-sided DTZ table only has the other side to move.
+int Tablebases::probe_table(const Position &pos, bool dtz, WdlScore wdl, int &state) const {
+	if (popcount(pos.occupied()) == 2) {
+		return WDL_DRAW; // Bare kings.
+	}
+	Table *entry = find(pos);
+	if (entry == nullptr || !map_table(*entry, dtz)) {
+		state = PROBE_FAIL;
+		return 0;
+	}
+
+	const EncodingTables &enc = encoding();
+	int squares[MAX_PIECES];
+	int pieces[MAX_PIECES];
+	int size = 0;
+	int lead_pawn_count = 0;
+	Bitboard lead_pawns = 0;
+	int file = 0;
+	uint64_t idx;
+
+	// Tables are built with the stronger side as White, and symmetric ones with White to
+	// move only; anything else is looked up with colors swapped and the board mirrored.
+	bool symmetric_black_to_move = entry->key == entry->key2 && pos.side_to_move() == BLACK;
+	bool black_stronger = material_key(pos) != entry->key;
+	bool flip = symmetric_black_to_move || black_stronger;
+	int flip_color = flip ? 8 : 0;
+	int flip_squares = flip ? 56 : 0;
+	int stm = flip ^ pos.side_to_move();
+
+	// With pawns, the sub-table is chosen by the file of the leading pawn: the one with the
+	// highest map_pawns value, nearest the edge and lowest.
+	if (entry->has_pawns) {
+		int lead_color = (entry->get(dtz, 0, 0)->pieces[0] ^ flip_color) >> 3;
+		Bitboard b = lead_pawns = pos.pieces(lead_color, PAWN);
+		if (b == 0) {
+			state = PROBE_FAIL; // Damaged table: its leading piece is not a pawn of pos.
+			return 0;
+		}
+		do {
+			squares[size++] = tb_square(pop_lsb(b)) ^ flip_squares;
+		} while (b);
+		lead_pawn_count = size;
+		std::swap(squares[0], *std::max_element(squares, squares + lead_pawn_count, pawns_before));
+		file = edge_distance(tb_file(squares[0]));
+	}
+
+	if (dtz) {
+		int flags = entry->get(true, stm, file)->flags;
+		if ((flags & FLAG_STM) != stm && !(entry->key == entry->key2 && !entry->has_pawns)) {
+			state = PROBE_CHANGE_STM;
+			return 0;
+		}
+	}
+
+	Bitboard b = pos.occupied() ^ lead_pawns;
+	do {
+		Square square = pop_lsb(b);
+		squares[size] = tb_square(square) ^ flip_squares;
+		pieces[size++] = tb_piece(pos.piece_on(square)) ^ flip_color;
+	} while (b);
+
+	PairsData *d = entry->get(dtz, stm, file);
+
+	// Put the pieces in the table's order.
+	for (int i = lead_pawn_count; i < size - 1; i++) {
+		for (int j = i + 1; j < size; j++) {
+			if (d->pieces[i] == pieces[j]) {
+				std::swap(pieces[i], pieces[j]);
+				std::swap(squares[i], squares[j]);
+				break;
+			}
+		}
+	}
+
+	// The leading piece goes to files a-d.
+	if (tb_file(squares[0]) > 3) {
+		for (int i = 0; i < size; i++) {
+			squares[i] = flip_file(squares[i]);
+		}
+	}
+
+	if (entry->has_pawns) {
+		idx = enc.lead_pawn_index[lead_pawn_count][squares[0]];
+		std::stable_sort(squares + 1, squares + lead_pawn_count, pawns_before);
+		for (int i = 1; i < lead_pawn_count; i++) {
+			idx += enc.binomial[i][enc.map_pawns[squares[i]]];
+		}
+	} else {
+		// Without pawns the leading piece also goes to ranks 1-4 and below the a1-h8 diagonal.
+		if (tb_rank(squares[0]) > 3) {
+			for (int i = 0; i < size; i++) {
+				squares[i] = flip_rank(squares[i]);
+			}
+		}
+		for (int i = 0; i < d->group_len[0]; i++) {
+			if (off_a1h8(squares[i]) == 0) {
+				continue;
+			}
+			if (off_a1h8(squares[i]) > 0) {
+				for (int j = i; j < size; j++) {
+					squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+				}
+			}
+			break;
+		}
+
+		if (entry->has_unique_pieces) {
+			// Three unique pieces (kings included) are encoded together.
+			int adjust1 = squares[1] > squares[0];
+			int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+			if (off_a1h8(squares[0])) {
+				idx = ((uint64_t)enc.map_a1d1d4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+			} else if (off_a1h8(squares[1])) {
+				idx = ((uint64_t)6 * 63 + tb_rank(squares[0]) * 28 + enc.map_b1h1h7[squares[1]]) * 62 + squares[2] - adjust2;
+			} else if (off_a1h8(squares[2])) {
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + tb_rank(squares[0]) * 7 * 28 + (tb_rank(squares[1]) - adjust1) * 28 +
+						enc.map_b1h1h7[squares[2]];
+			} else {
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + tb_rank(squares[0]) * 6 * 4 + (tb_rank(squares[1]) - adjust1) * 4 +
+						tb_rank(squares[2]) - adjust2;
+			}
+		} else {
+			idx = enc.map_kk[enc.map_a1d1d4[squares[0]]][squares[1]];
+		}
+	}
+
+	// Remaining groups: ascending squares, skipping those taken by earlier groups.
+	idx *= d->group_index[0];
+	int *group_squares = squares + d->group_len[0];
+	bool remaining_pawns = entry->has_pawns && entry->pawn_count[1] > 0;
+	int next = 0;
+	while (d->group_len[++next] != 0) {
+		std::stable_sort(group_squares, group_squares + d->group_len[next]);
+		uint64_t n = 0;
+		for (int i = 0; i < d->group_len[next]; i++) {
+			int adjust = 0;
+			for (int *s = squares; s < group_squares; s++) {
+				adjust += group_squares[i] > *s;
+			}
+			n += enc.binomial[i + 1][group_squares[i] - adjust - 8 * remaining_pawns];
+		}
+		remaining_pawns = false;
+		idx += n * d->group_index[next];
+		group_squares += d->group_len[next];
+	}
+
+	int value = decompress_pairs(d, idx);
+	if (value >= 0 && dtz) {
+		value = map_dtz_score(*entry, file, value, wdl);
+	}
+	if (value < 0 || (!dtz && value > 4)) {
+		state = PROBE_FAIL; // Damaged table.
+		return 0;
+	}
+	return dtz ? value : value - 2;
+}
+
+// Tables may store anything for positions where a capture (or, for DTZ, a pawn move) is
+// best, so those moves are played out and the better of them and the stored value counts.
+WdlScore Tablebases::search(Position &pos, bool check_zeroing_moves, int &state) const {
+	WdlScore best = WDL_LOSS;
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	int zeroing_count = 0;
+
+	for (Move move : moves) {
+		if (!pos.is_capture(move) && (!check_zeroing_moves || type_of(pos.piece_on(move_from(move))) != PAWN)) {
+			continue;
+		}
+		zeroing_count++;
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		WdlScore value = (WdlScore)-search(pos, false, state);
+		pos.unmake_move(move, undo);
+		if (state == PROBE_FAIL) {
+			return WDL_DRAW;
+		}
+		if (value > best) {
+			best = value;
+			if (value >= WDL_WIN) {
+				state = PROBE_ZEROING_BEST_MOVE;
+				return value;
+			}
+		}
+	}
+
+	// When every legal move was just tried the stored value is not needed (nor reliable:
+	// tables ignore en passant rights).
+	bool no_more_moves = zeroing_count > 0 && zeroing_count == moves.size;
+	WdlScore value;
+	if (no_more_moves) {
+		value = best;
+	} else {
+		value = (WdlScore)probe_table(pos, false, WDL_DRAW, state);
+		if (state == PROBE_FAIL) {
+			return WDL_DRAW;
+		}
+	}
+
+	if (best >= value) {
+		state = best > WDL_DRAW || no_more_moves ? PROBE_ZEROING_BEST_MOVE : PROBE_OK;
+		return best;
+	}
+	state = PROBE_OK;
+	return value;
+}
+
+bool Tablebases::probe_wdl(Position &pos, WdlScore &wdl) const {
+	int state = PROBE_OK;
+	wdl = search(pos, false, state);
+	return state != PROBE_FAIL;
+}
+
+// Plies to the next capture or pawn move with best play, from the side to move's view:
+//   -1 mated, -100..-2 loss, 0 draw, 2..100 win, beyond +-100 a result the fifty-move rule
+//   turns into a draw. Can be one ply too long, never on the fifty-move edge.
+int Tablebases::dtz_value(Position &pos, int &state) const {
+	state = PROBE_OK;
+	WdlScore wdl = search(pos, true, state);
+	if (state == PROBE_FAIL || wdl == WDL_DRAW) {
+		return 0;
+	}
+	if (state == PROBE_ZEROING_BEST_MOVE) {
+		return dtz_before_zeroing(wdl);
+	}
+
+	int dtz = probe_table(pos, true, wdl, state);
+	if (state == PROBE_FAIL) {
+		return 0;
+	}
+	if (state != PROBE_CHANGE_STM) {
+		return (dtz + 100 * (wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN)) * sign_of((int)wdl);
+	}
+
+	// Only the other side to move is stored: one ply of search, best DTZ among the replies.
+	int min_dtz = 0xFFFF;
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	for (Move move : moves) {
+		bool zeroing = is_zeroing(pos, move);
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		if (zeroing) {
+			dtz = -dtz_before_zeroing(search(pos, false, state));
+		} else {
+			dtz = -dtz_value(pos, state);
+		}
+		if (dtz == 1 && is_checkmate(pos)) {
+			min_dtz = 1;
+		}
+		if (!zeroing) {
+			dtz += sign_of(dtz);
+		}
+		if (dtz < min_dtz && sign_of(dtz) == sign_of((int)wdl)) {
+			min_dtz = dtz;
+		}
+		pos.unmake_move(move, undo);
+		if (state == PROBE_FAIL) {
+			return 0;
+		}
+	}
+	return min_dtz == 0xFFFF ? -1 : min_dtz;
+}
+
+bool Tablebases::probe_dtz(Position &pos, int &dtz) const {
+	int state = PROBE_OK;
+	dtz = dtz_value(pos, state);
+	return state != PROBE_FAIL;
+}
+
+bool Tablebases::probe_root(Position &pos, std::vector<Move> &best_moves, int &score) const {
+	best_moves.clear();
+	if (!can_probe(pos)) {
+		return false;
+	}
+	const int halfmove = pos.get_halfmove_clock();
+	const bool repeated = pos.repetition_count() > 0;
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	if (moves.size == 0) {
+		return false;
+	}
+
+	int best_rank = -MAX_DTZ - 1;
+	for (Move move : moves) {
+		int state = PROBE_OK;
+		int dtz;
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		if (pos.get_halfmove_clock() == 0) {
+			dtz = dtz_before_zeroing((WdlScore)-search(pos, false, state));
+		} else if (pos.is_draw()) {
+			dtz = 0;
+		} else {
+			dtz = -dtz_value(pos, state);
+			dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : 0;
+		}
+		if (dtz == 2 && is_checkmate(pos)) {
+			dtz = 1;
+		}
+		pos.unmake_move(move, undo);
+		if (state == PROBE_FAIL) {
+			best_moves.clear();
+			return false;
+		}
+
+		// Faster certain wins rank higher, slower losses rank higher; results the fifty-move
+		// counter spoils rank between those and the draws.
+		int rank = dtz > 0 ? (dtz + halfmove <= 99 && !repeated ? MAX_DTZ - dtz : MAX_DTZ / 2 - (dtz + halfmove))
+				: dtz < 0 ? (-dtz * 2 + halfmove < 100 ? -MAX_DTZ - dtz : -MAX_DTZ / 2 + (-dtz + halfmove))
+				: 0;
+		if (rank > best_rank) {
+			best_rank = rank;
+			best_moves.clear();
+		}
+		if (rank == best_rank) {
+			best_moves.push_back(move);
+		}
+	}
+
+	// Certain results score beyond any evaluation; fifty-move-spoilt ones barely off a draw.
+	const int bound = MAX_DTZ / 2 - 100;
+	score = best_rank >= bound ? TB_WIN_SCORE
+			: best_rank > 0 ? std::max(3, best_rank - (MAX_DTZ / 2 - 200)) * 100 / 200
+			: best_rank == 0 ? 0
+			: best_rank > -bound ? std::min(-3, best_rank + (MAX_DTZ / 2 - 200)) * 100 / 200
+			: -TB_WIN_SCORE;
+	return true;
+}
+
+} // namespace chess
@@ -0,0 +1,73 @@
+#ifndef CHESS_CORE_SYZYGY_H
+#define CHESS_CORE_SYZYGY_H
+
+#include "mapped_file.h"
+#include "position.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace chess {
+
+// Win/draw/loss from the side to move's point of view. Cursed wins and blessed losses are
+// decided positions that the fifty-move rule turns into draws.
+enum WdlScore { WDL_LOSS = -2, WDL_BLESSED_LOSS = -1, WDL_DRAW = 0, WDL_CURSED_WIN = 1, WDL_WIN = 2 };
+
+// Syzygy endgame tablebases (.rtbw win/draw/loss and .rtbz distance-to-zero files).
+// init() only records which tables exist; a file is memory-mapped the first time a
+// position needs it. Probing is thread-safe and leaves the position unchanged.
+class Tablebases {
+public:
+	static const int MAX_PIECES = 7;
+
+	struct PairsData;
+	struct Table;
+
+private:
+	std::vector<std::unique_ptr<Table>> tables;
+	std::unordered_map<uint64_t, Table *> by_material;
+	int largest;
+	mutable std::mutex map_mutex;
+
+	Table *find(const Position &pos) const;
+	bool map_table(Table &table, bool dtz) const;
+	int probe_table(const Position &pos, bool dtz, WdlScore wdl, int &state) const;
+	WdlScore search(Position &pos, bool check_zeroing_moves, int &state) const;
+	int dtz_value(Position &pos, int &state) const;
+
+public:
+	Tablebases();
+	~Tablebases();
+
+	// Register the tables in one or more directories (separated by ';' or, outside Windows, ':'),
+	// replacing any previous set. Returns the number of WDL tables found.
+	int init(const std::string &paths);
+	void clear();
+	int table_count() const { return (int)tables.size(); }
+
+	// Most pieces (kings included) of any available table; 0 when there are none.
+	int max_pieces() const { return largest; }
+
+	// Tables know nothing of castling, and are only exact right after a zeroing move
+	// for WDL purposes; callers check the piece count against max_pieces().
+	bool can_probe(const Position &pos) const;
+
+	// False if a needed table is missing or unreadable.
+	bool probe_wdl(Position &pos, WdlScore &wdl) const;
+
+	// Plies to the next zeroing move with best play, signed as the result (see syzygy.cpp).
+	bool probe_dtz(Position &pos, int &dtz) const;
+
+	// Rank the legal root moves by DTZ, respecting the fifty-move counter. best_moves gets
+	// every move of the best rank (winning moves: the fastest conversion), score a search
+	// score for the outcome (0 for a draw).
+	bool probe_root(Position &pos, std::vector<Move> &best_moves, int &score) const;
+};
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,88 @@
+#include "timeman.h"
+#include "search.h"
+
+#include <algorithm>
+
+namespace chess {
+
+// Sudden-death games are budgeted as if this many moves were left.
+static const int DEFAULT_MOVES_TO_GO = 40;
+
+// The hard limit may reach this multiple of the soft limit...
+static const int MAXIMUM_RATIO = 5;
+
+// ...but never more than this share of the remaining clock (percent).
+static const int MAXIMUM_CLOCK_SHARE = 80;
+
+// An iteration typically costs a few times the previous one; starting one after this share of
+// the soft limit has gone would mostly end in an abort at the hard limit.
+static const double NEXT_ITERATION_SHARE = 0.6;
+
+TimeManager::TimeManager() {
+	optimum_ms = 0;
+	maximum_ms = 0;
+	fixed_time = false;
+	previous_best_move = MOVE_NONE;
+	previous_score = 0;
+	stable_iterations = 0;
+	best_move_changes = 0.0;
+	score_drop_factor = 1.0;
+}
+
+void TimeManager::start(const SearchLimits &limits, int us) {
+	*this = TimeManager();
+
+	if (limits.movetime > 0) {
+		optimum_ms = maximum_ms = std::max<int64_t>(1, limits.movetime - MOVE_OVERHEAD_MS);
+		fixed_time = true;
+	} else if (limits.time[us] > 0) {
+		// Spread the clock plus the increments still to come over the moves left to the next control.
+		int moves_to_go = limits.moves_to_go > 0 ? std::min(limits.moves_to_go, 50) : DEFAULT_MOVES_TO_GO;
+		int64_t remaining = std::max<int64_t>(1, limits.time[us] - MOVE_OVERHEAD_MS);
+		int64_t horizon = remaining + limits.increment[us] * (moves_to_go - 1);
+
+		optimum_ms = std::max<int64_t>(1, horizon / moves_to_go);
+		maximum_ms = std::max<int64_t>(1, std::min(remaining * MAXIMUM_CLOCK_SHARE / 100, optimum_ms * MAXIMUM_RATIO));
+		optimum_ms = std::min(optimum_ms, maximum_ms);
+	}
+
+	// A hard cap shortens the budget, or is the whole budget of a search that had none.
+	if (limits.max_time > 0 && (!enabled() || limits.max_time < maximum_ms)) {
+		fixed_time = fixed_time || !enabled();
+		maximum_ms = limits.max_time;
+		optimum_ms = fixed_time ? maximum_ms : std::min(optimum_ms, maximum_ms);
+	}
+}
+
+// Unstable best moves and falling scores earn more time; a long-stable best move earns less.
+int64_t TimeManager::adjusted_optimum() const {
+	double instability = 1.0 + best_move_changes;
+	double stability = stable_iterations >= 6 ? 0.5 : (stable_iterations >= 3 ? 0.75 : 1.0);
+	double scaled = optimum_ms * instability * score_drop_factor * stability;
+	return std::min<int64_t>(maximum_ms, (int64_t)scaled);
+}
+
+bool TimeManager::iteration_finished(int depth, Move best_move, int score, int64_t elapsed_ms) {
+	if (depth > 1) {
+		best_move_changes *= 0.5;
+		if (best_move != previous_best_move) {
+			best_move_changes += 1.0;
+			stable_iterations = 0;
+		} else {
+			stable_iterations++;
+		}
+
+		// Up to twice the time while the score is falling by as much as 1.5 pawns.
+		int drop = std::max(0, std::min(previous_score - score, 150));
+		score_drop_factor = 1.0 + drop / 150.0;
+	}
+	previous_best_move = best_move;
+	previous_score = score;
+
+	if (!enabled() || fixed_time) {
+		return false;
+	}
+	return elapsed_ms >= adjusted_optimum() * NEXT_ITERATION_SHARE;
+}
+
+} // namespace chess
@@ -0,0 +1,52 @@
+#ifndef CHESS_CORE_TIMEMAN_H
+#define CHESS_CORE_TIMEMAN_H
+
+#include "types.h"
+
+#include <cstdint>
+
+namespace chess {
+
+struct SearchLimits;
+
+// Per-move time budget. optimum() is the soft limit: no new iteration is started past the
+// (adjusted) soft limit. maximum() is the hard limit the search aborts at, checked every
+// CHECK_INTERVAL nodes.
+class TimeManager {
+public:
+	static const int CHECK_INTERVAL = 1024;  // Nodes between clock reads (power of two).
+	static const int64_t MOVE_OVERHEAD_MS = 30;
+
+private:
+	int64_t optimum_ms;
+	int64_t maximum_ms;
+	bool fixed_time;          // movetime: use all of it, stop only at the hard limit.
+
+	// Iteration history used to stretch or shrink the soft limit.
+	Move previous_best_move;
+	int previous_score;
+	int stable_iterations;    // Consecutive iterations with the same best move.
+	double best_move_changes; // Decaying count of best-move changes.
+	double score_drop_factor;
+
+public:
+	TimeManager();
+
+	// Budget for the side to move 'us'; no budget (both limits 0) unless the limits set a clock, movetime or max_time.
+	void start(const SearchLimits &limits, int us);
+
+	bool enabled() const { return maximum_ms > 0; }
+	int64_t optimum() const { return optimum_ms; }
+	int64_t maximum() const { return maximum_ms; }
+
+	// Soft limit adjusted for the iterations seen so far.
+	int64_t adjusted_optimum() const;
+
+	// Called after each completed iteration of the main thread; true when the next iteration
+	// should not be started.
+	bool iteration_finished(int depth, Move best_move, int score, int64_t elapsed_ms);
+};
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,64 @@
+#include "training_data.h"
+#include "evaluate.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace chess {
+
+// Pack occupancy plus one nibble per piece; score is clamped to the int16 range.
+PackedPosition pack_position(const int pieces[64], int side_to_move, int castling, int en_passant, int ply, int score) {
+	PackedPosition packed;
+	std::memset(&packed, 0, sizeof(packed));
+
+	int count = 0;
+	for (int square = 0; square < 64; square++) {
+		if (pieces[square] < 0) {
+			continue;
+		}
+		packed.occupancy |= (uint64_t)1 << square;
+		// Two pieces per byte, low nibble first; a legal position has at most 32 pieces.
+		if (count < 32) {
+			packed.pieces[count / 2] |= (uint8_t)((pieces[square] & 0xF) << ((count % 2) * 4));
+		}
+		count++;
+	}
+
+	packed.score = (int16_t)std::min(std::max(score, -32767), 32767);
+	packed.result = 0;
+	packed.side_to_move = (uint8_t)side_to_move;
+	packed.castling = (uint8_t)castling;
+	packed.en_passant = en_passant < 0 ? 255 : (uint8_t)en_passant;
+	packed.ply = (uint16_t)std::min(ply, 65535);
+	return packed;
+}
+
+PackedPosition pack_position(const Position &pos, int ply, int score) {
+	int pieces[64];
+	for (Square square = 0; square < 64; square++) {
+		Piece piece = pos.piece_on(square);
+		pieces[square] = piece == NO_PIECE ? -1 : network_channel(piece);
+	}
+	return pack_position(pieces, pos.side_to_move(), pos.castling_rights(), pos.en_passant_square(), ply, score);
+}
+
+int unpack_position(const PackedPosition &packed, int pieces[64]) {
+	int count = 0;
+	for (int square = 0; square < 64; square++) {
+		pieces[square] = -1;
+		if (packed.occupancy & ((uint64_t)1 << square)) {
+			pieces[square] = (packed.pieces[count / 2] >> ((count % 2) * 4)) & 0xF;
+			count++;
+		}
+	}
+	return count;
+}
+
+bool write_packed_positions(std::FILE *file, const std::vector<PackedPosition> &positions) {
+	if (positions.empty()) {
+		return true;
+	}
+	return std::fwrite(positions.data(), sizeof(PackedPosition), positions.size(), file) == positions.size();
+}
+
+} // namespace chess
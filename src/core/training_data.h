@@ -0,0 +1,43 @@
+#ifndef CHESS_CORE_TRAINING_DATA_H
+#define CHESS_CORE_TRAINING_DATA_H
+
+// The packed format is shared by self-play and offline tools.
+#include "position.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace chess {
+
+// One 32-byte training sample as written by self-play (fixed layout, little-endian).
+// Squares are indexed y * 8 + x (y = 0 is Black's back rank), matching BoardRules
+// and the network input order; piece codes are the network channels 0-11.
+struct PackedPosition {
+	uint64_t occupancy;   // One bit per occupied square.
+	uint8_t pieces[16];   // 4-bit piece code per occupied square, in occupancy bit order.
+	int16_t score;        // Search score, side-to-move point of view.
+	int8_t result;        // Game result, side-to-move point of view: 1 win, 0 draw, -1 loss.
+	uint8_t side_to_move; // 0 = white, 1 = black.
+	uint8_t castling;     // 1 = white O-O, 2 = white O-O-O, 4 = black O-O, 8 = black O-O-O.
+	uint8_t en_passant;   // En passant target square, or 255 if none.
+	uint16_t ply;         // Plies played since the start of the game.
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+// Build a record from 64 piece codes (-1 = empty square); result is filled in later.
+PackedPosition pack_position(const int pieces[64], int side_to_move, int castling, int en_passant, int ply, int score);
+
+// Same, straight from a Position.
+PackedPosition pack_position(const Position &pos, int ply, int score);
+
+// Expand a record back into 64 piece codes; returns the number of pieces.
+int unpack_position(const PackedPosition &packed, int pieces[64]);
+
+// Append records to an open binary file; returns false on a short write.
+bool write_packed_positions(std::FILE *file, const std::vector<PackedPosition> &positions);
+
+} // namespace chess
+
+#endif
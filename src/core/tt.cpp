@@ -0,0 +1,124 @@
+#include "tt.h"
+
+namespace chess {
+
+// Data word layout: move (16) | score (16) | depth + DEPTH_OFFSET (8) | bound (2) | generation (6).
+static const int DEPTH_OFFSET = 8;
+
+static uint64_t pack_data(Move move, int score, int depth, int bound, uint8_t generation) {
+	return (uint64_t)move | ((uint64_t)(uint16_t)(int16_t)score << 16) |
+			((uint64_t)(uint8_t)(depth + DEPTH_OFFSET) << 32) | ((uint64_t)bound << 40) |
+			((uint64_t)(generation & 63) << 42);
+}
+
+static int data_depth(uint64_t data) {
+	return (int)((data >> 32) & 0xFF) - DEPTH_OFFSET;
+}
+
+static int data_generation(uint64_t data) {
+	return (int)((data >> 42) & 63);
+}
+
+TranspositionTable::TranspositionTable() {
+	cluster_count = 0;
+	generation = 0;
+	resize(16);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+	size_t count = (megabytes * 1024 * 1024) / sizeof(Cluster);
+	cluster_count = count > 0 ? count : 1;
+	clusters.resize(cluster_count);
+	clear();
+}
+
+void TranspositionTable::clear() {
+	for (size_t i = 0; i < cluster_count; i++) {
+		for (Entry &entry : clusters[i].entries) {
+			entry.check.store(0, std::memory_order_relaxed);
+			entry.data.store(0, std::memory_order_relaxed);
+		}
+	}
+	generation = 0;
+}
+
+void TranspositionTable::new_search() {
+	generation = (generation + 1) & 63;
+}
+
+// Multiply-shift maps the key onto the table without needing a power-of-two size.
+TranspositionTable::Cluster &TranspositionTable::cluster_for(uint64_t key) const {
+	return clusters[mul_hi64(key, cluster_count)];
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &out) const {
+	Cluster &cluster = cluster_for(key);
+	for (Entry &entry : cluster.entries) {
+		uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if ((entry.check.load(std::memory_order_relaxed) ^ data) != key || data == 0) {
+			continue;
+		}
+		out.move = (Move)(data & 0xFFFF);
+		out.score = (int16_t)((data >> 16) & 0xFFFF);
+		out.depth = data_depth(data);
+		out.bound = (int)((data >> 40) & 3);
+		return true;
+	}
+	return false;
+}
+
+// A matching entry is only overwritten by a result nearly as deep, an exact one, or once it is from
+// an earlier search; otherwise the shallowest / oldest entry in the cluster is replaced.
+static const int REPLACE_DEPTH_MARGIN = 2;
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, int bound) {
+	Cluster &cluster = cluster_for(key);
+	Entry *replace = &cluster.entries[0];
+	int replace_value = 1 << 30;
+
+	for (Entry &entry : cluster.entries) {
+		uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if ((entry.check.load(std::memory_order_relaxed) ^ data) == key && data != 0) {
+			// Keep the old best move when this result did not produce one.
+			if (move == MOVE_NONE) {
+				move = (Move)(data & 0xFFFF);
+			}
+			bool stale = data_generation(data) != generation;
+			if (depth < data_depth(data) - REPLACE_DEPTH_MARGIN && bound != BOUND_EXACT && !stale) {
+				// A deeper result of this search stays; only a missing move is filled in.
+				if ((data & 0xFFFF) == MOVE_NONE && move != MOVE_NONE) {
+					uint64_t kept = (data & ~(uint64_t)0xFFFF) | (uint64_t)move;
+					entry.check.store(key ^ kept, std::memory_order_relaxed);
+					entry.data.store(kept, std::memory_order_relaxed);
+				}
+				return;
+			}
+			replace = &entry;
+			break;
+		}
+		int age = (generation - data_generation(data)) & 63;
+		int value = data == 0 ? -(1 << 20) : data_depth(data) - 8 * age;
+		if (value < replace_value) {
+			replace_value = value;
+			replace = &entry;
+		}
+	}
+
+	uint64_t data = pack_data(move, score, depth, bound, generation);
+	replace->check.store(key ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+	int used = 0;
+	size_t samples = cluster_count < 250 ? cluster_count : 250;
+	for (size_t i = 0; i < samples; i++) {
+		for (const Entry &entry : clusters[i].entries) {
+			uint64_t data = entry.data.load(std::memory_order_relaxed);
+			used += data != 0 && data_generation(data) == (generation & 63);
+		}
+	}
+	return samples > 0 ? (int)(used * 1000 / (samples * CLUSTER_SIZE)) : 0;
+}
+
+} // namespace chess
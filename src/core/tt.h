@@ -0,0 +1,72 @@
+#ifndef CHESS_CORE_TT_H
+#define CHESS_CORE_TT_H
+
+#include "large_pages.h"
+#include "types.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace chess {
+
+enum Bound { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+// Decoded transposition table entry.
+struct TTData {
+	Move move;
+	int score;
+	int depth;
+	int bound;
+};
+
+// Shared hash table of search results. Entries are two 64-bit words stored as key ^ data and data,
+// so a torn write from another thread simply fails verification instead of needing a lock.
+class TranspositionTable {
+private:
+	struct Entry {
+		std::atomic<uint64_t> check; // key ^ data
+		std::atomic<uint64_t> data;
+	};
+
+	// Four entries per 64-byte cluster, probed together.
+	static const int CLUSTER_SIZE = 4;
+	struct Cluster {
+		Entry entries[CLUSTER_SIZE];
+	};
+
+	LargeArray<Cluster> clusters;
+	size_t cluster_count;
+	uint8_t generation;
+
+	Cluster &cluster_for(uint64_t key) const;
+
+public:
+	TranspositionTable();
+
+	void resize(size_t megabytes);
+	void clear();
+
+	// Called once per search so older entries are replaced first.
+	void new_search();
+
+	bool probe(uint64_t key, TTData &out) const;
+	void store(uint64_t key, Move move, int score, int depth, int bound);
+
+	PageKind page_kind() const { return clusters.page_kind(); }
+
+	// Permille of sampled entries written by the current search (UCI hashfull).
+	int hashfull() const;
+};
+
+// Mate and tablebase scores are stored relative to the node, not the root.
+inline int score_to_tt(int score, int ply) {
+	return score >= TB_WIN_IN_MAX_PLY ? score + ply : score <= -TB_WIN_IN_MAX_PLY ? score - ply : score;
+}
+
+inline int score_from_tt(int score, int ply) {
+	return score >= TB_WIN_IN_MAX_PLY ? score - ply : score <= -TB_WIN_IN_MAX_PLY ? score + ply : score;
+}
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef CHESS_CORE_TYPES_H
+#define CHESS_CORE_TYPES_H
+
+// Godot-free core: basic chess types shared by position, movegen, evaluation and search.
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace chess {
+
+// Same numbering as BoardRules so adapters can cast directly.
+enum Color { WHITE = 0, BLACK = 1, NO_COLOR = -1 };
+enum PieceType { PAWN = 0, ROOK = 1, KNIGHT = 2, BISHOP = 3, QUEEN = 4, KING = 5, NO_PIECE_TYPE = -1 };
+
+// A piece is color * 6 + type; NO_PIECE marks an empty square.
+typedef int8_t Piece;
+const Piece NO_PIECE = -1;
+
+inline Piece make_piece(int color, int type) { return (Piece)(color * 6 + type); }
+inline int color_of(Piece piece) { return piece / 6; }
+inline int type_of(Piece piece) { return piece % 6; }
+
+// Squares are y * 8 + x with y = 0 on Black's back rank, as in BoardRules::board[x][y].
+typedef int Square;
+const Square NO_SQUARE = -1;
+
+inline Square make_square(int x, int y) { return y * 8 + x; }
+inline int file_of(Square square) { return square & 7; }
+inline int row_of(Square square) { return square >> 3; }
+
+// Castling rights bits (same layout as PackedPosition::castling).
+enum CastlingRight { WHITE_OO = 1, WHITE_OOO = 2, BLACK_OO = 4, BLACK_OOO = 8, ALL_CASTLING = 15 };
+
+// A move packs from (6 bits), to (6 bits) and promotion piece type (3 bits, 0 = none).
+// Castling is a two-square king move and en passant a pawn capture onto the ep square.
+typedef uint16_t Move;
+const Move MOVE_NONE = 0;
+const Move MOVE_NULL = 65;
+
+inline Move encode_move(Square from, Square to, int promotion = 0) { return (Move)(from | (to << 6) | (promotion << 12)); }
+inline Square move_from(Move move) { return move & 63; }
+inline Square move_to(Move move) { return (move >> 6) & 63; }
+inline int move_promotion(Move move) { return (move >> 12) & 7; }
+
+// Search score scale: centipawn-like, mates counted down from MATE_SCORE by ply.
+const int MATE_SCORE = 30000;
+const int MAX_PLY = 128;
+const int MATE_IN_MAX_PLY = MATE_SCORE - MAX_PLY;
+const int INFINITE_SCORE = 31000;
+
+// Tablebase wins rank below every mate but above any evaluation.
+const int TB_WIN_SCORE = MATE_IN_MAX_PLY - 1;
+const int TB_WIN_IN_MAX_PLY = TB_WIN_SCORE - MAX_PLY;
+
+typedef uint64_t Bitboard;
+
+inline int popcount(Bitboard b) {
+#if defined(_MSC_VER)
+	return (int)__popcnt64(b);
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least / most significant set bit; b must be non-zero.
+inline Square lsb(Bitboard b) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, b);
+	return (Square)index;
+#else
+	return (Square)__builtin_ctzll(b);
+#endif
+}
+
+inline Square msb(Bitboard b) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, b);
+	return (Square)index;
+#else
+	return (Square)(63 ^ __builtin_clzll(b));
+#endif
+}
+
+inline Square pop_lsb(Bitboard &b) {
+	Square square = lsb(b);
+	b &= b - 1;
+	return square;
+}
+
+inline Bitboard square_bb(Square square) { return (Bitboard)1 << square; }
+
+// High 64 bits of a 64x64 product, used to map hashes onto table sizes that are not powers of two.
+inline uint64_t mul_hi64(uint64_t a, uint64_t b) {
+#if defined(_MSC_VER)
+	return __umulh(a, b);
+#else
+	return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#endif
+}
+
+} // namespace chess
+
+#endif
@@ -0,0 +1,477 @@
+// Headless batch analysis of EPD test suites (WAC, STS, ...) and FEN lists.
+// Usage: chess_epd [--threads N] [--nodes N] [--movetime MS] [--depth N] [--hash MB]
+//                  [--eval network.bin] [--eval-mode network|handcrafted|hybrid]
+//                  [--csv results.csv] [--json results.json] suite.epd...
+// Positions are shared out over the threads, each searching one position at a time on a fresh
+// table, so node- or depth-limited results do not depend on the thread count or the order.
+// A position with bm (best moves) or am (avoid moves) opcodes, in SAN or UCI notation, is solved
+// when the final best move is one of the bm moves and none of the am moves. Its solve time is
+// when the search settled on a correct move for good; counting the positions solved within
+// growing times gives the solved-vs-time curve used to compare engine versions.
+
+#include "core/evaluate.h"
+#include "core/movegen.h"
+#include "core/network.h"
+#include "core/position.h"
+#include "core/search.h"
+#include "core/timeman.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chess;
+
+namespace {
+
+// Time marks of the solved-vs-time summary, in milliseconds.
+const int64_t SOLVE_MARKS_MS[] = { 10, 30, 100, 300, 1000, 3000, 10000, 30000 };
+const int SOLVE_MARK_COUNT = sizeof(SOLVE_MARKS_MS) / sizeof(SOLVE_MARKS_MS[0]);
+
+struct EpdEntry {
+	std::string file;
+	int line = 0;
+	std::string id;
+	std::string fen;
+	Position pos;
+	std::vector<Move> best_moves;
+	std::vector<Move> avoid_moves;
+	std::string bm_text;
+	std::string am_text;
+
+	bool has_target() const { return !best_moves.empty() || !avoid_moves.empty(); }
+	bool accepts(Move move) const {
+		return (best_moves.empty() || std::find(best_moves.begin(), best_moves.end(), move) != best_moves.end()) &&
+				std::find(avoid_moves.begin(), avoid_moves.end(), move) == avoid_moves.end();
+	}
+};
+
+struct EpdResult {
+	Move best_move = MOVE_NONE;
+	int score = 0;
+	int depth = 0;
+	int64_t nodes = 0;
+	int64_t time_ms = 0;
+	bool solved = false;
+	int64_t solve_time_ms = -1;  // Iteration from which the best move stayed correct, -1 if it never did.
+	int64_t solve_nodes = -1;
+};
+
+struct RunConfig {
+	int threads = 1;
+	int64_t nodes = 0;
+	int64_t movetime = 0;
+	int depth = 0;
+	int hash_mb = 16;
+	EvalMode eval_mode = EVAL_HANDCRAFTED;
+};
+
+std::string trim(const std::string &text) {
+	size_t begin = text.find_first_not_of(" \t\r\n");
+	size_t end = text.find_last_not_of(" \t\r\n");
+	return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+
+// Moves of a bm/am operand list, SAN first and UCI as a fallback; false if one is not legal.
+bool parse_moves(Position &pos, const std::string &operands, std::vector<Move> &moves) {
+	std::istringstream stream(operands);
+	std::string token;
+	while (stream >> token) {
+		Move move = parse_san_move(pos, token);
+		if (move == MOVE_NONE) {
+			move = parse_uci_move(pos, token);
+		}
+		if (move == MOVE_NONE) {
+			return false;
+		}
+		moves.push_back(move);
+	}
+	return true;
+}
+
+// One EPD record ("<4 FEN fields> op operands; op operands; ...") or a plain 6-field FEN.
+// Opcodes other than bm, am and id are ignored.
+bool parse_epd_line(const std::string &line, EpdEntry &entry, std::string &error) {
+	std::istringstream stream(line);
+	std::string fields[6];
+	for (int i = 0; i < 4; i++) {
+		if (!(stream >> fields[i])) {
+			error = "fewer than four FEN fields";
+			return false;
+		}
+	}
+	std::string rest;
+	std::getline(stream, rest);
+	rest = trim(rest);
+
+	// Half-move and full-move counters are optional in EPD and required in FEN.
+	std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+	std::istringstream counters(rest);
+	if (counters >> fields[4] >> fields[5] &&
+			fields[4].find_first_not_of("0123456789") == std::string::npos &&
+			fields[5].find_first_not_of("0123456789") == std::string::npos) {
+		fen += " " + fields[4] + " " + fields[5];
+		std::getline(counters, rest);
+		rest = trim(rest);
+	}
+	if (!entry.pos.set_fen(fen)) {
+		error = "bad FEN";
+		return false;
+	}
+	entry.fen = fen;
+
+	// Operations are ';'-terminated; quoted operands may contain ';'.
+	size_t i = 0;
+	while (i < rest.size()) {
+		std::string operation;
+		bool quoted = false;
+		for (; i < rest.size() && (quoted || rest[i] != ';'); i++) {
+			quoted = rest[i] == '"' ? !quoted : quoted;
+			operation += rest[i];
+		}
+		i++;
+		operation = trim(operation);
+		size_t space = operation.find_first_of(" \t");
+		std::string opcode = operation.substr(0, space);
+		std::string operands = space == std::string::npos ? std::string() : trim(operation.substr(space));
+
+		if (opcode == "id") {
+			entry.id = operands.size() >= 2 && operands.front() == '"' && operands.back() == '"' ?
+					operands.substr(1, operands.size() - 2) : operands;
+		} else if (opcode == "bm" || opcode == "am") {
+			std::vector<Move> &moves = opcode == "bm" ? entry.best_moves : entry.avoid_moves;
+			if (!parse_moves(entry.pos, operands, moves)) {
+				error = "illegal " + opcode + " move in \"" + operands + "\"";
+				return false;
+			}
+			(opcode == "bm" ? entry.bm_text : entry.am_text) = operands;
+		}
+	}
+	return true;
+}
+
+bool read_epd_file(const std::string &path, std::vector<EpdEntry> &entries) {
+	std::ifstream in(path);
+	if (!in) {
+		std::fprintf(stderr, "chess_epd: cannot read %s\n", path.c_str());
+		return false;
+	}
+	std::string line;
+	int number = 0;
+	while (std::getline(in, line)) {
+		number++;
+		line = trim(line);
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		EpdEntry entry;
+		entry.file = path;
+		entry.line = number;
+		std::string error;
+		if (!parse_epd_line(line, entry, error)) {
+			std::fprintf(stderr, "chess_epd: %s:%d: %s, skipped\n", path.c_str(), number, error.c_str());
+			continue;
+		}
+		if (entry.id.empty()) {
+			entry.id = path + ":" + std::to_string(number);
+		}
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+EpdResult analyse(Search &search, const EpdEntry &entry, const RunConfig &config) {
+	SearchLimits limits;
+	limits.nodes = config.nodes;
+	limits.depth = config.depth;
+	// The per-move overhead a GUI needs does not apply here: search for the whole movetime.
+	limits.movetime = config.movetime > 0 ? config.movetime + TimeManager::MOVE_OVERHEAD_MS : 0;
+
+	EpdResult result;
+	auto on_iteration = [&](const SearchInfo &info) {
+		if (info.multipv != 1 || info.pv.empty() || !entry.has_target()) {
+			return;
+		}
+		if (!entry.accepts(info.pv[0])) {
+			result.solve_time_ms = -1;
+			result.solve_nodes = -1;
+		} else if (result.solve_time_ms < 0) {
+			result.solve_time_ms = info.time_ms;
+			result.solve_nodes = info.nodes;
+		}
+	};
+
+	// A fresh table per position keeps every result independent of what the thread searched before.
+	search.clear();
+	SearchResult searched = search.run(entry.pos, limits, on_iteration);
+	result.best_move = searched.best_move;
+	result.score = searched.score;
+	result.depth = searched.depth;
+	result.nodes = searched.nodes;
+	result.time_ms = searched.time_ms;
+	result.solved = entry.has_target() && result.best_move != MOVE_NONE && entry.accepts(result.best_move);
+	if (!result.solved) {
+		result.solve_time_ms = -1;
+		result.solve_nodes = -1;
+	} else if (result.solve_time_ms < 0) {
+		result.solve_time_ms = result.time_ms;
+		result.solve_nodes = result.nodes;
+	}
+	return result;
+}
+
+std::string score_text(int score) {
+	if (score >= MATE_IN_MAX_PLY) {
+		return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+	}
+	if (score <= -MATE_IN_MAX_PLY) {
+		return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+	}
+	return "cp " + std::to_string(score);
+}
+
+std::string san_of(const EpdEntry &entry, Move move) {
+	if (move == MOVE_NONE) {
+		return std::string();
+	}
+	Position pos = entry.pos;
+	return move_to_san(pos, move);
+}
+
+std::string csv_field(const std::string &text) {
+	if (text.find_first_of(",\"\n") == std::string::npos) {
+		return text;
+	}
+	std::string quoted = "\"";
+	for (char c : text) {
+		quoted += c == '"' ? "\"\"" : std::string(1, c);
+	}
+	return quoted + "\"";
+}
+
+std::string json_string(const std::string &text) {
+	std::string escaped = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if ((unsigned char)c < 0x20) {
+			char buffer[8];
+			std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+			escaped += buffer;
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped + "\"";
+}
+
+bool write_csv(const std::string &path, const std::vector<EpdEntry> &entries, const std::vector<EpdResult> &results) {
+	std::FILE *file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fprintf(file, "id,fen,bm,am,best,score,depth,nodes,time_ms,solved,solve_time_ms,solve_nodes\n");
+	for (size_t i = 0; i < entries.size(); i++) {
+		const EpdEntry &entry = entries[i];
+		const EpdResult &result = results[i];
+		std::fprintf(file, "%s,%s,%s,%s,%s,%s,%d,%lld,%lld,%s,%lld,%lld\n", csv_field(entry.id).c_str(),
+				csv_field(entry.fen).c_str(), csv_field(entry.bm_text).c_str(), csv_field(entry.am_text).c_str(),
+				san_of(entry, result.best_move).c_str(), score_text(result.score).c_str(), result.depth,
+				(long long)result.nodes, (long long)result.time_ms,
+				entry.has_target() ? (result.solved ? "1" : "0") : "", (long long)result.solve_time_ms,
+				(long long)result.solve_nodes);
+	}
+	return std::fclose(file) == 0;
+}
+
+bool write_json(const std::string &path, const std::vector<EpdEntry> &entries, const std::vector<EpdResult> &results,
+		const std::string &summary) {
+	std::FILE *file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fprintf(file, "{\"summary\": %s, \"positions\": [\n", summary.c_str());
+	for (size_t i = 0; i < entries.size(); i++) {
+		const EpdEntry &entry = entries[i];
+		const EpdResult &result = results[i];
+		std::fprintf(file, "  {\"id\": %s, \"fen\": %s, \"bm\": %s, \"am\": %s, \"best\": %s, \"uci\": %s, "
+				"\"score\": %d, \"score_text\": %s, \"depth\": %d, \"nodes\": %lld, \"time_ms\": %lld, \"solved\": %s, "
+				"\"solve_time_ms\": %lld, \"solve_nodes\": %lld}%s\n",
+				json_string(entry.id).c_str(), json_string(entry.fen).c_str(), json_string(entry.bm_text).c_str(),
+				json_string(entry.am_text).c_str(), json_string(san_of(entry, result.best_move)).c_str(),
+				json_string(move_to_uci(result.best_move)).c_str(), result.score, json_string(score_text(result.score)).c_str(),
+				result.depth, (long long)result.nodes, (long long)result.time_ms,
+				entry.has_target() ? (result.solved ? "true" : "false") : "null", (long long)result.solve_time_ms,
+				(long long)result.solve_nodes, i + 1 < entries.size() ? "," : "");
+	}
+	std::fprintf(file, "]}\n");
+	return std::fclose(file) == 0;
+}
+
+void print_usage() {
+	std::fprintf(stderr, "usage: chess_epd [--threads N] [--nodes N] [--movetime MS] [--depth N] [--hash MB]\n"
+			"                 [--eval network.bin] [--eval-mode network|handcrafted|hybrid]\n"
+			"                 [--csv results.csv] [--json results.json] suite.epd...\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	RunConfig config;
+	int hardware_threads = (int)std::thread::hardware_concurrency();
+	config.threads = hardware_threads > 0 ? hardware_threads : 1;
+	std::string eval_path;
+	std::string eval_mode;
+	std::string csv_path;
+	std::string json_path;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) {
+			config.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--nodes" && i + 1 < argc) {
+			config.nodes = std::max<int64_t>(0, std::atoll(argv[++i]));
+		} else if (arg == "--movetime" && i + 1 < argc) {
+			config.movetime = std::max<int64_t>(0, std::atoll(argv[++i]));
+		} else if (arg == "--depth" && i + 1 < argc) {
+			config.depth = std::max(0, std::atoi(argv[++i]));
+		} else if (arg == "--hash" && i + 1 < argc) {
+			config.hash_mb = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--eval" && i + 1 < argc) {
+			eval_path = argv[++i];
+		} else if (arg == "--eval-mode" && i + 1 < argc) {
+			eval_mode = argv[++i];
+		} else if (arg == "--csv" && i + 1 < argc) {
+			csv_path = argv[++i];
+		} else if (arg == "--json" && i + 1 < argc) {
+			json_path = argv[++i];
+		} else if (!arg.empty() && arg[0] != '-') {
+			inputs.push_back(arg);
+		} else {
+			inputs.clear();
+			break;
+		}
+	}
+	if (inputs.empty() || (!eval_mode.empty() && eval_mode != "network" && eval_mode != "handcrafted" && eval_mode != "hybrid")) {
+		print_usage();
+		return 1;
+	}
+	if (config.nodes <= 0 && config.movetime <= 0 && config.depth <= 0) {
+		config.movetime = 1000;
+	}
+
+	// Without a trained network there is nothing for the network modes to evaluate with.
+	Network network;
+	if (!eval_path.empty()) {
+		if (!network.load(eval_path)) {
+			std::fprintf(stderr, "chess_epd: cannot load network %s\n", eval_path.c_str());
+			return 1;
+		}
+		config.eval_mode = EVAL_NETWORK;
+	}
+	if (eval_mode == "network" || eval_mode == "hybrid") {
+		if (eval_path.empty()) {
+			std::fprintf(stderr, "chess_epd: --eval-mode %s needs --eval\n", eval_mode.c_str());
+			return 1;
+		}
+		config.eval_mode = eval_mode == "hybrid" ? EVAL_HYBRID : EVAL_NETWORK;
+	} else if (eval_mode == "handcrafted") {
+		config.eval_mode = EVAL_HANDCRAFTED;
+	}
+
+	std::vector<EpdEntry> entries;
+	for (const std::string &path : inputs) {
+		if (!read_epd_file(path, entries)) {
+			return 1;
+		}
+	}
+	if (entries.empty()) {
+		std::fprintf(stderr, "chess_epd: no positions\n");
+		return 1;
+	}
+
+	// Positions are handed out from a shared counter; results land in their own slots.
+	std::vector<EpdResult> results(entries.size());
+	std::atomic<size_t> next_entry(0);
+	std::atomic<size_t> finished(0);
+	int thread_count = std::min(config.threads, (int)entries.size());
+	auto start_time = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < thread_count; t++) {
+		workers.emplace_back([&]() {
+			std::unique_ptr<Search> search(new Search());
+			search->set_hash_size(config.hash_mb);
+			search->set_eval_mode(config.eval_mode);
+			search->set_network(eval_path.empty() ? nullptr : &network);
+			for (size_t i = next_entry++; i < entries.size(); i = next_entry++) {
+				results[i] = analyse(*search, entries[i], config);
+				size_t done = ++finished;
+				if (done % 10 == 0 || done == entries.size()) {
+					std::fprintf(stderr, "\r%zu/%zu", done, entries.size());
+				}
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	std::fprintf(stderr, "\n");
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	int targets = 0;
+	int solved = 0;
+	int64_t nodes = 0;
+	int64_t search_ms = 0;
+	int solved_by_mark[SOLVE_MARK_COUNT] = {};
+	for (size_t i = 0; i < entries.size(); i++) {
+		const EpdResult &result = results[i];
+		nodes += result.nodes;
+		search_ms += result.time_ms;
+		if (!entries[i].has_target()) {
+			continue;
+		}
+		targets++;
+		solved += result.solved;
+		for (int m = 0; m < SOLVE_MARK_COUNT; m++) {
+			solved_by_mark[m] += result.solved && result.solve_time_ms <= SOLVE_MARKS_MS[m];
+		}
+	}
+
+	std::printf("%zu positions, %d with bm/am, solved %d (%.1f%%)\n", entries.size(), targets, solved,
+			targets > 0 ? 100.0 * solved / targets : 0.0);
+	std::printf("%lld nodes in %.2f s on %d threads (%.0f nps per thread)\n", (long long)nodes, seconds, thread_count,
+			search_ms > 0 ? nodes * 1000.0 / search_ms : 0.0);
+	std::string marks = "[";
+	for (int m = 0; m < SOLVE_MARK_COUNT; m++) {
+		std::printf("solved within %6lld ms: %d\n", (long long)SOLVE_MARKS_MS[m], solved_by_mark[m]);
+		marks += (m > 0 ? ", " : "") + std::string("{\"ms\": ") + std::to_string(SOLVE_MARKS_MS[m]) + ", \"solved\": " +
+				std::to_string(solved_by_mark[m]) + "}";
+	}
+	marks += "]";
+
+	char summary[512];
+	std::snprintf(summary, sizeof(summary), "{\"positions\": %zu, \"targets\": %d, \"solved\": %d, \"nodes\": %lld, "
+			"\"seconds\": %.3f, \"threads\": %d, \"nodes_limit\": %lld, \"movetime\": %lld, \"depth\": %d, \"solved_within\": ",
+			entries.size(), targets, solved, (long long)nodes, seconds, thread_count, (long long)config.nodes,
+			(long long)config.movetime, config.depth);
+
+	if (!csv_path.empty() && !write_csv(csv_path, entries, results)) {
+		std::fprintf(stderr, "chess_epd: cannot write %s\n", csv_path.c_str());
+		return 1;
+	}
+	if (!json_path.empty() && !write_json(json_path, entries, results, std::string(summary) + marks + "}")) {
+		std::fprintf(stderr, "chess_epd: cannot write %s\n", json_path.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,773 @@
+// Headless engine-vs-engine matches for A/B testing weight files, search changes and budgets.
+// Usage: chess_match --engine name=A [eval=a.bin] [key=value...] --engine name=B [key=value...]
+//                    [--games N] [--concurrency N] [--openings suite.epd] [--shuffle] [--random-plies N]
+//                    [--tc BASE+INC] [--nodes N] [--movetime MS] [--depth N] [--hash MB]
+//                    [--sprt ELO0 ELO1 [ALPHA BETA]] [--max-plies N] [--resign SCORE PLIES]
+//                    [--draw PLY SCORE PLIES] [--pgn games.pgn] [--seed N]
+// Engine keys: name, eval (network file), mode (network|handcrafted|hybrid), tc (seconds, "10+0.1"),
+// nodes, movetime, depth, hash, threads, skill, elo, and any search parameter by name (NullMove=0,
+// LMR=1, ...; see core/search_params.cpp). --tc, --nodes, --movetime, --depth and --hash set the
+// defaults both engines start from.
+// Every opening (a FEN/EPD line, or a line of SAN/UCI moves from the start position; random
+// moves without a suite) is played twice with colours swapped, games spread over the threads.
+// Results are from the first engine's point of view: Elo with its 95% margin and the likelihood
+// of superiority over all games, and, with --sprt, a sequential probability ratio test of the
+// logistic Elo hypotheses ELO0 against ELO1 on the finished game pairs (pentanomial, so the
+// correlation within a pair is accounted for) that stops the match once a bound is crossed.
+
+#include "core/evaluate.h"
+#include "core/movegen.h"
+#include "core/network.h"
+#include "core/position.h"
+#include "core/search.h"
+#include "core/search_params.h"
+#include "core/skill.h"
+#include "core/timeman.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chess;
+
+namespace {
+
+struct EngineConfig {
+	std::string name;
+	std::string eval_path;
+	std::string eval_mode;
+	int64_t base_ms = 0;           // Clock per game (0: no clock)...
+	int64_t increment_ms = 0;      // ...and its increment per move.
+	int64_t nodes = 0;
+	int64_t movetime = 0;
+	int depth = 0;
+	int hash_mb = 16;
+	int threads = 1;
+	int skill_level = SkillLevel::MAX_LEVEL;
+	int elo = 0;
+	SearchParams params;
+	std::shared_ptr<Network> network;
+
+	bool has_limit() const { return base_ms > 0 || nodes > 0 || movetime > 0 || depth > 0; }
+};
+
+struct MatchConfig {
+	int games = 0;
+	int concurrency = 1;
+	int random_plies = 8;          // Random opening moves when there is no suite.
+	int max_plies = 400;           // Longer games are adjudicated as draws.
+	int resign_score = 1000;       // Lost once both engines agree the score is at or below -resign_score...
+	int resign_plies = 8;          // ...for this many consecutive plies (0 disables).
+	int draw_min_ply = 80;         // Drawn after this ply once |score| stays within draw_score...
+	int draw_score = 10;
+	int draw_plies = 12;           // ...for this many consecutive plies (0 disables).
+	bool sprt = false;
+	double elo0 = 0.0;
+	double elo1 = 5.0;
+	double alpha = 0.05;
+	double beta = 0.05;
+	uint32_t seed = 1;
+};
+
+struct Opening {
+	std::string fen;               // Empty: the start position.
+	std::vector<Move> moves;
+};
+
+struct GameResult {
+	int white_result = 0;          // 1, 0, -1.
+	std::string reason;
+	std::string start_fen;
+	std::vector<std::string> san;
+	int64_t nodes[2] = { 0, 0 };   // Per engine (0 = first), not per colour.
+	int64_t time_us[2] = { 0, 0 };
+	int64_t moves[2] = { 0, 0 };
+	bool time_loss = false;
+};
+
+// Running totals from the first engine's point of view.
+struct MatchStats {
+	int64_t wins = 0;
+	int64_t losses = 0;
+	int64_t draws = 0;
+	int64_t pentanomial[5] = {};   // Finished pairs by the first engine's points in them: 0, 0.5, ... 2.
+	int64_t time_losses = 0;
+	int64_t nodes[2] = { 0, 0 };
+	int64_t time_us[2] = { 0, 0 };
+	int64_t moves[2] = { 0, 0 };
+
+	int64_t games() const { return wins + losses + draws; }
+	int64_t pairs() const { return pentanomial[0] + pentanomial[1] + pentanomial[2] + pentanomial[3] + pentanomial[4]; }
+	double score() const { return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5; }
+};
+
+std::string trim(const std::string &text) {
+	size_t begin = text.find_first_not_of(" \t\r\n");
+	size_t end = text.find_last_not_of(" \t\r\n");
+	return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+
+// Seconds as in "10+0.1" or "60"; false if malformed.
+bool parse_time_control(const std::string &text, int64_t &base_ms, int64_t &increment_ms) {
+	size_t plus = text.find('+');
+	char *end = nullptr;
+	double base = std::strtod(text.c_str(), &end);
+	if (end == text.c_str() || (plus == std::string::npos ? *end != '\0' : end != text.c_str() + plus) || base <= 0.0) {
+		return false;
+	}
+	double increment = 0.0;
+	if (plus != std::string::npos) {
+		std::string rest = text.substr(plus + 1);
+		increment = std::strtod(rest.c_str(), &end);
+		if (end == rest.c_str() || *end != '\0' || increment < 0.0) {
+			return false;
+		}
+	}
+	base_ms = (int64_t)std::llround(base * 1000.0);
+	increment_ms = (int64_t)std::llround(increment * 1000.0);
+	return true;
+}
+
+bool apply_engine_option(EngineConfig &engine, const std::string &key, const std::string &value, std::string &error) {
+	if (key == "name") {
+		engine.name = value;
+	} else if (key == "eval") {
+		engine.eval_path = value;
+	} else if (key == "mode") {
+		if (value != "network" && value != "handcrafted" && value != "hybrid") {
+			error = "mode must be network, handcrafted or hybrid";
+			return false;
+		}
+		engine.eval_mode = value;
+	} else if (key == "tc") {
+		if (!parse_time_control(value, engine.base_ms, engine.increment_ms)) {
+			error = "bad time control \"" + value + "\"";
+			return false;
+		}
+	} else if (key == "nodes") {
+		engine.nodes = std::max<int64_t>(0, std::atoll(value.c_str()));
+	} else if (key == "movetime") {
+		engine.movetime = std::max<int64_t>(0, std::atoll(value.c_str()));
+	} else if (key == "depth") {
+		engine.depth = std::max(0, std::atoi(value.c_str()));
+	} else if (key == "hash") {
+		engine.hash_mb = std::max(1, std::atoi(value.c_str()));
+	} else if (key == "threads") {
+		engine.threads = std::max(1, std::atoi(value.c_str()));
+	} else if (key == "skill") {
+		engine.skill_level = std::atoi(value.c_str());
+	} else if (key == "elo") {
+		engine.elo = std::atoi(value.c_str());
+	} else if (!set_search_param(engine.params, key, std::atoi(value.c_str()))) {
+		error = "unknown engine option \"" + key + "\"";
+		return false;
+	}
+	return true;
+}
+
+// FEN or EPD (opcodes ignored), else a move sequence from the start position.
+bool parse_opening(const std::string &line, Opening &opening) {
+	std::istringstream stream(line);
+	std::string fields[6];
+	int count = 0;
+	while (count < 6 && stream >> fields[count]) {
+		count++;
+	}
+	Position pos;
+	if (count >= 4) {
+		std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+		if (count == 6 && fields[4].find_first_not_of("0123456789") == std::string::npos &&
+				fields[5].find_first_not_of("0123456789") == std::string::npos) {
+			fen += " " + fields[4] + " " + fields[5];
+		}
+		if (fields[0].find('/') != std::string::npos && pos.set_fen(fen)) {
+			opening.fen = fen;
+			return true;
+		}
+	}
+
+	// PGN-style move numbers ("1.", "1...") are skipped.
+	pos.set_start_position();
+	std::istringstream moves(line);
+	std::string token;
+	UndoInfo undo;
+	while (moves >> token) {
+		size_t dot = token.find_last_of('.');
+		if (dot != std::string::npos) {
+			token = token.substr(dot + 1);
+			if (token.empty()) {
+				continue;
+			}
+		}
+		Move move = parse_san_move(pos, token);
+		if (move == MOVE_NONE) {
+			move = parse_uci_move(pos, token);
+		}
+		if (move == MOVE_NONE) {
+			return false;
+		}
+		opening.moves.push_back(move);
+		pos.make_move(move, undo);
+	}
+	return !opening.moves.empty();
+}
+
+bool read_openings(const std::string &path, std::vector<Opening> &openings) {
+	std::ifstream in(path);
+	if (!in) {
+		std::fprintf(stderr, "chess_match: cannot read %s\n", path.c_str());
+		return false;
+	}
+	std::string line;
+	int number = 0;
+	while (std::getline(in, line)) {
+		number++;
+		line = trim(line);
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		Opening opening;
+		if (!parse_opening(line, opening)) {
+			std::fprintf(stderr, "chess_match: %s:%d: neither a position nor legal moves, skipped\n", path.c_str(), number);
+			continue;
+		}
+		openings.push_back(opening);
+	}
+	return true;
+}
+
+// Start position of a pair: a suite opening, or random_plies random moves from the pair's seed.
+Position opening_position(const std::vector<Opening> &openings, const MatchConfig &config, int pair) {
+	Position pos;
+	pos.set_start_position();
+	UndoInfo undo;
+	if (!openings.empty()) {
+		const Opening &opening = openings[pair % openings.size()];
+		if (!opening.fen.empty()) {
+			pos.set_fen(opening.fen);
+		}
+		for (Move move : opening.moves) {
+			pos.make_move(move, undo);
+		}
+		return pos;
+	}
+
+	std::mt19937 rng(config.seed + (uint32_t)pair * 7919u);
+	for (int ply = 0; ply < config.random_plies; ply++) {
+		MoveList moves;
+		generate_legal_moves(pos, moves);
+		if (moves.size == 0) {
+			break;
+		}
+		std::uniform_int_distribution<int> pick(0, moves.size - 1);
+		pos.make_move(moves.moves[pick(rng)], undo);
+	}
+	return pos;
+}
+
+// One game; engines[color] plays color and is engine index players[color]. Returns false if
+// stop was raised before it ended.
+bool play_game(Position pos, Search *searches[2], const EngineConfig *engines[2], const int players[2],
+		const MatchConfig &config, const std::atomic<bool> &stop, GameResult &game) {
+	game.start_fen = pos.get_fen();
+	// Clocks in microseconds: fast games make many moves shorter than a millisecond.
+	int64_t clock[2] = { engines[WHITE]->base_ms * 1000, engines[BLACK]->base_ms * 1000 };
+	int win_run = 0;
+	int loss_run = 0;
+	int draw_run = 0;
+	UndoInfo undo;
+	for (int ply = 0;; ply++) {
+		GameState state = get_game_state(pos);
+		if (state != GAME_ONGOING) {
+			static const char *const REASONS[] = { "", "checkmate", "stalemate", "threefold repetition",
+				"fifty-move rule", "insufficient material" };
+			game.white_result = state == GAME_CHECKMATE ? (pos.side_to_move() == WHITE ? -1 : 1) : 0;
+			game.reason = REASONS[state];
+			return true;
+		}
+		if (ply >= config.max_plies) {
+			game.reason = "adjudication: move limit";
+			return true;
+		}
+		if (stop) {
+			return false;
+		}
+
+		int us = pos.side_to_move();
+		const EngineConfig &engine = *engines[us];
+		SearchLimits limits;
+		limits.nodes = engine.nodes;
+		limits.depth = engine.depth;
+		// As in chess_epd: a fixed movetime is searched in full, without the GUI overhead.
+		limits.movetime = engine.movetime > 0 ? engine.movetime + TimeManager::MOVE_OVERHEAD_MS : 0;
+		if (engine.base_ms > 0) {
+			limits.time[us] = clock[us] / 1000;
+			limits.increment[us] = engine.increment_ms;
+		}
+
+		auto start_time = std::chrono::steady_clock::now();
+		SearchResult searched = searches[us]->run(pos, limits);
+		int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+		game.nodes[players[us]] += searched.nodes;
+		game.time_us[players[us]] += elapsed;
+		game.moves[players[us]]++;
+
+		if (engine.base_ms > 0) {
+			clock[us] -= elapsed;
+			if (clock[us] < 0) {
+				game.white_result = us == WHITE ? -1 : 1;
+				game.reason = "loss on time";
+				game.time_loss = true;
+				return true;
+			}
+			clock[us] += engine.increment_ms * 1000;
+		}
+
+		// Adjudication on White's point of view, so both engines' scores count towards a run.
+		int white_score = us == WHITE ? searched.score : -searched.score;
+		win_run = white_score >= config.resign_score ? win_run + 1 : 0;
+		loss_run = white_score <= -config.resign_score ? loss_run + 1 : 0;
+		draw_run = ply >= config.draw_min_ply && std::abs(white_score) <= config.draw_score ? draw_run + 1 : 0;
+		if (config.resign_plies > 0 && (win_run >= config.resign_plies || loss_run >= config.resign_plies)) {
+			game.white_result = win_run > 0 ? 1 : -1;
+			game.reason = "adjudication: resign";
+			return true;
+		}
+		if (config.draw_plies > 0 && draw_run >= config.draw_plies) {
+			game.reason = "adjudication: draw";
+			return true;
+		}
+
+		game.san.push_back(move_to_san(pos, searched.best_move));
+		pos.make_move(searched.best_move, undo);
+	}
+}
+
+double score_to_elo(double score) {
+	score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+	return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// "inf" for a perfect (or perfectly lost) score, which no finite difference explains.
+std::string elo_text(const MatchStats &stats, double elo, double margin) {
+	char buffer[64];
+	if (stats.games() > 0 && (stats.wins == stats.games() || stats.losses == stats.games())) {
+		return stats.wins > 0 ? "+inf" : "-inf";
+	}
+	std::snprintf(buffer, sizeof(buffer), "%.1f +/- %.1f", elo, margin);
+	return buffer;
+}
+
+double elo_to_score(double elo) {
+	return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Elo difference and half the width of its 95% interval, from the game results.
+void elo_estimate(const MatchStats &stats, double &elo, double &margin) {
+	int64_t games = stats.games();
+	double score = stats.score();
+	elo = score_to_elo(score);
+	margin = 0.0;
+	if (games == 0) {
+		return;
+	}
+	double variance = (stats.wins * (1.0 - score) * (1.0 - score) + stats.draws * (0.5 - score) * (0.5 - score) +
+			stats.losses * score * score) / games;
+	double deviation = 1.959964 * std::sqrt(variance / games);
+	margin = (score_to_elo(score + deviation) - score_to_elo(score - deviation)) / 2.0;
+}
+
+// Likelihood of superiority: probability the first engine is the stronger one, draws ignored.
+double likelihood_of_superiority(const MatchStats &stats) {
+	if (stats.wins + stats.losses == 0) {
+		return 0.5;
+	}
+	return 0.5 * (1.0 + std::erf((stats.wins - stats.losses) / std::sqrt(2.0 * (stats.wins + stats.losses))));
+}
+
+// Most likely pair-score distribution with the given mean: observed[i] / (1 + lambda * (a_i - mean))
+// for the outcome values a_i = i / 4, lambda found by bisection (the mean constraint is monotonic in it).
+double constrained_lambda(const double observed[5], double mean) {
+	double low = -1.0 / (1.0 - mean);
+	double high = 1.0 / mean;
+	for (int iteration = 0; iteration < 100; iteration++) {
+		double lambda = (low + high) / 2.0;
+		double excess = 0.0;
+		for (int i = 0; i < 5; i++) {
+			excess += observed[i] * (i / 4.0 - mean) / (1.0 + lambda * (i / 4.0 - mean));
+		}
+		(excess > 0.0 ? low : high) = lambda;
+	}
+	return (low + high) / 2.0;
+}
+
+// Generalized SPRT on the pentanomial pair results: the log-likelihood ratio of the most likely
+// distributions whose mean pair score is ELO1's and ELO0's expected score. Empty outcome classes
+// count as a thousandth of a pair so that early one-sided results do not decide the test alone.
+double sprt_llr(const MatchStats &stats, const MatchConfig &config) {
+	int64_t pairs = stats.pairs();
+	if (pairs == 0) {
+		return 0.0;
+	}
+	double observed[5];
+	double total = 0.0;
+	for (int i = 0; i < 5; i++) {
+		observed[i] = std::max((double)stats.pentanomial[i], 1e-3);
+		total += observed[i];
+	}
+	for (int i = 0; i < 5; i++) {
+		observed[i] /= total;
+	}
+	double s0 = elo_to_score(config.elo0);
+	double s1 = elo_to_score(config.elo1);
+	double lambda0 = constrained_lambda(observed, s0);
+	double lambda1 = constrained_lambda(observed, s1);
+	double llr = 0.0;
+	for (int i = 0; i < 5; i++) {
+		llr += observed[i] * (std::log(1.0 + lambda0 * (i / 4.0 - s0)) - std::log(1.0 + lambda1 * (i / 4.0 - s1)));
+	}
+	return pairs * llr;
+}
+
+void sprt_bounds(const MatchConfig &config, double &lower, double &upper) {
+	lower = std::log(config.beta / (1.0 - config.alpha));
+	upper = std::log((1.0 - config.beta) / config.alpha);
+}
+
+std::string pgn_escape(const std::string &text) {
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+void write_pgn_game(std::FILE *file, const GameResult &game, const std::string &white, const std::string &black, int round) {
+	const char *result = game.white_result > 0 ? "1-0" : game.white_result < 0 ? "0-1" : "1/2-1/2";
+	std::fprintf(file, "[Event \"chess_match\"]\n[Round \"%d\"]\n[White \"%s\"]\n[Black \"%s\"]\n[Result \"%s\"]\n",
+			round, pgn_escape(white).c_str(), pgn_escape(black).c_str(), result);
+	Position start;
+	start.set_fen(game.start_fen);
+	std::fprintf(file, "[FEN \"%s\"]\n[SetUp \"1\"]\n[Termination \"%s\"]\n\n", game.start_fen.c_str(),
+			pgn_escape(game.reason).c_str());
+
+	int number = start.get_fullmove_number();
+	bool white_to_move = start.side_to_move() == WHITE;
+	std::string line;
+	for (size_t i = 0; i < game.san.size(); i++) {
+		std::string token;
+		if (white_to_move) {
+			token = std::to_string(number) + ". ";
+		} else if (i == 0) {
+			token = std::to_string(number) + "... ";
+		}
+		token += game.san[i];
+		if (!line.empty() && line.size() + token.size() + 1 > 79) {
+			std::fprintf(file, "%s\n", line.c_str());
+			line.clear();
+		}
+		line += (line.empty() ? "" : " ") + token;
+		if (!white_to_move) {
+			number++;
+		}
+		white_to_move = !white_to_move;
+	}
+	line += (line.empty() ? "" : " ") + std::string(result);
+	std::fprintf(file, "%s\n\n", line.c_str());
+}
+
+void print_usage() {
+	std::fprintf(stderr, "usage: chess_match --engine name=A [eval=a.bin] [key=value...] --engine name=B [key=value...]\n"
+			"                   [--games N] [--concurrency N] [--openings suite.epd] [--shuffle] [--random-plies N]\n"
+			"                   [--tc BASE+INC] [--nodes N] [--movetime MS] [--depth N] [--hash MB]\n"
+			"                   [--sprt ELO0 ELO1 [ALPHA BETA]] [--max-plies N] [--resign SCORE PLIES]\n"
+			"                   [--draw PLY SCORE PLIES] [--pgn games.pgn] [--seed N]\n");
+}
+
+bool is_number(const char *text) {
+	char *end = nullptr;
+	std::strtod(text, &end);
+	return end != text && *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	MatchConfig config;
+	int hardware_threads = (int)std::thread::hardware_concurrency();
+	config.concurrency = hardware_threads > 0 ? hardware_threads : 1;
+	EngineConfig defaults;
+	std::vector<std::vector<std::string>> engine_options;
+	std::string openings_path;
+	std::string pgn_path;
+	bool shuffle = false;
+	bool valid = true;
+	for (int i = 1; i < argc && valid; i++) {
+		std::string arg = argv[i];
+		std::string error;
+		if (arg == "--engine") {
+			// key=value tokens up to the next option.
+			engine_options.emplace_back();
+			while (i + 1 < argc && std::string(argv[i + 1]).find('=') != std::string::npos && argv[i + 1][0] != '-') {
+				engine_options.back().push_back(argv[++i]);
+			}
+		} else if (arg == "--games" && i + 1 < argc) {
+			config.games = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--concurrency" && i + 1 < argc) {
+			config.concurrency = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--openings" && i + 1 < argc) {
+			openings_path = argv[++i];
+		} else if (arg == "--shuffle") {
+			shuffle = true;
+		} else if (arg == "--random-plies" && i + 1 < argc) {
+			config.random_plies = std::max(0, std::atoi(argv[++i]));
+		} else if ((arg == "--tc" || arg == "--nodes" || arg == "--movetime" || arg == "--depth" || arg == "--hash") && i + 1 < argc) {
+			valid = apply_engine_option(defaults, arg.substr(2), argv[++i], error);
+		} else if (arg == "--sprt" && i + 2 < argc) {
+			config.sprt = true;
+			config.elo0 = std::atof(argv[++i]);
+			config.elo1 = std::atof(argv[++i]);
+			if (i + 2 < argc && is_number(argv[i + 1]) && is_number(argv[i + 2])) {
+				config.alpha = std::atof(argv[++i]);
+				config.beta = std::atof(argv[++i]);
+			}
+			valid = config.elo1 > config.elo0 && config.alpha > 0.0 && config.alpha < 0.5 && config.beta > 0.0 && config.beta < 0.5;
+		} else if (arg == "--max-plies" && i + 1 < argc) {
+			config.max_plies = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--resign" && i + 2 < argc) {
+			config.resign_score = std::atoi(argv[++i]);
+			config.resign_plies = std::max(0, std::atoi(argv[++i]));
+		} else if (arg == "--draw" && i + 3 < argc) {
+			config.draw_min_ply = std::max(0, std::atoi(argv[++i]));
+			config.draw_score = std::max(0, std::atoi(argv[++i]));
+			config.draw_plies = std::max(0, std::atoi(argv[++i]));
+		} else if (arg == "--pgn" && i + 1 < argc) {
+			pgn_path = argv[++i];
+		} else if (arg == "--seed" && i + 1 < argc) {
+			config.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			valid = false;
+		}
+		if (!error.empty()) {
+			std::fprintf(stderr, "chess_match: %s\n", error.c_str());
+		}
+	}
+	if (!valid || engine_options.size() != 2) {
+		print_usage();
+		return 1;
+	}
+
+	EngineConfig engines[2];
+	for (int e = 0; e < 2; e++) {
+		engines[e] = defaults;
+		engines[e].name = e == 0 ? "A" : "B";
+		for (const std::string &option : engine_options[e]) {
+			size_t equals = option.find('=');
+			std::string error;
+			if (!apply_engine_option(engines[e], option.substr(0, equals), option.substr(equals + 1), error)) {
+				std::fprintf(stderr, "chess_match: %s\n", error.c_str());
+				return 1;
+			}
+		}
+		if (!engines[e].has_limit()) {
+			engines[e].base_ms = 10000;
+			engines[e].increment_ms = 100;
+		}
+		// Without a trained network there is nothing for the network modes to evaluate with.
+		if (!engines[e].eval_path.empty()) {
+			engines[e].network = std::make_shared<Network>();
+			if (!engines[e].network->load(engines[e].eval_path)) {
+				std::fprintf(stderr, "chess_match: cannot load network %s\n", engines[e].eval_path.c_str());
+				return 1;
+			}
+		} else if (engines[e].eval_mode == "network" || engines[e].eval_mode == "hybrid") {
+			std::fprintf(stderr, "chess_match: engine %s: mode=%s needs eval=\n", engines[e].name.c_str(),
+					engines[e].eval_mode.c_str());
+			return 1;
+		}
+	}
+	if (config.games <= 0) {
+		config.games = config.sprt ? 100000 : 100;
+	}
+	// Whole pairs only, so colours stay balanced.
+	config.games += config.games % 2;
+
+	std::vector<Opening> openings;
+	if (!openings_path.empty()) {
+		if (!read_openings(openings_path, openings)) {
+			return 1;
+		}
+		if (openings.empty()) {
+			std::fprintf(stderr, "chess_match: no openings in %s\n", openings_path.c_str());
+			return 1;
+		}
+		if (shuffle) {
+			std::mt19937 rng(config.seed);
+			std::shuffle(openings.begin(), openings.end(), rng);
+		}
+	}
+
+	int thread_count = std::min(config.concurrency, config.games);
+	int busy_threads = thread_count * std::max(engines[0].threads, engines[1].threads);
+	if ((engines[0].base_ms > 0 || engines[1].base_ms > 0 || engines[0].movetime > 0 || engines[1].movetime > 0) &&
+			hardware_threads > 0 && busy_threads > hardware_threads) {
+		std::fprintf(stderr, "chess_match: warning: %d search threads on %d cores distort timed games\n", busy_threads,
+				hardware_threads);
+	}
+
+	std::FILE *pgn = nullptr;
+	if (!pgn_path.empty()) {
+		pgn = std::fopen(pgn_path.c_str(), "w");
+		if (pgn == nullptr) {
+			std::fprintf(stderr, "chess_match: cannot write %s\n", pgn_path.c_str());
+			return 1;
+		}
+	}
+
+	std::string opening_text = openings.empty() ? "random openings of " + std::to_string(config.random_plies) + " plies" :
+			std::to_string(openings.size()) + " openings from " + openings_path;
+	std::printf("%s vs %s: %d games on %d threads, %s\n", engines[0].name.c_str(), engines[1].name.c_str(), config.games,
+			thread_count, opening_text.c_str());
+	double lower_bound = 0.0;
+	double upper_bound = 0.0;
+	sprt_bounds(config, lower_bound, upper_bound);
+
+	// Games are handed out from a shared counter: game g is pair g / 2, the first engine playing
+	// White in even games. Totals and pair scores are only touched under the mutex.
+	std::atomic<int> next_game(0);
+	std::atomic<bool> stop(false);
+	std::mutex stats_mutex;
+	MatchStats stats;
+	std::vector<int> pair_points(config.games / 2, 0);  // First engine's half points so far.
+	std::vector<int> pair_games(config.games / 2, 0);
+	int verdict = 0;  // 1: ELO1 accepted, -1: ELO0 accepted.
+	auto start_time = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < thread_count; t++) {
+		workers.emplace_back([&]() {
+			std::unique_ptr<Search> own[2];
+			for (int e = 0; e < 2; e++) {
+				own[e].reset(new Search());
+				own[e]->set_threads(engines[e].threads);
+				own[e]->set_hash_size(engines[e].hash_mb);
+				own[e]->set_network(engines[e].network.get());
+				own[e]->set_eval_mode(engines[e].network == nullptr || engines[e].eval_mode == "handcrafted" ? EVAL_HANDCRAFTED :
+						engines[e].eval_mode == "hybrid" ? EVAL_HYBRID : EVAL_NETWORK);
+				own[e]->set_params(engines[e].params);
+				own[e]->set_skill_level(engines[e].skill_level);
+				if (engines[e].elo > 0) {
+					own[e]->set_elo(engines[e].elo);
+				}
+			}
+
+			for (int g = next_game++; g < config.games && !stop; g = next_game++) {
+				int pair = g / 2;
+				int first = g % 2 == 0 ? WHITE : BLACK;  // Colour of the first engine.
+				int players[2];
+				players[first] = 0;
+				players[1 - first] = 1;
+				Search *searches[2] = { own[players[WHITE]].get(), own[players[BLACK]].get() };
+				const EngineConfig *configs[2] = { &engines[players[WHITE]], &engines[players[BLACK]] };
+				// A fresh table per game, as a GUI's new-game command would give.
+				searches[WHITE]->clear();
+				searches[BLACK]->clear();
+
+				GameResult game;
+				if (!play_game(opening_position(openings, config, pair), searches, configs, players, config, stop, game)) {
+					break;
+				}
+				int first_result = first == WHITE ? game.white_result : -game.white_result;
+
+				std::lock_guard<std::mutex> lock(stats_mutex);
+				if (stop) {
+					break;
+				}
+				stats.wins += first_result > 0;
+				stats.losses += first_result < 0;
+				stats.draws += first_result == 0;
+				stats.time_losses += game.time_loss;
+				for (int e = 0; e < 2; e++) {
+					stats.nodes[e] += game.nodes[e];
+					stats.time_us[e] += game.time_us[e];
+					stats.moves[e] += game.moves[e];
+				}
+				pair_points[pair] += first_result + 1;
+				if (++pair_games[pair] == 2) {
+					stats.pentanomial[pair_points[pair]]++;
+				}
+				if (pgn != nullptr) {
+					write_pgn_game(pgn, game, configs[WHITE]->name, configs[BLACK]->name, g + 1);
+				}
+
+				double elo = 0.0;
+				double margin = 0.0;
+				elo_estimate(stats, elo, margin);
+				std::printf("Game %d: %s vs %s %s (%s) | %lld-%lld-%lld, Elo %s, LOS %.1f%%", g + 1,
+						configs[WHITE]->name.c_str(), configs[BLACK]->name.c_str(),
+						game.white_result > 0 ? "1-0" : game.white_result < 0 ? "0-1" : "1/2-1/2", game.reason.c_str(),
+						(long long)stats.wins, (long long)stats.losses, (long long)stats.draws,
+						elo_text(stats, elo, margin).c_str(), 100.0 * likelihood_of_superiority(stats));
+				if (config.sprt) {
+					double llr = sprt_llr(stats, config);
+					std::printf(", LLR %.2f (%.2f, %.2f)", llr, lower_bound, upper_bound);
+					if (llr >= upper_bound || llr <= lower_bound) {
+						verdict = llr >= upper_bound ? 1 : -1;
+						stop = true;
+					}
+				}
+				std::printf("\n");
+				std::fflush(stdout);
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	if (pgn != nullptr && std::fclose(pgn) != 0) {
+		std::fprintf(stderr, "chess_match: cannot write %s\n", pgn_path.c_str());
+	}
+
+	double elo = 0.0;
+	double margin = 0.0;
+	elo_estimate(stats, elo, margin);
+	std::printf("\n%s vs %s: %lld games in %.1f s, +%lld -%lld =%lld, score %.1f%%", engines[0].name.c_str(),
+			engines[1].name.c_str(), (long long)stats.games(), seconds, (long long)stats.wins, (long long)stats.losses,
+			(long long)stats.draws, 100.0 * stats.score());
+	if (stats.time_losses > 0) {
+		std::printf(", %lld lost on time", (long long)stats.time_losses);
+	}
+	std::printf("\nElo %s, LOS %.1f%%\n", elo_text(stats, elo, margin).c_str(), 100.0 * likelihood_of_superiority(stats));
+	std::printf("Pairs (0, 0.5, 1, 1.5, 2 points for %s): %lld %lld %lld %lld %lld\n", engines[0].name.c_str(),
+			(long long)stats.pentanomial[0], (long long)stats.pentanomial[1], (long long)stats.pentanomial[2],
+			(long long)stats.pentanomial[3], (long long)stats.pentanomial[4]);
+	// Cost per move, to compare strength per CPU-second rather than per move.
+	for (int e = 0; e < 2; e++) {
+		std::printf("%s: %lld moves, %.1f ms and %lld nodes per move, %.0f nps\n", engines[e].name.c_str(),
+				(long long)stats.moves[e], stats.moves[e] > 0 ? stats.time_us[e] / 1000.0 / stats.moves[e] : 0.0,
+				(long long)(stats.moves[e] > 0 ? stats.nodes[e] / stats.moves[e] : 0),
+				stats.time_us[e] > 0 ? stats.nodes[e] * 1e6 / stats.time_us[e] : 0.0);
+	}
+	if (config.sprt) {
+		std::printf("SPRT elo0 %.1f elo1 %.1f alpha %.3f beta %.3f: LLR %.2f (%.2f, %.2f), %s\n", config.elo0, config.elo1,
+				config.alpha, config.beta, sprt_llr(stats, config), lower_bound, upper_bound,
+				verdict > 0 ? "H1 accepted" : verdict < 0 ? "H0 accepted" : "inconclusive");
+	}
+	return 0;
+}
@@ -4,12 +4,12 @@
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/binder_common.hpp>
 #include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
-// Standard headers for math, randomness, and time seeding.
-#include <cmath>
-#include <cstdlib>
-#include <ctime>
+// Standard headers for seeding the random weights.
+#include <chrono>
+#include <random>
 
 using namespace godot;
 
@@ -17,10 +17,20 @@ using namespace godot;
 void NeuralNet::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_layer_sizes", "sizes"), &NeuralNet::set_layer_sizes);
 	ClassDB::bind_method(D_METHOD("get_layer_sizes"), &NeuralNet::get_layer_sizes);
+	ClassDB::bind_method(D_METHOD("set_activations", "names"), &NeuralNet::set_activations);
+	ClassDB::bind_method(D_METHOD("get_activations"), &NeuralNet::get_activations);
+	ClassDB::bind_method(D_METHOD("set_layer_activation", "layer", "name"), &NeuralNet::set_layer_activation);
+	ClassDB::bind_method(D_METHOD("save_model", "path"), &NeuralNet::save_model);
+	ClassDB::bind_method(D_METHOD("load_model", "path"), &NeuralNet::load_model);
 	ClassDB::bind_method(D_METHOD("set_inputs", "inputs"), &NeuralNet::set_inputs);
 	ClassDB::bind_method(D_METHOD("get_outputs"), &NeuralNet::get_outputs);
 	ClassDB::bind_method(D_METHOD("compute"), &NeuralNet::compute);
 	ClassDB::bind_method(D_METHOD("train", "inputs", "expected_outputs"), &NeuralNet::train);
+	ClassDB::bind_method(D_METHOD("train_with_policy", "inputs", "expected_outputs", "policy_indices", "policy_targets"),
+			&NeuralNet::train_with_policy);
+	ClassDB::bind_method(D_METHOD("get_policy", "policy_indices"), &NeuralNet::get_policy);
+	ClassDB::bind_method(D_METHOD("set_policy_size", "size"), &NeuralNet::set_policy_size);
+	ClassDB::bind_method(D_METHOD("get_policy_size"), &NeuralNet::get_policy_size);
 	ClassDB::bind_method(D_METHOD("get_cost", "inputs", "expected_outputs"), &NeuralNet::get_cost);
 	ClassDB::bind_method(D_METHOD("set_learning_rate", "rate"), &NeuralNet::set_learning_rate);
 	ClassDB::bind_method(D_METHOD("get_learning_rate"), &NeuralNet::get_learning_rate);
@@ -32,6 +42,18 @@ void NeuralNet::_bind_methods() {
 		"set_layer_sizes",
 		"get_layer_sizes"
 	);
+	ClassDB::add_property(
+		"NeuralNet",
+		PropertyInfo(Variant::ARRAY, "activations"),
+		"set_activations",
+		"get_activations"
+	);
+	ClassDB::add_property(
+		"NeuralNet",
+		PropertyInfo(Variant::INT, "policy_size"),
+		"set_policy_size",
+		"get_policy_size"
+	);
 	ClassDB::add_property(
 		"NeuralNet",
 		PropertyInfo(Variant::FLOAT, "learning_rate"),
@@ -42,9 +64,7 @@ void NeuralNet::_bind_methods() {
 
 // Initialize default state, but do not build the network yet.
 NeuralNet::NeuralNet() {
-	network_initialized = false;
 	learning_rate = 0.1;
-	srand(time(nullptr)); // Seed RNG for random weights/biases.
 }
 
 NeuralNet::~NeuralNet() {}
@@ -52,180 +72,120 @@ NeuralNet::~NeuralNet() {}
 // Optionally auto-compute once when running the game (not in editor).
 void NeuralNet::_ready() {
 	if (!Engine::get_singleton()->is_editor_hint()) {
-		if (network_initialized && input_values.size() > 0) {
+		if (network.is_initialized() && input_values.size() > 0) {
 			compute();
 		}
 	}
 }
 
-// Standard sigmoid activation.
-double NeuralNet::sigmoid(double x) {
-	return 1.0 / (1.0 + std::exp(-x));
-}
-
-// Derivative of sigmoid, given already-activated value.
-double NeuralNet::sigmoid_derivative(double activated_value) {
-	return activated_value * (1.0 - activated_value);
-}
-
-// Allocate and randomize weights/biases based on layer_sizes.
-void NeuralNet::initialize_network() {
-	if (layer_sizes.size() < 2) {
-		UtilityFunctions::print("Error: Need at least 2 layers");
-		return;
+// Pad or truncate inputs to the input layer; missing inputs read as zero.
+void NeuralNet::load_inputs(const Array &inputs) {
+	input_values.assign(network.input_size(), 0.0f);
+	for (int i = 0; i < inputs.size() && i < (int)input_values.size(); i++) {
+		input_values[i] = (float)(double)inputs[i];
 	}
+}
 
-	weights.clear();
-	biases.clear();
-	activations.clear();
-
-	// Prepare activations for each layer (all zeros initially).
-	activations.resize(layer_sizes.size());
-	for (size_t i = 0; i < layer_sizes.size(); i++) {
-		activations[i].resize(layer_sizes[i], 0.0);
+bool NeuralNet::load_targets(const Array &expected_outputs) {
+	if (expected_outputs.size() != network.output_size()) {
+		UtilityFunctions::print("Error: Output size mismatch");
+		return false;
 	}
-
-	// For each pair of consecutive layers, create a weight matrix and bias vector.
-	for (size_t layer = 1; layer < layer_sizes.size(); layer++) {
-		int current_layer_size = layer_sizes[layer];
-		int previous_layer_size = layer_sizes[layer - 1];
-
-		std::vector<std::vector<double>> layer_weights;
-		for (int neuron = 0; neuron < current_layer_size; neuron++) {
-			std::vector<double> neuron_weights;
-			for (int weight = 0; weight < previous_layer_size; weight++) {
-				// Random weight in range [-1, 1].
-				double random_weight = ((double)std::rand() / RAND_MAX) * 2.0 - 1.0;
-				neuron_weights.push_back(random_weight);
-			}
-			layer_weights.push_back(neuron_weights);
-		}
-		weights.push_back(layer_weights);
-
-		std::vector<double> layer_biases;
-		for (int neuron = 0; neuron < current_layer_size; neuron++) {
-			// Random bias in range [-1, 1].
-			double random_bias = ((double)std::rand() / RAND_MAX) * 2.0 - 1.0;
-			layer_biases.push_back(random_bias);
-		}
-		biases.push_back(layer_biases);
+	target_values.resize(expected_outputs.size());
+	for (int i = 0; i < expected_outputs.size(); i++) {
+		target_values[i] = (float)(double)expected_outputs[i];
 	}
-
-	network_initialized = true;
+	return true;
 }
 
-// Forward pass: write inputs into layer 0 and propagate through all layers.
+// Forward pass over the current inputs; the last layer becomes output_values.
 void NeuralNet::forward_propagation() {
-	if (!network_initialized) {
+	if (!network.is_initialized()) {
 		return;
 	}
 
-	// Load input values into first layer's activations (truncate if oversized).
-	for (size_t i = 0; i < input_values.size() && i < activations[0].size(); i++) {
-		activations[0][i] = input_values[i];
+	if ((int)input_values.size() != network.input_size()) {
+		input_values.resize(network.input_size(), 0.0f);
 	}
-
-	// Compute activations layer by layer using weights, biases, and sigmoid.
-	for (size_t layer = 1; layer < layer_sizes.size(); layer++) {
-		for (int neuron = 0; neuron < layer_sizes[layer]; neuron++) {
-			double sum = biases[layer - 1][neuron];
-
-			for (int prev_neuron = 0; prev_neuron < layer_sizes[layer - 1]; prev_neuron++) {
-				sum += activations[layer - 1][prev_neuron] *
-					weights[layer - 1][neuron][prev_neuron];
-			}
-
-			activations[layer][neuron] = sigmoid(sum);
-		}
-	}
-
-	// Last layer activations are the output values.
-	output_values = activations[layer_sizes.size() - 1];
+	const float *outputs = network.forward(input_values.data(), workspace);
+	output_values.assign(outputs, outputs + network.output_size());
 }
 
 // Single-sample training using backpropagation and gradient descent.
 void NeuralNet::train(const Array &inputs, const Array &expected_outputs) {
-	if (!network_initialized) {
+	if (!network.is_initialized()) {
 		return;
 	}
 
-	set_inputs(inputs);
-	forward_propagation();
-
-	if (output_values.size() != (size_t)expected_outputs.size()) {
-		UtilityFunctions::print("Error: Output size mismatch");
+	load_inputs(inputs);
+	if (!load_targets(expected_outputs)) {
 		return;
 	}
+	network.train(input_values.data(), target_values.data(), (float)learning_rate, workspace);
+}
 
-	// Compute output layer deltas from error and activation derivative.
-	std::vector<double> next_layer_deltas;
-	for (size_t i = 0; i < output_values.size(); i++) {
-		double output = output_values[i];
-		double target = (double)expected_outputs[i];
-		double error_term = (target - output);
-		double delta = error_term * sigmoid_derivative(output);
-		next_layer_deltas.push_back(delta);
+// Single-sample training of the outputs and the policy head together.
+void NeuralNet::train_with_policy(const Array &inputs, const Array &expected_outputs, const Array &policy_indices,
+		const Array &policy_targets) {
+	if (!network.is_initialized()) {
+		return;
+	}
+	if (!network.has_policy() || policy_indices.size() != policy_targets.size()) {
+		UtilityFunctions::print("Error: Policy target mismatch");
+		return;
 	}
 
-	// Backpropagate through all weight layers from last to first.
-	for (int i = (int)weights.size() - 1; i >= 0; i--) {
-		int current_layer_idx = i;
-		int next_layer_idx = i + 1;
-
-		int current_layer_size = layer_sizes[current_layer_idx];
-		int next_layer_size = layer_sizes[next_layer_idx];
-
-		std::vector<double> current_layer_deltas;
-
-		// Compute deltas for the current layer (except for input layer).
-		if (i > 0) {
-			current_layer_deltas.resize(current_layer_size, 0.0);
-
-			for (int k = 0; k < current_layer_size; k++) {
-				double error_sum = 0.0;
-				for (int j = 0; j < next_layer_size; j++) {
-					error_sum += next_layer_deltas[j] * weights[i][j][k];
-				}
-				current_layer_deltas[k] =
-					error_sum * sigmoid_derivative(activations[current_layer_idx][k]);
-			}
-		}
-
-		// Gradient descent update for biases and weights for this weight layer.
-		for (int j = 0; j < next_layer_size; j++) {
-			double delta = next_layer_deltas[j];
-
-			// Bias gradient is just the delta.
-			biases[i][j] += learning_rate * delta;
-
-			// Weight gradient uses activations of previous layer.
-			for (int k = 0; k < current_layer_size; k++) {
-				weights[i][j][k] += learning_rate * delta * activations[current_layer_idx][k];
-			}
+	load_inputs(inputs);
+	if (!load_targets(expected_outputs)) {
+		return;
+	}
+	std::vector<int> indices(policy_indices.size());
+	std::vector<float> probabilities(policy_targets.size());
+	for (int i = 0; i < policy_indices.size(); i++) {
+		indices[i] = (int)policy_indices[i];
+		probabilities[i] = (float)(double)policy_targets[i];
+		if (indices[i] < 0 || indices[i] >= network.policy_size()) {
+			UtilityFunctions::print("Error: Policy index out of range");
+			return;
 		}
+	}
+	chess::Network::PolicyTarget policy;
+	policy.indices = indices.data();
+	policy.probabilities = probabilities.data();
+	policy.count = (int)indices.size();
+	network.train(input_values.data(), target_values.data(), (float)learning_rate, workspace, &policy);
+}
 
-		// Move one layer backwards.
-		next_layer_deltas = current_layer_deltas;
+// Policy of the last forward pass; empty before compute() or without a policy head.
+Array NeuralNet::get_policy(const Array &policy_indices) const {
+	Array result;
+	if (!network.has_policy() || output_values.empty()) {
+		return result;
+	}
+	std::vector<float> logits;
+	for (int i = 0; i < policy_indices.size(); i++) {
+		int index = (int)policy_indices[i];
+		bool valid = index >= 0 && index < network.policy_size();
+		logits.push_back(valid ? network.policy_logit(network.trunk(workspace), index) : -1e30f);
+	}
+	chess::softmax(logits.data(), (int)logits.size());
+	for (float probability : logits) {
+		result.append(probability);
 	}
+	return result;
 }
 
 // Compute mean-squared-error style cost for a given sample.
 double NeuralNet::get_cost(const Array &inputs, const Array &expected_outputs) {
-	if (!network_initialized) {
+	if (!network.is_initialized()) {
 		return 0.0;
 	}
 
-	set_inputs(inputs);
-	forward_propagation();
-
-	double total_squared_error = 0.0;
-	for (size_t i = 0; i < output_values.size(); i++) {
-		double diff = (double)expected_outputs[i] - output_values[i];
-		total_squared_error += diff * diff;
+	load_inputs(inputs);
+	if (!load_targets(expected_outputs)) {
+		return 0.0;
 	}
-
-	// 0.5 factor is standard for convenient derivative (d/dx of 0.5*x^2 = x).
-	return 0.5 * total_squared_error;
+	return network.cost(input_values.data(), target_values.data(), workspace);
 }
 
 // Simple setters/getters for learning rate.
@@ -237,30 +197,82 @@ double NeuralNet::get_learning_rate() const {
 	return learning_rate;
 }
 
-// Configure network topology from a Godot Array and rebuild the network.
+// Configure network topology from a Godot Array and rebuild the network with fresh random weights.
 void NeuralNet::set_layer_sizes(const Array &sizes) {
-	layer_sizes.clear();
+	std::vector<int> layer_sizes;
 	for (int i = 0; i < sizes.size(); i++) {
 		layer_sizes.push_back((int)sizes[i]);
 	}
-	initialize_network();
+	if (layer_sizes.size() < 2) {
+		UtilityFunctions::print("Error: Need at least 2 layers");
+		return;
+	}
+
+	uint64_t seed = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^ std::random_device()();
+	network.set_layer_sizes(layer_sizes, seed);
+	network.init_workspace(workspace);
+	output_values.clear();
 }
 
 // Return layer_sizes as a Godot Array.
 Array NeuralNet::get_layer_sizes() const {
 	Array result;
-	for (size_t i = 0; i < layer_sizes.size(); i++) {
-		result.append(layer_sizes[i]);
+	for (int size : network.get_layer_sizes()) {
+		result.append(size);
 	}
 	return result;
 }
 
-// Convert Godot Array inputs into internal double vector.
-void NeuralNet::set_inputs(const Array &inputs) {
-	input_values.clear();
-	for (int i = 0; i < inputs.size(); i++) {
-		input_values.push_back((double)inputs[i]);
+void NeuralNet::set_activations(const Array &names) {
+	for (int i = 0; i < names.size(); i++) {
+		set_layer_activation(i + 1, names[i]);
+	}
+}
+
+Array NeuralNet::get_activations() const {
+	Array result;
+	for (chess::Activation activation : network.get_activations()) {
+		result.append(String(chess::activation_name(activation)));
+	}
+	return result;
+}
+
+bool NeuralNet::set_layer_activation(int layer, const String &name) {
+	chess::Activation activation;
+	if (!chess::parse_activation(name.utf8().get_data(), activation) || !network.set_activation(layer, activation)) {
+		UtilityFunctions::print("Error: Bad activation ", name, " for layer ", layer);
+		return false;
+	}
+	return true;
+}
+
+bool NeuralNet::save_model(const String &path) const {
+	String file = ProjectSettings::get_singleton()->globalize_path(path);
+	return network.save(file.utf8().get_data());
+}
+
+bool NeuralNet::load_model(const String &path) {
+	String file = ProjectSettings::get_singleton()->globalize_path(path);
+	if (!network.load(file.utf8().get_data())) {
+		UtilityFunctions::print("Error: Could not load model ", path);
+		return false;
 	}
+	network.init_workspace(workspace);
+	output_values.clear();
+	return true;
+}
+
+void NeuralNet::set_policy_size(int size) {
+	network.set_policy_size(size);
+}
+
+int NeuralNet::get_policy_size() const {
+	return network.policy_size();
+}
+
+// Convert Godot Array inputs into the internal float buffer.
+void NeuralNet::set_inputs(const Array &inputs) {
+	load_inputs(inputs);
 }
 
 // Export current output_values to Godot Array.
@@ -276,3 +288,28 @@ Array NeuralNet::get_outputs() const {
 void NeuralNet::compute() {
 	forward_propagation();
 }
+
+const chess::Network &NeuralNet::get_network() const {
+	return network;
+}
+
+chess::Network &NeuralNet::get_network() {
+	return network;
+}
+
+// Every mutation of the weights or topology moves the revision on.
+std::shared_ptr<const chess::Network> NeuralNet::get_snapshot() {
+	if (!snapshot || snapshot->revision() != network.revision()) {
+		snapshot = std::make_shared<const chess::Network>(network);
+	}
+	return snapshot;
+}
+
+// Duplicate another network's parameters.
+void NeuralNet::copy_from(const NeuralNet *other) {
+	network = other->network;
+	network.init_workspace(workspace);
+	learning_rate = other->learning_rate;
+	input_values.clear();
+	output_values.clear();
+}
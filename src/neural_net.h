@@ -5,7 +5,11 @@
 #include <godot_cpp/classes/node2d.hpp>
 #include <godot_cpp/variant/array.hpp>
 
-// STL containers for internal numeric storage.
+// The maths lives in the Godot-free core; this node converts Arrays and holds the scratch buffers.
+#include "core/network.h"
+
+// STL containers for internal numeric storage, and the shared snapshot handed to searches.
+#include <memory>
 #include <vector>
 
 namespace godot {
@@ -15,31 +19,26 @@ class NeuralNet : public Node2D {
 	GDCLASS(NeuralNet, Node2D)
 
 private:
-	// Network topology: number of neurons per layer, including input and output.
-	std::vector<int> layer_sizes;
+	// Topology, weights and biases.
+	chess::Network network;
 
-	// Weights and biases:
-	// weights[layer][neuron][weight_from_prev_neuron]
-	std::vector<std::vector<std::vector<double>>> weights; // [layer][neuron][weight]
-	std::vector<std::vector<double>> biases;               // [layer][neuron]
+	// Copy of network last handed to a search; remade once network's revision moves on.
+	std::shared_ptr<const chess::Network> snapshot;
 
-	// Activations[layer][neuron] after forward propagation.
-	std::vector<std::vector<double>> activations;          // [layer][neuron]
+	// Scratch activations/deltas for calls made through this node.
+	chess::Network::Workspace workspace;
 
-	// Current input and last-computed output values (as raw doubles).
-	std::vector<double> input_values;
+	// Current input (padded to the input layer) and last-computed output values.
+	std::vector<float> input_values;
+	std::vector<float> target_values;
 	std::vector<double> output_values;
 
 	// Hyper-parameters and state.
 	double learning_rate;
-	bool network_initialized;
-
-	// Activation function and its derivative.
-	double sigmoid(double x);
-	double sigmoid_derivative(double activated_value);
 
-	// Internal helpers to create and run the network.
-	void initialize_network();
+	// Convert script Arrays into the float buffers the core expects.
+	void load_inputs(const Array &inputs);
+	bool load_targets(const Array &expected_outputs);
 	void forward_propagation();
 
 protected:
@@ -56,6 +55,21 @@ public:
 	void set_layer_sizes(const Array &sizes);
 	Array get_layer_sizes() const;
 
+	// Activation names ("sigmoid", "relu", "clipped_relu", "fast_sigmoid"), one per layer after
+	// the input layer; set_layer_sizes resets them all to "sigmoid".
+	void set_activations(const Array &names);
+	Array get_activations() const;
+	bool set_layer_activation(int layer, const String &name);
+
+	// Policy head of size logits on the last hidden layer, trained alongside the outputs
+	// (0 removes it). It starts uniform and keeps its size across set_layer_sizes.
+	void set_policy_size(int size);
+	int get_policy_size() const;
+
+	// Binary model file (topology, activations, weights); res:// and user:// paths allowed.
+	bool save_model(const String &path) const;
+	bool load_model(const String &path);
+
 	// Set input values from a Godot Array and read outputs back into an Array.
 	void set_inputs(const Array &inputs);
 	Array get_outputs() const;
@@ -70,8 +84,27 @@ public:
 	// Perform one training step (backprop) on a single (inputs, expected_outputs) pair.
 	void train(const Array &inputs, const Array &expected_outputs);
 
+	// Same, also training the policy head: policy_indices are the candidate logits (e.g. legal
+	// moves as from * 64 + to) and policy_targets their target probabilities, summing to 1.
+	void train_with_policy(const Array &inputs, const Array &expected_outputs, const Array &policy_indices,
+			const Array &policy_targets);
+
+	// Softmax over the policy logits at policy_indices for the last computed inputs.
+	Array get_policy(const Array &policy_indices) const;
+
 	// Compute mean-squared-error style cost for a given (inputs, expected_outputs).
 	double get_cost(const Array &inputs, const Array &expected_outputs);
+
+	// Native access for C++ callers on the main thread (self-play, evaluation, learning).
+	const chess::Network &get_network() const;
+	chess::Network &get_network();
+
+	// Immutable copy of the current weights for searches on other threads, so train, load_model
+	// and the other mutators never touch weights a search is reading. Copies only after a change.
+	std::shared_ptr<const chess::Network> get_snapshot();
+
+	// Copy topology, weights and learning rate from another network.
+	void copy_from(const NeuralNet *other);
 };
 
 } // namespace godot
@@ -4,6 +4,8 @@
 #include "board_rules.h"
 #include "neural_net.h"
 #include "chess_agent.h"
+#include "self_play.h"
+#include "chess_host.h"
 
 #include <gdextension_interface.h>
 #include <godot_cpp/core/defs.hpp>
@@ -19,6 +21,8 @@ void initialize_chess_ai_module(ModuleInitializationLevel p_level) {
     ClassDB::register_class<BoardRules>();
     ClassDB::register_class<NeuralNet>();
     ClassDB::register_class<ChessAgent>();
+    ClassDB::register_class<SelfPlay>();
+    ClassDB::register_class<ChessHost>();
 }
 
 void uninitialize_chess_ai_module(ModuleInitializationLevel p_level) {
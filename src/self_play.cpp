@@ -0,0 +1,104 @@
+#include "self_play.h"
+#include "chess_agent.h"
+
+// Godot includes for binding, path resolution and logging.
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace godot;
+
+// Bind methods exposed to GDScript.
+void SelfPlay::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("run", "options"), &SelfPlay::run);
+}
+
+SelfPlay::SelfPlay() {}
+
+SelfPlay::~SelfPlay() {}
+
+// Read run() options, falling back to defaults suited for quick data generation.
+static chess::SelfPlayConfig read_config(const Dictionary &options) {
+    chess::SelfPlayConfig config;
+    int hardware_threads = (int)std::thread::hardware_concurrency();
+
+    config.games = options.get("games", config.games);
+    config.threads = options.get("threads", hardware_threads > 0 ? hardware_threads : 1);
+    config.search_depth = options.get("depth", config.search_depth);
+    config.search_nodes = (int64_t)options.get("nodes", config.search_nodes);
+    config.random_opening_plies = options.get("opening_plies", config.random_opening_plies);
+    config.max_game_plies = options.get("max_plies", config.max_game_plies);
+    config.resign_score = options.get("resign_score", config.resign_score);
+    config.resign_plies = options.get("resign_plies", config.resign_plies);
+    config.draw_score = options.get("draw_score", config.draw_score);
+    config.draw_plies = options.get("draw_plies", config.draw_plies);
+    config.draw_min_ply = options.get("draw_min_ply", config.draw_min_ply);
+    config.hash_mb = options.get("hash", config.hash_mb);
+    config.seed = (uint32_t)(int64_t)options.get("seed", (int64_t)config.seed);
+
+    config.games = std::max(config.games, 0);
+    config.threads = std::max(1, std::min(config.threads, std::max(config.games, 1)));
+    if (config.search_depth <= 0 && config.search_nodes <= 0) {
+        config.search_depth = 1;
+    }
+    return config;
+}
+
+// Run all games through the core; the workers share one read-only network.
+Dictionary SelfPlay::run(const Dictionary &options) {
+    Dictionary stats;
+    chess::SelfPlayConfig config = read_config(options);
+
+    String output_path = options.get("output", "user://selfplay.bin");
+    String path = ProjectSettings::get_singleton()->globalize_path(output_path);
+    std::FILE *output = std::fopen(path.utf8().get_data(), "wb");
+    if (output == nullptr) {
+        UtilityFunctions::printerr("SelfPlay: cannot open output file ", path);
+        stats["error"] = "cannot open output file";
+        return stats;
+    }
+
+    // Play with the given agent's weights, or with a freshly initialised agent's random ones.
+    ChessAgent *source = Object::cast_to<ChessAgent>((Object *)options.get("agent", Variant()));
+    ChessAgent *fallback = nullptr;
+    if (source == nullptr) {
+        fallback = memnew(ChessAgent);
+        source = fallback;
+    }
+    source->initialize_network();
+
+    auto start_time = std::chrono::steady_clock::now();
+    chess::SelfPlayTotals sum = chess::run_self_play(source->get_neural_net()->get_network(), config, output);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::fclose(output);
+
+    if (fallback != nullptr) {
+        memdelete(fallback);
+    }
+
+    double positions_per_second = seconds > 0.0 ? sum.positions / seconds : 0.0;
+    stats["games"] = sum.games;
+    stats["positions"] = sum.positions;
+    stats["white_wins"] = sum.white_wins;
+    stats["black_wins"] = sum.black_wins;
+    stats["draws"] = sum.draws;
+    stats["adjudicated"] = sum.adjudicated;
+    stats["nodes"] = sum.nodes;
+    stats["threads"] = config.threads;
+    stats["seconds"] = seconds;
+    stats["positions_per_second"] = positions_per_second;
+    stats["positions_per_second_per_core"] = positions_per_second / config.threads;
+    stats["output"] = path;
+    if (sum.write_failed) {
+        stats["error"] = "short write to output file";
+    }
+
+    UtilityFunctions::print("SelfPlay: ", sum.positions, " positions from ", sum.games, " games in ", seconds,
+            " s (", positions_per_second / config.threads, " positions/s per core)");
+    return stats;
+}
@@ -0,0 +1,34 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+// Godot node base class and Dictionary type.
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+// Game loop, worker pool and sample format come from the Godot-free core.
+#include "core/selfplay.h"
+
+namespace godot {
+
+// Headless self-play driver: plays the core search against itself on a pool of worker threads
+// and writes every searched position, labelled with its score and the final game result.
+class SelfPlay : public Node {
+    GDCLASS(SelfPlay, Node)
+
+protected:
+    static void _bind_methods();
+
+public:
+    SelfPlay();
+    ~SelfPlay();
+
+    // Run a batch of games (blocking) and return result and throughput statistics.
+    // Optional keys: games, threads, depth, nodes, opening_plies, max_plies, resign_score,
+    // resign_plies, draw_score, draw_plies, draw_min_ply, hash, seed, output, agent (ChessAgent whose weights to use).
+    Dictionary run(const Dictionary &options);
+};
+
+} // namespace godot
+
+#endif
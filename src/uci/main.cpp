@@ -0,0 +1,635 @@
+// Standalone UCI engine built from the Godot-free core (rules, search, network).
+// Usage: chess_uci                 -> UCI protocol on stdin/stdout
+//        chess_uci bench [d]       -> fixed-depth search over the bench positions, then exit
+//        chess_uci tbcheck <path>  -> check the Syzygy tables in path against known results
+
+#include "core/bench.h"
+#include "core/book.h"
+#include "core/mcts.h"
+#include "core/movegen.h"
+#include "core/network.h"
+#include "core/position.h"
+#include "core/search.h"
+#include "core/search_params.h"
+#include "core/syzygy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace chess;
+
+namespace {
+
+// Same default topology as ChessAgent: 768 board features -> 128 hidden -> 1 output.
+const int DEFAULT_HIDDEN_NODES = 128;
+const uint64_t DEFAULT_NETWORK_SEED = 1;
+const int DEFAULT_BENCH_DEPTH = 4;
+const int DEFAULT_BOOK_DEPTH = 16;
+
+// Results of tablebase positions that follow from the rules alone; DTZ_ANY only checks that
+// the DTZ sign agrees with the result.
+const int DTZ_ANY = 1 << 20;
+struct TbReference {
+	const char *fen;
+	WdlScore wdl;
+	int dtz;
+};
+const TbReference TB_REFERENCES[] = {
+	{ "k7/8/1K6/8/8/8/8/7Q w - - 0 1", WDL_WIN, DTZ_ANY },       // Qh8#
+	{ "k6Q/8/1K6/8/8/8/8/8 b - - 0 1", WDL_LOSS, -1 },           // Mated
+	{ "8/8/8/8/8/8/1kQ5/7K b - - 0 1", WDL_DRAW, 0 },            // Kxc2
+	{ "8/8/8/3k4/8/8/8/KQ6 b - - 0 1", WDL_LOSS, DTZ_ANY },
+	{ "k7/8/1K6/8/8/8/8/7R w - - 0 1", WDL_WIN, DTZ_ANY },       // Rh8#
+	{ "8/8/8/3k4/8/8/8/R3K3 b - - 0 1", WDL_LOSS, DTZ_ANY },
+	{ "8/8/8/8/8/8/1kR5/7K b - - 0 1", WDL_DRAW, 0 },            // Kxc2
+	{ "8/4P3/8/8/8/8/k7/4K3 w - - 0 1", WDL_WIN, 1 },            // e8=Q
+	{ "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", WDL_WIN, DTZ_ANY },     // King in front on the sixth rank
+	{ "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", WDL_LOSS, DTZ_ANY },
+	{ "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", WDL_DRAW, 0 },          // Stalemate
+	{ "k7/8/8/8/8/8/P7/1K6 w - - 0 1", WDL_DRAW, 0 },            // Rook pawn, king in the corner
+};
+// Every placement of these is swept, both sides to move.
+const char *const TB_SWEEP_TABLES[] = { "KQvK", "KRvK", "KBvK", "KNvK", "KPvK" };
+// DTZ, which may search a ply, is checked on one position in this many.
+const int TB_SWEEP_DTZ_INTERVAL = 8;
+
+std::mutex output_mutex;
+
+// Info lines come from the search thread, everything else from the input loop.
+void send(const std::string &line) {
+	std::lock_guard<std::mutex> lock(output_mutex);
+	std::cout << line << std::endl;
+}
+
+std::string score_to_uci(int score) {
+	if (score >= MATE_IN_MAX_PLY) {
+		return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+	}
+	if (score <= -MATE_IN_MAX_PLY) {
+		return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+	}
+	return "cp " + std::to_string(score);
+}
+
+std::string info_to_uci(const SearchInfo &info) {
+	std::ostringstream line;
+	int64_t nps = info.time_ms > 0 ? info.nodes * 1000 / info.time_ms : 0;
+	line << "info depth " << info.depth << " seldepth " << info.seldepth << " multipv " << info.multipv << " score " << score_to_uci(info.score)
+		 << " nodes " << info.nodes << " nps " << nps << " hashfull " << info.hashfull << " time " << info.time_ms << " pv";
+	for (Move move : info.pv) {
+		line << " " << move_to_uci(move);
+	}
+	return line.str();
+}
+
+std::string percent(double rate) {
+	std::ostringstream text;
+	text.setf(std::ios::fixed);
+	text.precision(1);
+	text << rate * 100.0 << "%";
+	return text.str();
+}
+
+// One-line summary of the search counters for bench.
+std::string stats_to_string(const SearchStats &stats) {
+	std::ostringstream line;
+	line << "qnodes " << stats.qnodes << " evals " << stats.evaluations << " lazy skips "
+		 << percent(stats.lazy_skip_rate()) << " eval cache hits "
+		 << percent(stats.eval_cache_hit_rate()) << " tt hits " << percent(stats.tt_hit_rate())
+		 << " tt cutoffs " << percent(stats.tt_cutoff_rate()) << " first-move cutoffs "
+		 << percent(stats.first_move_cutoff_rate()) << " policy nodes " << stats.policy_evaluations << " movegen ms "
+		 << stats.movegen_ns / 1000000 << " eval ms " << stats.eval_ns / 1000000 << " null-move cutoffs "
+		 << percent(stats.null_move_cutoff_rate())
+		 << " lmr re-searches " << percent(stats.lmr_research_rate()) << " pvs re-searches "
+		 << percent(stats.pvs_research_rate()) << " aspiration fails " << stats.aspiration_fail_lows << "/"
+		 << stats.aspiration_fail_highs << " of " << stats.aspiration_searches << " futility " << stats.futility_prunes
+		 << " reverse futility " << stats.reverse_futility_prunes << " razored " << stats.razoring_prunes
+		 << " check extensions " << stats.check_extensions << " tb hits " << stats.tb_hits << "/" << stats.tb_probes;
+	return line.str();
+}
+
+class UciEngine {
+private:
+	Position position;
+	Network network;
+	Tablebases tablebases;
+	OpeningBook book;
+	bool own_book = false;
+	int book_depth = DEFAULT_BOOK_DEPTH;
+	int game_ply = 0;
+	int multi_pv = 1;
+	int hash_mb = 16;
+	int skill_level = SkillLevel::MAX_LEVEL;
+	bool limit_strength = false;
+	int elo = SkillLevel::MAX_ELO;
+	Search search;
+	Mcts mcts;
+	bool use_mcts = false;
+
+	void update_skill();
+	void stop_search();
+	void wait_search();
+
+	void set_option(std::istringstream &stream);
+	void set_position(std::istringstream &stream);
+	void go(std::istringstream &stream);
+	void perft_divide(int depth);
+	WdlScore expected_wdl(Position &pos, bool &known);
+	int64_t sweep_table(const std::string &name, int64_t &checked);
+
+public:
+	UciEngine();
+	~UciEngine();
+
+	void bench(int depth);
+	void tb_check(const std::string &path);
+
+	// Returns false on "quit".
+	bool execute(const std::string &line);
+	void loop();
+};
+
+UciEngine::UciEngine() {
+	network.set_layer_sizes({ 768, DEFAULT_HIDDEN_NODES, 1 }, DEFAULT_NETWORK_SEED);
+	search.set_network(&network);
+	mcts.set_network(&network);
+	position.set_start_position();
+}
+
+UciEngine::~UciEngine() {
+	stop_search();
+	wait_search();
+}
+
+void UciEngine::stop_search() {
+	search.stop();
+	mcts.stop();
+}
+
+void UciEngine::wait_search() {
+	search.wait();
+	mcts.wait();
+}
+
+void UciEngine::set_option(std::istringstream &stream) {
+	std::string token, name, value;
+	stream >> token; // "name"
+	while (stream >> token && token != "value") {
+		name += (name.empty() ? "" : " ") + token;
+	}
+	while (stream >> token) {
+		value += (value.empty() ? "" : " ") + token;
+	}
+
+	wait_search();
+	if (name == "Hash" || name == "LargePages") {
+		if (name == "Hash") {
+			hash_mb = std::max(1, std::atoi(value.c_str()));
+		} else {
+			set_large_pages_enabled(value == "true");
+		}
+		// Only tables allocated from now on follow LargePages, so the table is reallocated either way.
+		search.set_hash_size((size_t)hash_mb);
+		send("info string hash " + std::to_string(hash_mb) + " MB on " + page_kind_name(search.hash_page_kind()));
+	} else if (name == "NumaBinding") {
+		set_numa_binding_enabled(value == "true");
+	} else if (name == "EvalCache") {
+		search.set_eval_cache_size((size_t)std::max(1, std::atoi(value.c_str())));
+	} else if (name == "Threads") {
+		search.set_threads(std::atoi(value.c_str()));
+		mcts.set_threads(std::atoi(value.c_str()));
+	} else if (name == "Clear Hash") {
+		search.clear();
+		mcts.clear();
+	} else if (name == "Skill Level") {
+		skill_level = std::atoi(value.c_str());
+		update_skill();
+	} else if (name == "UCI_LimitStrength") {
+		limit_strength = value == "true";
+		update_skill();
+	} else if (name == "UCI_Elo") {
+		elo = std::atoi(value.c_str());
+		update_skill();
+	} else if (name == "MultiPV") {
+		multi_pv = std::max(1, std::min(std::atoi(value.c_str()), 256));
+	} else if (name == "Ponder") {
+		// Nothing to set up: the GUI decides when to send "go ponder".
+	} else if (name == "EvalFile") {
+		if (value.empty() || value == "<empty>") {
+			network.set_layer_sizes({ 768, DEFAULT_HIDDEN_NODES, 1 }, DEFAULT_NETWORK_SEED);
+		} else if (!network.load(value)) {
+			send("info string could not load network " + value);
+		}
+		search.set_network(&network);
+		mcts.set_network(&network);
+	} else if (name == "EvalMode") {
+		search.set_eval_mode(value == "handcrafted" ? EVAL_HANDCRAFTED : value == "hybrid" ? EVAL_HYBRID : EVAL_NETWORK);
+		mcts.set_eval_mode(search.get_eval_mode());
+	} else if (name == "SyzygyPath") {
+		int count = value.empty() || value == "<empty>" ? 0 : tablebases.init(value);
+		search.set_tablebases(count > 0 ? &tablebases : nullptr);
+		send("info string found " + std::to_string(count) + " tablebases");
+	} else if (name == "OwnBook") {
+		own_book = value == "true";
+	} else if (name == "BookFile") {
+		if (value.empty() || value == "<empty>") {
+			book.close();
+		} else if (book.open(value)) {
+			send("info string book " + value + " has " + std::to_string(book.size()) + " entries");
+		} else {
+			send("info string could not load book " + value);
+		}
+	} else if (name == "BookDepth") {
+		book_depth = std::max(0, std::atoi(value.c_str()));
+	} else if (name == "Engine") {
+		use_mcts = value == "mcts";
+	} else if (name == "MCTSTree") {
+		mcts.set_tree_size((size_t)std::max(1, std::atoi(value.c_str())));
+	} else if (name == "MCTSBatch") {
+		MctsParams params = mcts.get_params();
+		params.batch_size = std::max(1, std::min(std::atoi(value.c_str()), 256));
+		mcts.set_params(params);
+	} else if (name == "MCTSCpuct") {
+		MctsParams params = mcts.get_params();
+		params.c_puct = std::max(1, std::atoi(value.c_str())) / 100.0f;
+		mcts.set_params(params);
+	} else {
+		SearchParams params = search.get_params();
+		if (set_search_param(params, name, std::atoi(value.c_str()))) {
+			search.set_params(params);
+		} else {
+			send("info string unknown option " + name);
+		}
+	}
+}
+
+// UCI_LimitStrength with UCI_Elo overrides Skill Level.
+void UciEngine::update_skill() {
+	if (limit_strength) {
+		search.set_elo(elo);
+	} else {
+		search.set_skill_level(skill_level);
+	}
+}
+
+// position [startpos | fen <fen>] [moves <m1> <m2> ...]
+void UciEngine::set_position(std::istringstream &stream) {
+	std::string token, fen;
+	stream >> token;
+	game_ply = 0;
+	if (token == "startpos") {
+		position.set_start_position();
+		stream >> token;
+	} else if (token == "fen") {
+		while (stream >> token && token != "moves") {
+			fen += token + " ";
+		}
+		if (!position.set_fen(fen)) {
+			send("info string invalid fen, using start position");
+			position.set_start_position();
+		}
+		game_ply = 2 * (position.get_fullmove_number() - 1) + (position.side_to_move() == BLACK ? 1 : 0);
+	}
+	if (token != "moves") {
+		return;
+	}
+	while (stream >> token) {
+		Move move = parse_uci_move(position, token);
+		if (move == MOVE_NONE) {
+			send("info string illegal move " + token);
+			return;
+		}
+		UndoInfo undo;
+		position.make_move(move, undo);
+		game_ply++;
+	}
+}
+
+void UciEngine::go(std::istringstream &stream) {
+	SearchLimits limits;
+	limits.multi_pv = multi_pv;
+	std::string token;
+	while (stream >> token) {
+		if (token == "depth") stream >> limits.depth;
+		else if (token == "nodes") stream >> limits.nodes;
+		else if (token == "movetime") stream >> limits.movetime;
+		else if (token == "wtime") stream >> limits.time[WHITE];
+		else if (token == "btime") stream >> limits.time[BLACK];
+		else if (token == "winc") stream >> limits.increment[WHITE];
+		else if (token == "binc") stream >> limits.increment[BLACK];
+		else if (token == "movestogo") stream >> limits.moves_to_go;
+		else if (token == "infinite") limits.infinite = true;
+		else if (token == "ponder") limits.ponder = true;
+		else if (token == "perft") {
+			int depth = 1;
+			stream >> depth;
+			perft_divide(depth);
+			return;
+		}
+	}
+
+	// Book moves are played instantly; ponder and infinite searches must wait for "stop".
+	if (own_book && book.is_open() && game_ply < book_depth && !limits.ponder && !limits.infinite) {
+		Move move = book.probe(position, true);
+		if (move != MOVE_NONE) {
+			send("info string book move");
+			send("bestmove " + move_to_uci(move));
+			return;
+		}
+	}
+
+	Search::InfoCallback on_info = [](const SearchInfo &info) { send(info_to_uci(info)); };
+	Search::FinishCallback on_finish = [](const SearchResult &result) {
+		std::string line = "bestmove " + move_to_uci(result.best_move);
+		if (result.ponder_move != MOVE_NONE) {
+			line += " ponder " + move_to_uci(result.ponder_move);
+		}
+		send(line);
+	};
+	if (use_mcts) {
+		limits.infinite = limits.infinite || limits.ponder;
+		mcts.start(position, limits, on_info, on_finish);
+	} else {
+		search.start(position, limits, on_info, on_finish);
+	}
+}
+
+void UciEngine::perft_divide(int depth) {
+	MoveList moves;
+	generate_legal_moves(position, moves);
+	uint64_t total = 0;
+	for (Move move : moves) {
+		UndoInfo undo;
+		position.make_move(move, undo);
+		uint64_t count = depth > 1 ? perft(position, depth - 1) : 1;
+		position.unmake_move(move, undo);
+		total += count;
+		send(move_to_uci(move) + ": " + std::to_string(count));
+	}
+	send("Nodes searched: " + std::to_string(total));
+}
+
+// Fixed-depth search of every bench position from a clean table; prints a node signature.
+void UciEngine::bench(int depth) {
+	int64_t nodes = 0;
+	SearchStats stats;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+		Position pos;
+		pos.set_fen(BENCH_POSITIONS[i]);
+		SearchLimits limits;
+		limits.depth = depth;
+		search.clear();
+		SearchResult result = search.run(pos, limits);
+		nodes += result.nodes;
+		stats.add(result.stats);
+		send("Position " + std::to_string(i + 1) + "/" + std::to_string(BENCH_POSITION_COUNT) + ": " +
+				move_to_uci(result.best_move) + " " + std::to_string(result.nodes) + " nodes");
+	}
+	int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	send("===========================");
+	send("Total time (ms) : " + std::to_string(ms));
+	send("Nodes searched  : " + std::to_string(nodes));
+	send("Nodes/second    : " + std::to_string(ms > 0 ? nodes * 1000 / ms : 0));
+	send(stats_to_string(stats));
+}
+
+// The result one ply of search over the tables' own values gives; known is false when a
+// table needed for a reply is missing.
+WdlScore UciEngine::expected_wdl(Position &pos, bool &known) {
+	MoveList moves;
+	generate_legal_moves(pos, moves);
+	if (moves.size == 0) {
+		return pos.in_check() ? WDL_LOSS : WDL_DRAW;
+	}
+	WdlScore best = WDL_LOSS;
+	for (Move move : moves) {
+		UndoInfo undo;
+		pos.make_move(move, undo);
+		WdlScore reply = WDL_DRAW;
+		known = tablebases.probe_wdl(pos, reply) && known;
+		pos.unmake_move(move, undo);
+		best = std::max(best, (WdlScore)-reply);
+	}
+	return best;
+}
+
+// Checks every legal placement of a three-piece table (white has the extra piece) against a
+// ply of search. Returns the mismatches (failed probes included), or -1 when the table is missing.
+int64_t UciEngine::sweep_table(const std::string &name, int64_t &checked) {
+	static const char LETTERS[] = "PRNBQK"; // PieceType order
+	int type = (int)(std::strchr(LETTERS, name[1]) - LETTERS);
+	int64_t mismatches = 0;
+	int64_t placed = 0;
+	checked = 0;
+	for (Square white_king = 0; white_king < 64; white_king++) {
+		for (Square black_king = 0; black_king < 64; black_king++) {
+			if (std::abs(file_of(white_king) - file_of(black_king)) <= 1 && std::abs(row_of(white_king) - row_of(black_king)) <= 1) {
+				continue;
+			}
+			for (Square square = 0; square < 64; square++) {
+				if (square == white_king || square == black_king || (type == PAWN && (row_of(square) == 0 || row_of(square) == 7))) {
+					continue;
+				}
+				for (int color = WHITE; color <= BLACK; color++) {
+					Position pos;
+					pos.clear();
+					pos.put_piece(make_piece(WHITE, KING), white_king);
+					pos.put_piece(make_piece(BLACK, KING), black_king);
+					pos.put_piece(make_piece(WHITE, type), square);
+					pos.set_side_to_move(color);
+					pos.refresh_key();
+					if (pos.was_last_move_illegal()) {
+						continue;
+					}
+
+					WdlScore wdl;
+					if (!tablebases.probe_wdl(pos, wdl)) {
+						if (checked == 0 && mismatches == 0) {
+							return -1;
+						}
+						mismatches++;
+						continue;
+					}
+					bool known = true;
+					WdlScore expected = expected_wdl(pos, known);
+					if (!known) {
+						continue;
+					}
+					checked++;
+					int dtz = 0;
+					bool dtz_ok = placed++ % TB_SWEEP_DTZ_INTERVAL != 0 ||
+							(tablebases.probe_dtz(pos, dtz) && (dtz > 0) == (wdl > 0) && (dtz < 0) == (wdl < 0));
+					if (wdl != expected || !dtz_ok) {
+						if (mismatches++ < 5) {
+							send("info string tbcheck " + name + ": " + pos.get_fen() + " wdl " + std::to_string(wdl) +
+									" expected " + std::to_string(expected) + " dtz " + std::to_string(dtz));
+						}
+					}
+				}
+			}
+		}
+	}
+	return mismatches;
+}
+
+void UciEngine::tb_check(const std::string &path) {
+	if (!path.empty()) {
+		tablebases.init(path);
+	}
+	if (tablebases.table_count() == 0) {
+		send("info string tbcheck: no tablebases (pass a path or set SyzygyPath)");
+		return;
+	}
+
+	int failures = 0;
+	int probed = 0;
+	for (const TbReference &reference : TB_REFERENCES) {
+		Position pos;
+		pos.set_fen(reference.fen);
+		WdlScore wdl;
+		int dtz;
+		if (!tablebases.probe_wdl(pos, wdl) || !tablebases.probe_dtz(pos, dtz)) {
+			continue; // Table not available.
+		}
+		probed++;
+		bool dtz_ok = reference.dtz == DTZ_ANY ? (dtz > 0) == (wdl > 0) && (dtz < 0) == (wdl < 0) : dtz == reference.dtz;
+		if (wdl != reference.wdl || !dtz_ok) {
+			failures++;
+			send("info string tbcheck: " + std::string(reference.fen) + " wdl " + std::to_string(wdl) + " dtz " +
+					std::to_string(dtz) + ", expected wdl " + std::to_string(reference.wdl) +
+					(reference.dtz == DTZ_ANY ? "" : " dtz " + std::to_string(reference.dtz)));
+		}
+	}
+	send("Reference positions : " + std::to_string(probed) + " probed, " + std::to_string(failures) + " wrong");
+	int64_t total = probed;
+
+	for (const char *name : TB_SWEEP_TABLES) {
+		int64_t checked = 0;
+		int64_t mismatches = sweep_table(name, checked);
+		if (mismatches < 0) {
+			send(std::string(name) + " : missing");
+			continue;
+		}
+		send(std::string(name) + " : " + std::to_string(checked) + " positions, " + std::to_string(mismatches) + " wrong");
+		failures += mismatches > 0;
+		total += checked;
+	}
+	send(failures > 0 ? "tbcheck FAILED" : total > 0 ? "tbcheck passed" : "tbcheck: none of the checked tables found");
+}
+
+bool UciEngine::execute(const std::string &line) {
+	std::istringstream stream(line);
+	std::string command;
+	stream >> command;
+
+	if (command == "uci") {
+		send("id name chess-ai");
+		send("id author chess-ai contributors");
+		send("option name Hash type spin default 16 min 1 max 65536");
+		send("option name EvalCache type spin default 4 min 1 max 4096");
+		send("option name Threads type spin default 1 min 1 max 256");
+		send("option name LargePages type check default true");
+		send("option name NumaBinding type check default true");
+		send("option name Clear Hash type button");
+		send("option name Ponder type check default false");
+		send("option name MultiPV type spin default 1 min 1 max 256");
+		send("option name Skill Level type spin default " + std::to_string(SkillLevel::MAX_LEVEL) + " min " +
+				std::to_string(SkillLevel::MIN_LEVEL) + " max " + std::to_string(SkillLevel::MAX_LEVEL));
+		send("option name UCI_LimitStrength type check default false");
+		send("option name UCI_Elo type spin default " + std::to_string(SkillLevel::MAX_ELO) + " min " +
+				std::to_string(SkillLevel::MIN_ELO) + " max " + std::to_string(SkillLevel::MAX_ELO));
+		send("option name EvalFile type string default <empty>");
+		send("option name EvalMode type combo default network var network var handcrafted var hybrid");
+		send("option name SyzygyPath type string default <empty>");
+		send("option name OwnBook type check default false");
+		send("option name BookFile type string default <empty>");
+		send("option name BookDepth type spin default " + std::to_string(DEFAULT_BOOK_DEPTH) + " min 0 max 256");
+		send("option name Engine type combo default alphabeta var alphabeta var mcts");
+		send("option name MCTSTree type spin default 64 min 1 max 65536");
+		send("option name MCTSBatch type spin default " + std::to_string(MctsParams().batch_size) + " min 1 max 256");
+		send("option name MCTSCpuct type spin default " + std::to_string((int)std::lround(MctsParams().c_puct * 100)) +
+				" min 1 max 1000");
+		const SearchParams &params = search.get_params();
+		for (int i = 0; i < SEARCH_PARAM_COUNT; i++) {
+			const SearchParamInfo &info = SEARCH_PARAM_TABLE[i];
+			send(std::string("option name ") + info.name + " type spin default " + std::to_string(params.*info.field) +
+					" min " + std::to_string(info.min) + " max " + std::to_string(info.max));
+		}
+		send("uciok");
+	} else if (command == "isready") {
+		send("readyok");
+	} else if (command == "ucinewgame") {
+		stop_search();
+		wait_search();
+		search.clear();
+		mcts.clear();
+	} else if (command == "setoption") {
+		set_option(stream);
+	} else if (command == "position") {
+		wait_search();
+		set_position(stream);
+	} else if (command == "go") {
+		go(stream);
+	} else if (command == "ponderhit") {
+		// MCTS ponders as an infinite search: the move comes at once, the tree is kept.
+		search.ponderhit();
+		mcts.stop();
+	} else if (command == "stop") {
+		stop_search();
+	} else if (command == "quit") {
+		stop_search();
+		return false;
+	} else if (command == "bench") {
+		int depth = DEFAULT_BENCH_DEPTH;
+		stream >> depth;
+		wait_search();
+		bench(depth);
+	} else if (command == "tbcheck") {
+		std::string path;
+		std::getline(stream >> std::ws, path);
+		wait_search();
+		tb_check(path);
+	} else if (command == "d") {
+		send(position.get_fen());
+	} else if (!command.empty()) {
+		send("info string unknown command " + command);
+	}
+	return true;
+}
+
+void UciEngine::loop() {
+	std::string line;
+	while (std::getline(std::cin, line)) {
+		if (!execute(line)) {
+			break;
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	UciEngine engine;
+
+	// Command-line arguments form a single command, e.g. "chess_uci bench 6".
+	if (argc > 1) {
+		std::string command;
+		for (int i = 1; i < argc; i++) {
+			command += (i > 1 ? " " : "") + std::string(argv[i]);
+		}
+		engine.execute(command);
+		return 0;
+	}
+
+	engine.loop();
+	return 0;
+}